@@ -0,0 +1,98 @@
+/**
+ * \file bench_recalc.c
+ * Mede, com make bench, o tempo do recálculo de uma planilha larga depois de
+ * cada alteração em cada quantidade de threads, para decidir se a planilha
+ * deve usar o recálculo em paralelo (MATRIX_setThreads)
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "matrix.h"
+
+// linhas da planilha medida (cada alteração recalcula 3 células por linha)
+#define BENCH_ROWS 20000
+
+// quantidade de alterações em cada medida
+#define EDITS 20
+
+/*******************************************************************************
+ * Funções privadas
+ ******************************************************************************/
+
+/**
+ * Obtém o tempo do relógio monotônico
+ * \return Tempo em nanossegundos
+ */
+double BENCH_now(){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec*1e9 + time.tv_nsec;
+}
+
+/**
+ * Monta a planilha medida: cada linha depende de A1 e das linhas vizinhas, e
+ * soma uma janela alta da coluna anterior
+ * \param matrix Ponteiro duplo para matriz de células
+ */
+void BENCH_buildSheet(Matrix** matrix){
+    char expression[64];
+    int row;
+
+    MATRIX_setExpression(&(*matrix), 1, 1, "1", NULL, NULL);
+    for(row=1; row <= BENCH_ROWS; row++){
+        sprintf(expression, "A1 %d / %d +", row + 2, row);
+        MATRIX_setExpression(&(*matrix), row, 2, expression, NULL, NULL);
+        sprintf(expression, "B%d B%d * 3 /", row, (row > 1) ? row - 1 : row);
+        MATRIX_setExpression(&(*matrix), row, 3, expression, NULL, NULL);
+        sprintf(expression, "sum(C%d:C%d)", (row > 100) ? row - 100 : 1, row);
+        MATRIX_setExpression(&(*matrix), row, 4, expression, NULL, NULL);
+    }
+}
+
+/**
+ * Mede o tempo por alteração com uma quantidade de threads
+ * \param threads Quantidade de threads (0 para uma por processador)
+ */
+void BENCH_measure(int threads){
+    char expression[32];
+    double start;
+    int edit;
+
+    Matrix* matrix = MATRIX_create(BENCH_ROWS, 4);
+    if(!matrix || !MATRIX_setThreads(&matrix, threads)){
+        printf("%-8d nao executado\n", threads);
+        MATRIX_free(matrix);
+        return;
+    }
+
+    BENCH_buildSheet(&matrix);
+
+    start = BENCH_now();
+    for(edit=0; edit < EDITS; edit++){
+        sprintf(expression, "%d", edit + 2);
+        MATRIX_setExpression(&matrix, 1, 1, expression, NULL, NULL);
+    }
+
+    printf("%-8d %10.3f\n", MATRIX_getThreads(&matrix), (BENCH_now() - start)/EDITS/1e6);
+    MATRIX_free(matrix);
+}
+
+/*******************************************************************************
+ * Funções públicas
+ ******************************************************************************/
+
+int main(){
+    const int threads[] = {1, 2, 4, 0};
+    int count;
+
+    printf("%d linhas, %ld processadores, milissegundos por alteracao\n", BENCH_ROWS,
+            sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %10s\n", "threads", "tempo");
+
+    for(count=0; count < (int) (sizeof(threads)/sizeof(threads[0])); count++)
+        BENCH_measure(threads[count]);
+
+    return 0;
+}
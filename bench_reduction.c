@@ -0,0 +1,113 @@
+/**
+ * \file bench_reduction.c
+ * Mede, com make bench, o tempo por elemento das reduções de reduction.h em
+ * cada conjunto de instruções que o processador executa, comparado com a soma
+ * simples sem compensação
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "reduction.h"
+
+// quantidade de valores do vetor medido
+#define VALUES 4096
+
+// quantidade de passagens pelo vetor em cada medida
+#define PASSES 20000
+
+/*******************************************************************************
+ * Funções privadas
+ ******************************************************************************/
+
+/**
+ * Obtém o tempo do relógio monotônico
+ * \return Tempo em nanossegundos
+ */
+double BENCH_now(){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec*1e9 + time.tv_nsec;
+}
+
+/**
+ * Soma simples, sem compensação nem instruções vetoriais escolhidas à mão
+ * (referência da comparação)
+ * \return Soma dos valores
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ */
+double BENCH_naiveSum(const double* values, int size){
+    double sum = 0;
+    int count;
+    for(count=0; count < size; count++)
+        sum += values[count];
+    return sum;
+}
+
+/**
+ * Mede as reduções do conjunto de instruções em uso e mostra o tempo por
+ * elemento de cada uma
+ * \param values Vetor de valores
+ */
+void BENCH_measure(const double* values){
+    // o resultado é somado e mostrado para que as chamadas não sejam descartadas
+    volatile double result = 0;
+    double sum, compensation, start, sumTime, maxTime, minTime;
+    int pass;
+
+    start = BENCH_now();
+    for(pass=0; pass < PASSES; pass++){
+        sum = 0;
+        compensation = 0;
+        REDUCTION_sum(values, VALUES, &sum, &compensation);
+        result += sum + compensation;
+    }
+    sumTime = BENCH_now() - start;
+
+    start = BENCH_now();
+    for(pass=0; pass < PASSES; pass++)
+        result += REDUCTION_max(values, VALUES, values[0]);
+    maxTime = BENCH_now() - start;
+
+    start = BENCH_now();
+    for(pass=0; pass < PASSES; pass++)
+        result += REDUCTION_min(values, VALUES, values[0]);
+    minTime = BENCH_now() - start;
+
+    printf("%-8s %10.3f %10.3f %10.3f\n", REDUCTION_getInstructionSet(),
+            sumTime/PASSES/VALUES, maxTime/PASSES/VALUES, minTime/PASSES/VALUES);
+}
+
+/*******************************************************************************
+ * Funções públicas
+ ******************************************************************************/
+
+int main(){
+    static double values[VALUES];
+    const char* sets[] = {"scalar", "sse2", "avx2"};
+    volatile double result = 0;
+    double start;
+    int count, pass;
+
+    // valores de magnitudes variadas, com sinais alternados
+    for(count=0; count < VALUES; count++)
+        values[count] = (count % 2 ? -1 : 1) * (count % 97) * 1.25 + count * 1e-3;
+
+    printf("%d valores, nanossegundos por elemento\n", VALUES);
+    printf("%-8s %10s %10s %10s\n", "", "sum", "max", "min");
+
+    start = BENCH_now();
+    for(pass=0; pass < PASSES; pass++)
+        result += BENCH_naiveSum(values, VALUES);
+    printf("%-8s %10.3f\n", "simples", (BENCH_now() - start)/PASSES/VALUES);
+
+    for(count=0; count < (int) (sizeof(sets)/sizeof(sets[0])); count++){
+        if(REDUCTION_setInstructionSet(sets[count]))
+            BENCH_measure(values);
+        else
+            printf("%-8s nao executado por este processador\n", sets[count]);
+    }
+
+    return result != result;
+}
@@ -0,0 +1,426 @@
+/**
+ * \file check_matrix.c
+ * Verificações de regressão da matriz de células, executadas com make check.
+ * Cada verificação monta uma pequena planilha, altera células e compara os
+ * valores obtidos com os esperados
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "matrix.h"
+
+// linhas das colunas alteradas na verificação dos resultados guardados
+#define DRIFT_ROWS 300
+
+// quantidade de alterações na verificação dos resultados guardados
+#define DRIFT_CHANGES 5000
+
+// linhas da planilha da verificação do recálculo em paralelo (o cone passa de
+// PARALLEL_MIN_CONE células)
+#define PARALLEL_ROWS 200
+
+// altura das janelas somadas na verificação do recálculo em paralelo (passa de
+// COLUMN_INDEX_MIN_ROWS)
+#define PARALLEL_WINDOW 80
+
+// quantidade de threads comparada com o recálculo sem threads
+#define PARALLEL_THREADS 4
+
+/*******************************************************************************
+ * Funções privadas
+ ******************************************************************************/
+
+/**
+ * Compara o valor de uma célula com o esperado, mostrando a diferença
+ * \return 1 se os valores forem iguais, 0 em caso contrário
+ * \param name Nome da verificação
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param expected Valor esperado
+ */
+int CHECK_value(const char* name, Matrix** matrix, int row, int column, double expected){
+    double value = MATRIX_getValue(&(*matrix), row, column);
+    if(value == expected) return 1;
+
+    printf("%s: valor %.17g, esperado %.17g\n", name, value, expected);
+    return 0;
+}
+
+/**
+ * Soma de uma coluna alta respondida pelo índice da coluna: o erro de
+ * arredondamento precisa chegar ao resultado guardado da função, para que um
+ * valor grande não apague os pequenos quando é retirado
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_columnSumCompensation(){
+    const char* name = "soma compensada da coluna";
+    Matrix* matrix = MATRIX_create(200, 2);
+    int row, success = 1;
+
+    MATRIX_setExpression(&matrix, 1, 1, "100000000000000000000", NULL, NULL);
+    for(row=2; row <= 200; row++)
+        MATRIX_setExpression(&matrix, row, 1, "1", NULL, NULL);
+    MATRIX_setExpression(&matrix, 4, 2, "sum(A1:A200)", NULL, NULL);
+
+    MATRIX_setExpression(&matrix, 1, 1, "0", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 4, 2, 199);
+
+    MATRIX_setExpression(&matrix, 150, 1, "2", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 1, "100000000000000000000", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 1, "0", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 4, 2, 200);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/**
+ * Coluna alta quase vazia: o índice cobre só até a última linha com valor e
+ * precisa crescer quando uma linha mais abaixo recebe um valor, tratando as
+ * linhas não cobertas como 0 no máximo e no mínimo
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_sparseColumn(){
+    const char* name = "coluna esparsa";
+    Matrix* matrix = MATRIX_create(100000, 2);
+    int success = 1;
+
+    MATRIX_setExpression(&matrix, 3, 1, "0 5 -", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 2, "sum(A1:A100000)", NULL, NULL);
+    MATRIX_setExpression(&matrix, 2, 2, "max(A1:A100000)", NULL, NULL);
+    MATRIX_setExpression(&matrix, 3, 2, "min(A1:A100000)", NULL, NULL);
+    MATRIX_setExpression(&matrix, 4, 2, "min(A50000:A100000)", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, -5);
+    success &= CHECK_value(name, &matrix, 2, 2, 0);
+    success &= CHECK_value(name, &matrix, 3, 2, -5);
+
+    MATRIX_setExpression(&matrix, 90000, 1, "0 7 -", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, -12);
+    success &= CHECK_value(name, &matrix, 2, 2, 0);
+    success &= CHECK_value(name, &matrix, 3, 2, -7);
+    success &= CHECK_value(name, &matrix, 4, 2, -7);
+
+    MATRIX_setExpression(&matrix, 99999, 1, "4", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, -8);
+    success &= CHECK_value(name, &matrix, 2, 2, 4);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/**
+ * Muitas alterações em colunas usadas por sum, mean, max e min, altas (pelo
+ * índice da coluna) e baixas: o resultado guardado de cada função precisa ser
+ * igual, bit a bit, ao de uma planilha carregada de uma vez com os mesmos
+ * valores
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_aggregateDrift(){
+    const char* name = "resultado guardado depois de muitas alteracoes";
+    const char* values[] = {"100000000000000000000000000000000", "0.1", "3.7",
+            "0 2.5 -", "1", "0.000000000000000000001", "0 0.7 -", "123456.789",
+            "0 100000000000000000000000000000000 -", "0", "0.3333333333333333"};
+    const char* functions[] = {"sum(A1:A300)", "mean(A1:B300)", "max(A1:A300)",
+            "min(B1:B300)", "sum(A1:B20)", "mean(A5:A40)", "sum(A1:A300,B7)"};
+    const int amount = sizeof(functions)/sizeof(functions[0]);
+    int rows[2*DRIFT_ROWS + amount], columns[2*DRIFT_ROWS + amount];
+    const char* expressions[2*DRIFT_ROWS + amount];
+    Matrix* matrix = MATRIX_create(DRIFT_ROWS, 4);
+    Matrix* fresh = MATRIX_create(DRIFT_ROWS, 4);
+    unsigned int seed = 12345;
+    int count, cell, success = 1;
+
+    for(count=0; count < 2*DRIFT_ROWS; count++){
+        rows[count] = count/2 + 1;
+        columns[count] = count%2 + 1;
+        expressions[count] = "0";
+    }
+    for(count=0; count < amount; count++){
+        rows[2*DRIFT_ROWS + count] = count + 1;
+        columns[2*DRIFT_ROWS + count] = 4;
+        expressions[2*DRIFT_ROWS + count] = functions[count];
+        MATRIX_setExpression(&matrix, count + 1, 4, functions[count], NULL, NULL);
+    }
+
+    for(count=0; count < DRIFT_CHANGES; count++){
+        seed = seed*1103515245 + 12345;
+        cell = (seed >> 8) % (2*DRIFT_ROWS);
+        expressions[cell] = values[(seed >> 20) % (sizeof(values)/sizeof(values[0]))];
+        MATRIX_setExpression(&matrix, rows[cell], columns[cell], expressions[cell],
+                NULL, NULL);
+    }
+
+    // os valores grandes saem no fim: os pequenos precisam voltar a aparecer
+    for(cell=0; cell < 2*DRIFT_ROWS; cell++){
+        if(expressions[cell] != values[0] && expressions[cell] != values[8]) continue;
+        expressions[cell] = values[1];
+        MATRIX_setExpression(&matrix, rows[cell], columns[cell], expressions[cell],
+                NULL, NULL);
+    }
+
+    MATRIX_setExpressions(&fresh, 2*DRIFT_ROWS + amount, rows, columns, expressions,
+            NULL, NULL);
+    for(count=0; count < amount; count++)
+        success &= CHECK_value(name, &matrix, count + 1, 4,
+                MATRIX_getValue(&fresh, count + 1, 4));
+
+    MATRIX_free(matrix);
+    MATRIX_free(fresh);
+    return success;
+}
+
+/**
+ * Compara todas as células de duas planilhas do mesmo tamanho
+ * \return 1 se todos os valores forem iguais, 0 em caso contrário
+ * \param name Nome da verificação
+ * \param matrix Ponteiro duplo para a matriz verificada
+ * \param expected Ponteiro duplo para a matriz com os valores esperados
+ */
+int CHECK_sameValues(const char* name, Matrix** matrix, Matrix** expected){
+    int row, column, success = 1;
+
+    for(row=1; row <= MATRIX_getRows(&(*expected)); row++)
+        for(column=1; column <= MATRIX_getColumns(&(*expected)); column++)
+            success &= CHECK_value(name, &(*matrix), row, column,
+                    MATRIX_getValue(&(*expected), row, column));
+
+    return success;
+}
+
+/**
+ * Monta a planilha da verificação do recálculo em paralelo: cada linha divide
+ * A1 e soma ou subtrai um valor grande (que se cancela nas somas), e as demais
+ * colunas somam, tiram a média e procuram o extremo de janelas dessas divisões,
+ * altas (respondidas pelo índice da coluna) e baixas
+ * \param matrix Ponteiro duplo para matriz de células
+ */
+void CHECK_buildWideSheet(Matrix** matrix){
+    char expression[96];
+    int row, first;
+
+    MATRIX_setExpression(&(*matrix), 1, 1, "1", NULL, NULL);
+    for(row=1; row <= PARALLEL_ROWS; row++){
+        first = (row > PARALLEL_WINDOW) ? row - PARALLEL_WINDOW : 1;
+        sprintf(expression, "A1 %d / 1%0*d %c", row + 2, (row % 4 < 2) ? 40 : 20, 0,
+                (row % 2) ? '+' : '-');
+        MATRIX_setExpression(&(*matrix), row, 2, expression, NULL, NULL);
+        sprintf(expression, "sum(B%d:B%d)", first, row);
+        MATRIX_setExpression(&(*matrix), row, 3, expression, NULL, NULL);
+        sprintf(expression, "mean(B%d:C%d)", (row > 40) ? row - 40 : 1, row);
+        MATRIX_setExpression(&(*matrix), row, 4, expression, NULL, NULL);
+        sprintf(expression, "max(C%d:D%d) min(B%d:B%d) -", first, row, row,
+                (row + PARALLEL_WINDOW < PARALLEL_ROWS) ? row + PARALLEL_WINDOW
+                : PARALLEL_ROWS);
+        MATRIX_setExpression(&(*matrix), row, 5, expression, NULL, NULL);
+    }
+}
+
+/**
+ * Recálculo dividido entre threads: todas as células precisam ter, bit a bit,
+ * os valores do recálculo sem threads, tanto a cada alteração quanto no
+ * recálculo sob pedido do modo manual
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_parallelRecalculation(){
+    const char* name = "recalculo em paralelo";
+    const char* values[] = {"0.7", "1000000", "0.000001", "3"};
+    Matrix* serial = MATRIX_create(PARALLEL_ROWS, 5);
+    Matrix* parallel = MATRIX_create(PARALLEL_ROWS, 5);
+    int count, success = 1;
+
+    if(!MATRIX_setThreads(&parallel, PARALLEL_THREADS)){
+        printf("%s: threads nao criadas\n", name);
+        success = 0;
+    }
+
+    CHECK_buildWideSheet(&serial);
+    CHECK_buildWideSheet(&parallel);
+    success &= CHECK_sameValues(name, &parallel, &serial);
+
+    for(count=0; count < (int) (sizeof(values)/sizeof(values[0])); count++){
+        MATRIX_setExpression(&serial, 1, 1, values[count], NULL, NULL);
+        MATRIX_setExpression(&parallel, 1, 1, values[count], NULL, NULL);
+        success &= CHECK_sameValues(name, &parallel, &serial);
+    }
+
+    MATRIX_setManual(&serial, 1, NULL);
+    MATRIX_setManual(&parallel, 1, NULL);
+    MATRIX_setExpression(&serial, 1, 1, "0.3", NULL, NULL);
+    MATRIX_setExpression(&parallel, 1, 1, "0.3", NULL, NULL);
+    MATRIX_setExpression(&serial, 9, 2, "A1 7 *", NULL, NULL);
+    MATRIX_setExpression(&parallel, 9, 2, "A1 7 *", NULL, NULL);
+    MATRIX_recalculateAll(&serial, NULL);
+    MATRIX_recalculateAll(&parallel, NULL);
+    success &= CHECK_sameValues(name, &parallel, &serial);
+
+    MATRIX_free(serial);
+    MATRIX_free(parallel);
+    return success;
+}
+
+/**
+ * Intervalo alto, com mais células que as percorridas uma a uma: a ordem das
+ * células precisa seguir as células criadas dentro do intervalo depois dele,
+ * para que um ciclo pelo intervalo seja recusado e as células que dependem
+ * dele sejam calculadas depois das suas células
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_tallRangeOrder(){
+    const char* name = "ordem do intervalo alto";
+    Matrix* matrix = MATRIX_create(10000, 4);
+    int success = 1;
+
+    // A5000 é criada depois do intervalo e B2 só pode vir depois dela
+    MATRIX_setExpression(&matrix, 1, 2, "sum(A1:A10000)", NULL, NULL);
+    MATRIX_setExpression(&matrix, 5000, 1, "2", NULL, NULL);
+    MATRIX_setExpression(&matrix, 2, 2, "sum(A1:A10000)", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 4, "1", NULL, NULL);
+    MATRIX_setExpression(&matrix, 2, 2, "sum(A1:A10000) D1 +", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 2, 2, 3);
+
+    // D1 muda A5000 e B2 no mesmo recálculo
+    MATRIX_setExpression(&matrix, 5000, 1, "D1 2 *", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 4, "5", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, 10);
+    success &= CHECK_value(name, &matrix, 2, 2, 15);
+
+    if(!MATRIX_checkCyclicDependency(9000, 1, "B2 1 +", &matrix)
+            || !MATRIX_checkCyclicDependency(5000, 1, "B1 1 +", &matrix)){
+        printf("%s: ciclo não encontrado\n", name);
+        success = 0;
+    }
+    if(MATRIX_checkCyclicDependency(3, 3, "B2 1 +", &matrix)){
+        printf("%s: ciclo inexistente encontrado\n", name);
+        success = 0;
+    }
+
+    MATRIX_setExpression(&matrix, 1, 4, "6", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, 12);
+    success &= CHECK_value(name, &matrix, 2, 2, 18);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/**
+ * Modo preguiçoso com intervalos altos: a célula marcada de um intervalo
+ * precisa ser calculada antes da soma que a usa, inclusive em um intervalo
+ * criado quando a célula já estava marcada
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_lazyRange(){
+    const char* name = "intervalo no modo preguiçoso";
+    Matrix* matrix = MATRIX_create(5000, 3);
+    int success = 1;
+
+    MATRIX_setExpression(&matrix, 1, 3, "1", NULL, NULL);
+    MATRIX_setExpression(&matrix, 10, 1, "C1 1 +", NULL, NULL);
+    MATRIX_setExpression(&matrix, 4000, 1, "1", NULL, NULL);
+    MATRIX_setExpression(&matrix, 1, 2, "sum(A1:A5000)", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, 3);
+
+    MATRIX_setLazy(&matrix, true, NULL);
+    MATRIX_setExpression(&matrix, 1, 3, "2", NULL, NULL);
+    MATRIX_setExpression(&matrix, 3, 2, "sum(A5:A20)", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 3, 2, 3);
+    success &= CHECK_value(name, &matrix, 1, 2, 4);
+
+    MATRIX_setExpression(&matrix, 1, 3, "5", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 2, 7);
+    success &= CHECK_value(name, &matrix, 3, 2, 6);
+
+    MATRIX_setExpression(&matrix, 1, 3, "6", NULL, NULL);
+    MATRIX_setLazy(&matrix, false, NULL);
+    MATRIX_setLazy(&matrix, true, NULL);
+    MATRIX_setExpression(&matrix, 1, 3, "7", NULL, NULL);
+    success &= CHECK_value(name, &matrix, 3, 2, 8);
+    success &= CHECK_value(name, &matrix, 1, 2, 9);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/**
+ * Expressão com mais valores empilhados que a pilha local do programa: precisa
+ * ser aceita e calculada como pela implementação de referência
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_deepExpression(){
+    const char* name = "expressao profunda";
+    Matrix* matrix = MATRIX_create(2, 2);
+    char expression[1000] = "";
+    int count, success = 1;
+
+    // 100 valores empilhados antes do primeiro operador
+    for(count=0; count < 100; count++)
+        strcat(expression, "1 ");
+    for(count=1; count < 100; count++)
+        strcat(expression, "+ ");
+
+    if(!MATRIX_validateExpression(NULL, 2, 2, expression)){
+        printf("%s: expressao recusada\n", name);
+        success = 0;
+    }
+
+    MATRIX_setExpression(&matrix, 1, 1, expression, NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 1, 100);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/**
+ * Número com mais de 63 caracteres: precisa ser lido por inteiro como célula
+ * numérica, como operando e como argumento de função
+ * \return 1 se a verificação passar, 0 em caso contrário
+ */
+int CHECK_longNumber(){
+    const char* name = "numero longo";
+    Matrix* matrix = MATRIX_create(3, 1);
+    char number[100] = "1", expression[200];
+    int count, success = 1;
+
+    // 1e69 escrito por extenso
+    for(count=0; count < 69; count++)
+        strcat(number, "0");
+
+    MATRIX_setExpression(&matrix, 1, 1, number, NULL, NULL);
+    success &= CHECK_value(name, &matrix, 1, 1, 1e69);
+
+    sprintf(expression, "%s 1 *", number);
+    MATRIX_setExpression(&matrix, 2, 1, expression, NULL, NULL);
+    success &= CHECK_value(name, &matrix, 2, 1, 1e69);
+
+    sprintf(expression, "sum(%s,1)", number);
+    MATRIX_setExpression(&matrix, 3, 1, expression, NULL, NULL);
+    success &= CHECK_value(name, &matrix, 3, 1, 1e69);
+
+    MATRIX_free(matrix);
+    return success;
+}
+
+/*******************************************************************************
+ * Funções públicas
+ ******************************************************************************/
+
+int main(){
+    int failures = 0;
+
+    failures += !CHECK_columnSumCompensation();
+    failures += !CHECK_sparseColumn();
+    failures += !CHECK_aggregateDrift();
+    failures += !CHECK_parallelRecalculation();
+    failures += !CHECK_tallRangeOrder();
+    failures += !CHECK_lazyRange();
+    failures += !CHECK_deepExpression();
+    failures += !CHECK_longNumber();
+
+    if(failures)
+        printf("%d verificação(ões) falharam\n", failures);
+    else
+        printf("todas as verificações passaram\n");
+
+    return failures ? 1 : 0;
+}
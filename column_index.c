@@ -0,0 +1,445 @@
+/**
+ * \file column_index.c
+ * Implementação do arquivo column_index.h
+ *
+ * As árvores de segmentos têm 2*size nós: as folhas ficam a partir da posição
+ * size e cada nó interno guarda o extremo dos dois filhos ou, na árvore das
+ * somas, a soma compensada (soma e compensação de Neumaier) dos dois filhos.
+ * Os nós da soma são sempre calculados de novo a partir dos filhos, nunca pela
+ * diferença do valor alterado, e por isso dependem apenas dos valores atuais:
+ * a mesma coluna dá a mesma soma, bit a bit, qualquer que seja a ordem das
+ * alterações. Valores infinitos e NaN são guardados como 0 e apenas contados;
+ * enquanto houver algum, as consultas falham e a função é calculada valor a valor
+ */
+
+#include "column_index.h"
+#include "reduction.h"
+
+// quantidade inicial de linhas cobertas pelo índice (potência de 2)
+#define INITIAL_SIZE 64
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura do índice de uma coluna
+ */
+struct columnIndex{
+    int size; ///< quantidade de linhas cobertas (potência de 2; as demais valem 0)
+    double* values; ///< valor de cada linha coberta
+    int nonFinite; ///< quantidade de linhas com valor infinito ou NaN
+
+    double* sums; ///< árvore de segmentos das somas, ou NULL
+    double* compensations; ///< compensação de cada nó da árvore das somas
+    double* maxTree; ///< árvore de segmentos dos máximos, ou NULL
+    double* minTree; ///< árvore de segmentos dos mínimos, ou NULL
+};
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Verifica se um valor é finito (nem infinito nem NaN), sem depender da libm
+ * \return 1 em caso positivo, 0 em caso negativo
+ * \param value Valor
+ */
+int COLUMNINDEX_isFinite(double value){
+    return (value - value == 0);
+}
+
+/**
+ * Obtém o valor guardado nas estruturas no lugar de um valor da coluna
+ * \return O próprio valor, ou 0 se for infinito ou NaN
+ * \param value Valor
+ */
+double COLUMNINDEX_stored(double value){
+    // -0 vira 0, para que a soma não dependa de qual zero a linha recebeu
+    return (COLUMNINDEX_isFinite(value) && value != 0) ? value : 0;
+}
+
+/**
+ * Dobra as linhas cobertas pelo índice até cobrir uma linha. As estruturas
+ * montadas são descartadas e montadas de novo na próxima consulta
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param position Linha que precisa ser coberta
+ */
+int COLUMNINDEX_grow(ColumnIndex** columnIndex, int position){
+    int size = (*columnIndex)->size;
+    while(size <= position)
+        size *= 2;
+
+    double* values = realloc((*columnIndex)->values, sizeof(double)*size);
+    if(!values) return 0;
+
+    memset(values + (*columnIndex)->size, 0, sizeof(double)*(size - (*columnIndex)->size));
+    (*columnIndex)->values = values;
+    (*columnIndex)->size = size;
+
+    free((*columnIndex)->sums);
+    free((*columnIndex)->compensations);
+    free((*columnIndex)->maxTree);
+    free((*columnIndex)->minTree);
+    (*columnIndex)->sums = NULL;
+    (*columnIndex)->compensations = NULL;
+    (*columnIndex)->maxTree = NULL;
+    (*columnIndex)->minTree = NULL;
+
+    return 1;
+}
+
+/**
+ * Calcula um nó da árvore das somas a partir dos seus dois filhos
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param node Nó interno (de 1 até size - 1)
+ */
+void COLUMNINDEX_joinSums(ColumnIndex** columnIndex, int node){
+    double* sums = (*columnIndex)->sums;
+    double* compensations = (*columnIndex)->compensations;
+
+    sums[node] = sums[2*node];
+    compensations[node] = 0;
+    REDUCTION_add(sums[2*node+1], &sums[node], &compensations[node]);
+    compensations[node] += compensations[2*node] + compensations[2*node+1];
+}
+
+/**
+ * Monta a árvore das somas a partir dos valores, em tempo linear
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ */
+int COLUMNINDEX_buildSums(ColumnIndex** columnIndex){
+    int size = (*columnIndex)->size;
+
+    (*columnIndex)->sums = malloc(sizeof(double)*2*size);
+    (*columnIndex)->compensations = calloc(2*size, sizeof(double));
+    if(!(*columnIndex)->sums || !(*columnIndex)->compensations){
+        free((*columnIndex)->sums);
+        free((*columnIndex)->compensations);
+        (*columnIndex)->sums = NULL;
+        (*columnIndex)->compensations = NULL;
+        return 0;
+    }
+
+    int position;
+    for(position=0; position < size; position++)
+        (*columnIndex)->sums[size+position] = COLUMNINDEX_stored((*columnIndex)->values[position]);
+
+    for(position = size-1; position > 0; position--)
+        COLUMNINDEX_joinSums(&(*columnIndex), position);
+
+    return 1;
+}
+
+/**
+ * Altera uma folha da árvore das somas, calculando de novo os nós acima dela
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param position Linha (de 0 até size - 1)
+ * \param value Novo valor
+ */
+void COLUMNINDEX_setSum(ColumnIndex** columnIndex, int position, double value){
+    position += (*columnIndex)->size;
+    (*columnIndex)->sums[position] = value;
+
+    for(position /= 2; position > 0; position /= 2)
+        COLUMNINDEX_joinSums(&(*columnIndex), position);
+}
+
+/**
+ * Monta uma árvore de segmentos a partir dos valores
+ * \return Ponteiro para a árvore, ou NULL em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param isMax Se verdadeiro, os nós guardam o máximo; caso contrário, o mínimo
+ */
+double* COLUMNINDEX_buildTree(ColumnIndex** columnIndex, int isMax){
+    int size = (*columnIndex)->size;
+    double* tree = malloc(sizeof(double)*2*size);
+    if(!tree) return NULL;
+
+    int position;
+    for(position=0; position < size; position++)
+        tree[size+position] = COLUMNINDEX_stored((*columnIndex)->values[position]);
+
+    for(position = size-1; position > 0; position--){
+        if(isMax)
+            tree[position] = (tree[2*position] >= tree[2*position+1])
+                    ? tree[2*position] : tree[2*position+1];
+        else
+            tree[position] = (tree[2*position] <= tree[2*position+1])
+                    ? tree[2*position] : tree[2*position+1];
+    }
+
+    return tree;
+}
+
+/**
+ * Altera uma folha da árvore de segmentos, atualizando os nós acima dela
+ * \param tree Árvore de segmentos
+ * \param size Quantidade de linhas
+ * \param position Linha (de 0 até size - 1)
+ * \param value Novo valor
+ * \param isMax Se verdadeiro, os nós guardam o máximo; caso contrário, o mínimo
+ */
+void COLUMNINDEX_setTree(double* tree, int size, int position, double value, int isMax){
+    position += size;
+    tree[position] = value;
+
+    for(position /= 2; position > 0; position /= 2){
+        if(isMax)
+            tree[position] = (tree[2*position] >= tree[2*position+1])
+                    ? tree[2*position] : tree[2*position+1];
+        else
+            tree[position] = (tree[2*position] <= tree[2*position+1])
+                    ? tree[2*position] : tree[2*position+1];
+    }
+}
+
+/**
+ * Procura o extremo de um intervalo de linhas na árvore de segmentos
+ * \return Maior (ou menor) valor do intervalo
+ * \param tree Árvore de segmentos
+ * \param size Quantidade de linhas
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param isMax Se verdadeiro, procura o máximo; caso contrário, o mínimo
+ */
+double COLUMNINDEX_queryTree(double* tree, int size, int first, int last, int isMax){
+    double result = tree[first+size];
+    int left, right;
+
+    // percorre os nós que cobrem [first, last] subindo as duas pontas
+    for(left = first+size, right = last+size+1; left < right; left /= 2, right /= 2){
+        if(left & 1){
+            if(isMax ? tree[left] > result : tree[left] < result)
+                result = tree[left];
+            left++;
+        }
+        if(right & 1){
+            right--;
+            if(isMax ? tree[right] > result : tree[right] < result)
+                result = tree[right];
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Procura o extremo de um intervalo de linhas, montando antes a árvore de
+ * segmentos se necessário. As linhas não cobertas pelo índice valem 0
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param isMax Se verdadeiro, procura o máximo; caso contrário, o mínimo
+ * \param result Variável a ser preenchida com o extremo
+ */
+int COLUMNINDEX_extreme(ColumnIndex** columnIndex, int first, int last, int isMax,
+        double* result){
+    if(!columnIndex || !(*columnIndex) || (*columnIndex)->nonFinite
+            || first < 0 || first > last)
+        return 0;
+
+    int size = (*columnIndex)->size;
+    if(first >= size){
+        (*result) = 0;
+        return 1;
+    }
+
+    double** tree = isMax ? &(*columnIndex)->maxTree : &(*columnIndex)->minTree;
+    if(!(*tree) && !((*tree) = COLUMNINDEX_buildTree(&(*columnIndex), isMax)))
+        return 0;
+
+    (*result) = COLUMNINDEX_queryTree((*tree), size, first, last < size ? last : size-1,
+            isMax);
+
+    // o intervalo passa das linhas cobertas, que valem 0
+    if(last >= size && (isMax ? 0 > (*result) : 0 < (*result)))
+        (*result) = 0;
+
+    return 1;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Aloca índice de uma coluna com todos os valores iguais a 0
+ * \return Ponteiro para ColumnIndex, ou NULL em caso de falha de alocação
+ */
+ColumnIndex* COLUMNINDEX_create(){
+    ColumnIndex* columnIndex = malloc(sizeof(ColumnIndex));
+    if(!columnIndex) return NULL;
+
+    columnIndex->values = calloc(INITIAL_SIZE, sizeof(double));
+    if(!columnIndex->values){
+        free(columnIndex);
+        return NULL;
+    }
+
+    columnIndex->size = INITIAL_SIZE;
+    columnIndex->nonFinite = 0;
+    columnIndex->sums = NULL;
+    columnIndex->compensations = NULL;
+    columnIndex->maxTree = NULL;
+    columnIndex->minTree = NULL;
+
+    return columnIndex;
+}
+
+/**
+ * Libera memória do índice
+ * \return NULL
+ * \param columnIndex Ponteiro para ColumnIndex
+ */
+ColumnIndex* COLUMNINDEX_free(ColumnIndex* columnIndex){
+    if(!columnIndex) return NULL;
+
+    free(columnIndex->values);
+    free(columnIndex->sums);
+    free(columnIndex->compensations);
+    free(columnIndex->maxTree);
+    free(columnIndex->minTree);
+    free(columnIndex);
+
+    return NULL;
+}
+
+/**
+ * Altera o valor de uma linha, atualizando as estruturas já montadas. Se a
+ * linha estiver abaixo das linhas cobertas, o índice cresce e as estruturas
+ * são montadas de novo na próxima consulta
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação (o índice
+ * deixa de estar correto e deve ser liberado)
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param position Linha (começando em 0)
+ * \param value Novo valor da linha
+ */
+int COLUMNINDEX_set(ColumnIndex** columnIndex, int position, double value){
+    if(!columnIndex || !(*columnIndex) || position < 0) return 0;
+
+    // linhas não cobertas valem 0: só crescem ao receber outro valor
+    if(position >= (*columnIndex)->size){
+        if(value == 0) return 1;
+        if(!COLUMNINDEX_grow(&(*columnIndex), position)) return 0;
+    }
+
+    double oldValue = (*columnIndex)->values[position];
+    (*columnIndex)->values[position] = value;
+
+    // infinitos e NaN ficam de fora das estruturas (apenas contados)
+    if(!COLUMNINDEX_isFinite(oldValue))
+        (*columnIndex)->nonFinite--;
+    if(!COLUMNINDEX_isFinite(value))
+        (*columnIndex)->nonFinite++;
+
+    value = COLUMNINDEX_stored(value);
+
+    if((*columnIndex)->sums)
+        COLUMNINDEX_setSum(&(*columnIndex), position, value);
+    if((*columnIndex)->maxTree)
+        COLUMNINDEX_setTree((*columnIndex)->maxTree, (*columnIndex)->size, position,
+                value, 1);
+    if((*columnIndex)->minTree)
+        COLUMNINDEX_setTree((*columnIndex)->minTree, (*columnIndex)->size, position,
+                value, 0);
+
+    return 1;
+}
+
+/**
+ * Calcula a soma dos valores de um intervalo de linhas (as linhas não cobertas
+ * pelo índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação (a soma deve ser feita valor a valor)
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param sum Variável a ser preenchida com a soma
+ * \param compensation Variável a ser preenchida com o erro de arredondamento da
+ * soma (a soma exata é sum + compensation)
+ */
+int COLUMNINDEX_sum(ColumnIndex** columnIndex, int first, int last, double* sum,
+        double* compensation){
+    if(!columnIndex || !(*columnIndex) || (*columnIndex)->nonFinite
+            || first < 0 || first > last)
+        return 0;
+
+    // linhas não cobertas valem 0
+    if(first >= (*columnIndex)->size){
+        (*sum) = 0;
+        (*compensation) = 0;
+        return 1;
+    }
+    if(last >= (*columnIndex)->size)
+        last = (*columnIndex)->size-1;
+
+    if(!(*columnIndex)->sums && !COLUMNINDEX_buildSums(&(*columnIndex)))
+        return 0;
+
+    // percorre os nós que cobrem [first, last] subindo as duas pontas; o erro
+    // de arredondamento é devolvido à parte: somado aqui, um valor grande
+    // apagaria os pequenos
+    double rightSums[2*sizeof(int)*8], rightCompensations[2*sizeof(int)*8];
+    int left, right, rightAmount = 0, size = (*columnIndex)->size;
+
+    (*sum) = 0;
+    (*compensation) = 0;
+    for(left = first+size, right = last+size+1; left < right; left /= 2, right /= 2){
+        if(left & 1){
+            REDUCTION_add((*columnIndex)->sums[left], &(*sum), &(*compensation));
+            (*compensation) += (*columnIndex)->compensations[left];
+            left++;
+        }
+        if(right & 1){
+            right--;
+            rightSums[rightAmount] = (*columnIndex)->sums[right];
+            rightCompensations[rightAmount++] = (*columnIndex)->compensations[right];
+        }
+    }
+
+    // os nós da ponta direita entram da esquerda para a direita
+    while(rightAmount > 0){
+        rightAmount--;
+        REDUCTION_add(rightSums[rightAmount], &(*sum), &(*compensation));
+        (*compensation) += rightCompensations[rightAmount];
+    }
+
+    return 1;
+}
+
+/**
+ * Procura o maior valor de um intervalo de linhas (as linhas não cobertas pelo
+ * índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param max Variável a ser preenchida com o maior valor
+ */
+int COLUMNINDEX_max(ColumnIndex** columnIndex, int first, int last, double* max){
+    if(!columnIndex) return 0;
+
+    return COLUMNINDEX_extreme(&(*columnIndex), first, last, 1, &(*max));
+}
+
+/**
+ * Procura o menor valor de um intervalo de linhas (as linhas não cobertas pelo
+ * índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param min Variável a ser preenchida com o menor valor
+ */
+int COLUMNINDEX_min(ColumnIndex** columnIndex, int first, int last, double* min){
+    if(!columnIndex) return 0;
+
+    return COLUMNINDEX_extreme(&(*columnIndex), first, last, 0, &(*min));
+}
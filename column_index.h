@@ -0,0 +1,86 @@
+/**
+ * \file column_index.h
+ * Índice dos valores de uma coluna para consultas de intervalos de linhas:
+ * árvores de segmentos para a soma, o máximo e o mínimo. Cada estrutura só é
+ * montada na primeira consulta que a usa, e todas são atualizadas a cada valor
+ * alterado. O índice cobre apenas as linhas até a última com valor diferente
+ * de 0, crescendo quando uma linha abaixo recebe um valor
+ */
+
+#ifndef COLUMN_INDEX_H_
+#define COLUMN_INDEX_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Estrutura do índice de uma coluna
+ */
+typedef struct columnIndex ColumnIndex;
+
+/**
+ * Aloca índice de uma coluna com todos os valores iguais a 0
+ * \return Ponteiro para ColumnIndex, ou NULL em caso de falha de alocação
+ */
+ColumnIndex* COLUMNINDEX_create();
+
+/**
+ * Libera memória do índice
+ * \return NULL
+ * \param columnIndex Ponteiro para ColumnIndex
+ */
+ColumnIndex* COLUMNINDEX_free(ColumnIndex* columnIndex);
+
+/**
+ * Altera o valor de uma linha, atualizando as estruturas já montadas. Se a
+ * linha estiver abaixo das linhas cobertas, o índice cresce e as estruturas
+ * são montadas de novo na próxima consulta
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação (o índice
+ * deixa de estar correto e deve ser liberado)
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param position Linha (começando em 0)
+ * \param value Novo valor da linha
+ */
+int COLUMNINDEX_set(ColumnIndex** columnIndex, int position, double value);
+
+/**
+ * Calcula a soma dos valores de um intervalo de linhas (as linhas não cobertas
+ * pelo índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação (a soma deve ser feita valor a valor)
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param sum Variável a ser preenchida com a soma
+ * \param compensation Variável a ser preenchida com o erro de arredondamento da
+ * soma (a soma exata é sum + compensation)
+ */
+int COLUMNINDEX_sum(ColumnIndex** columnIndex, int first, int last, double* sum,
+        double* compensation);
+
+/**
+ * Procura o maior valor de um intervalo de linhas (as linhas não cobertas pelo
+ * índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param max Variável a ser preenchida com o maior valor
+ */
+int COLUMNINDEX_max(ColumnIndex** columnIndex, int first, int last, double* max);
+
+/**
+ * Procura o menor valor de um intervalo de linhas (as linhas não cobertas pelo
+ * índice valem 0)
+ * \return 1 em caso de sucesso, 0 se a coluna tiver valores infinitos ou NaN ou
+ * em caso de falha de alocação
+ * \param columnIndex Ponteiro duplo para ColumnIndex
+ * \param first Primeira linha do intervalo
+ * \param last Última linha do intervalo
+ * \param min Variável a ser preenchida com o menor valor
+ */
+int COLUMNINDEX_min(ColumnIndex** columnIndex, int first, int last, double* min);
+
+#endif /* COLUMN_INDEX_H_ */
@@ -0,0 +1,257 @@
+/**
+ * \file dependents.c
+ * Implementação do arquivo dependents.h
+ */
+
+#include "dependents.h"
+
+// capacidade do vetor quando os elementos deixam de estar embutidos
+#define INITIAL_CAPACITY 8
+
+// posição vazia na tabela hash
+#define EMPTY -1
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Calcula a posição inicial de um elemento na tabela hash
+ * \return Posição na tabela
+ * \param value Elemento
+ * \param mask Tamanho da tabela menos um (o tamanho é potência de 2)
+ */
+int DEPENDENTS_hash(int value, int mask){
+    unsigned int hash = (unsigned int) value * 0x9E3779B1u;
+    return (int) ((hash ^ (hash >> 16)) & (unsigned int) mask);
+}
+
+/**
+ * Procura a posição de um elemento na tabela hash
+ * \return Posição na tabela, ou -1 se o elemento não estiver no conjunto
+ * \param dependents Ponteiro para o conjunto (com elementos em vetor alocado)
+ * \param value Elemento procurado
+ */
+int DEPENDENTS_findSlot(Dependents* dependents, int value){
+    int mask = dependents->capacity*2 - 1;
+    int slot = DEPENDENTS_hash(value, mask);
+
+    while(dependents->data.heap.table[slot] != EMPTY){
+        if(dependents->data.heap.items[dependents->data.heap.table[slot]] == value)
+            return slot;
+        slot = (slot+1) & mask;
+    }
+
+    return -1;
+}
+
+/**
+ * Coloca na tabela hash a posição de um elemento do vetor
+ * \param dependents Ponteiro para o conjunto (com elementos em vetor alocado)
+ * \param position Posição do elemento no vetor
+ */
+void DEPENDENTS_insertSlot(Dependents* dependents, int position){
+    int mask = dependents->capacity*2 - 1;
+    int slot = DEPENDENTS_hash(dependents->data.heap.items[position], mask);
+
+    while(dependents->data.heap.table[slot] != EMPTY)
+        slot = (slot+1) & mask;
+
+    dependents->data.heap.table[slot] = position;
+}
+
+/**
+ * Retira uma posição da tabela hash, deslocando para trás os elementos que
+ * colidiram com ela (a tabela continua sem posições removidas)
+ * \param dependents Ponteiro para o conjunto (com elementos em vetor alocado)
+ * \param slot Posição da tabela a ser esvaziada
+ */
+void DEPENDENTS_removeSlot(Dependents* dependents, int slot){
+    int* table = dependents->data.heap.table;
+    int mask = dependents->capacity*2 - 1;
+    int next = (slot+1) & mask, home;
+
+    while(table[next] != EMPTY){
+        home = DEPENDENTS_hash(dependents->data.heap.items[table[next]], mask);
+
+        // move o elemento se a sua posição inicial não estiver entre slot e next
+        if((slot <= next) ? (home <= slot || home > next) : (home <= slot && home > next)){
+            table[slot] = table[next];
+            slot = next;
+        }
+        next = (next+1) & mask;
+    }
+
+    table[slot] = EMPTY;
+}
+
+/**
+ * Dobra a capacidade do conjunto, movendo os elementos embutidos para um vetor
+ * alocado se necessário, e reconstrói a tabela hash
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param dependents Ponteiro para o conjunto
+ */
+int DEPENDENTS_grow(Dependents* dependents){
+    int capacity = dependents->capacity ? dependents->capacity*2 : INITIAL_CAPACITY;
+
+    int* items = malloc(sizeof(int)*capacity);
+    int* table = malloc(sizeof(int)*capacity*2);
+    if(!items || !table){
+        free(items);
+        free(table);
+        return 0;
+    }
+
+    memcpy(items, DEPENDENTS_getItems(dependents), sizeof(int)*dependents->size);
+    if(dependents->capacity){
+        free(dependents->data.heap.items);
+        free(dependents->data.heap.table);
+    }
+
+    dependents->capacity = capacity;
+    dependents->data.heap.items = items;
+    dependents->data.heap.table = table;
+
+    int count;
+    for(count=0; count < capacity*2; count++)
+        table[count] = EMPTY;
+    for(count=0; count < dependents->size; count++)
+        DEPENDENTS_insertSlot(dependents, count);
+
+    return 1;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Inicializa um conjunto vazio
+ * \param dependents Ponteiro para o conjunto
+ */
+void DEPENDENTS_init(Dependents* dependents){
+    dependents->size = 0;
+    dependents->capacity = 0;
+}
+
+/**
+ * Libera a memória alocada pelo conjunto, deixando-o vazio
+ * \param dependents Ponteiro para o conjunto
+ */
+void DEPENDENTS_clear(Dependents* dependents){
+    if(dependents->capacity){
+        free(dependents->data.heap.items);
+        free(dependents->data.heap.table);
+    }
+
+    DEPENDENTS_init(dependents);
+}
+
+/**
+ * Adiciona um elemento no conjunto (elementos repetidos são ignorados)
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento a ser adicionado (não negativo)
+ */
+int DEPENDENTS_add(Dependents* dependents, int value){
+    if(DEPENDENTS_contains(dependents, value)) return 1;
+
+    // ainda cabe nos elementos embutidos
+    if(!dependents->capacity && dependents->size < DEPENDENTS_INLINE){
+        dependents->data.inlineItems[dependents->size++] = value;
+        return 1;
+    }
+
+    if(dependents->size == dependents->capacity || !dependents->capacity)
+        if(!DEPENDENTS_grow(dependents)) return 0;
+
+    dependents->data.heap.items[dependents->size] = value;
+    DEPENDENTS_insertSlot(dependents, dependents->size);
+    dependents->size++;
+
+    return 1;
+}
+
+/**
+ * Remove um elemento do conjunto. A ordem dos demais elementos pode mudar
+ * \return 1 se o elemento foi removido, 0 se não estava no conjunto
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento a ser removido
+ */
+int DEPENDENTS_remove(Dependents* dependents, int value){
+    int position, last;
+
+    // elementos embutidos: troca pelo último
+    if(!dependents->capacity){
+        for(position=0; position < dependents->size; position++){
+            if(dependents->data.inlineItems[position] == value){
+                dependents->data.inlineItems[position] =
+                        dependents->data.inlineItems[--dependents->size];
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    int slot = DEPENDENTS_findSlot(dependents, value);
+    if(slot == -1) return 0;
+
+    position = dependents->data.heap.table[slot];
+    DEPENDENTS_removeSlot(dependents, slot);
+
+    // o último elemento passa a ocupar a posição removida
+    last = dependents->size-1;
+    if(position != last){
+        dependents->data.heap.table[DEPENDENTS_findSlot(dependents,
+                dependents->data.heap.items[last])] = position;
+        dependents->data.heap.items[position] = dependents->data.heap.items[last];
+    }
+    dependents->size--;
+
+    // conjunto vazio volta a usar os elementos embutidos
+    if(!dependents->size)
+        DEPENDENTS_clear(dependents);
+
+    return 1;
+}
+
+/**
+ * Verifica se um elemento está no conjunto
+ * \return 1 se o elemento estiver no conjunto, 0 em caso contrário
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento procurado
+ */
+int DEPENDENTS_contains(Dependents* dependents, int value){
+    int position;
+
+    if(!dependents->capacity){
+        for(position=0; position < dependents->size; position++)
+            if(dependents->data.inlineItems[position] == value)
+                return 1;
+        return 0;
+    }
+
+    return DEPENDENTS_findSlot(dependents, value) != -1;
+}
+
+/**
+ * Obtém a quantidade de elementos do conjunto
+ * \return Quantidade de elementos
+ * \param dependents Ponteiro para o conjunto
+ */
+int DEPENDENTS_getSize(Dependents* dependents){
+    return dependents->size;
+}
+
+/**
+ * Obtém os elementos do conjunto, em um vetor contíguo de DEPENDENTS_getSize
+ * posições. O vetor deixa de ser válido quando o conjunto é alterado
+ * \return Ponteiro para o primeiro elemento
+ * \param dependents Ponteiro para o conjunto
+ */
+const int* DEPENDENTS_getItems(Dependents* dependents){
+    if(!dependents->capacity)
+        return dependents->data.inlineItems;
+
+    return dependents->data.heap.items;
+}
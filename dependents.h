@@ -0,0 +1,90 @@
+/**
+ * \file dependents.h
+ * Conjunto de índices de células dependentes. Poucos elementos ficam guardados
+ * dentro da própria estrutura; acima disso os elementos passam para um vetor
+ * contíguo acompanhado de uma tabela hash, mantendo inserção, remoção e busca
+ * em tempo constante
+ */
+
+#ifndef DEPENDENTS_H_
+#define DEPENDENTS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Quantidade de elementos guardados dentro da própria estrutura
+ */
+#define DEPENDENTS_INLINE 4
+
+/**
+ * Estrutura do conjunto de dependentes. É pública para que possa ser embutida
+ * em outras estruturas sem alocação própria; use apenas as funções abaixo para
+ * acessar seus campos
+ */
+typedef struct dependents Dependents;
+struct dependents{
+    int size; ///< quantidade de elementos
+    int capacity; ///< capacidade do vetor alocado (0 se os elementos estiverem embutidos)
+    union{
+        int inlineItems[DEPENDENTS_INLINE]; ///< elementos embutidos
+        struct{
+            int* items; ///< vetor contíguo de elementos
+            int* table; ///< tabela hash com a posição de cada elemento no vetor
+        } heap;
+    } data;
+};
+
+/**
+ * Inicializa um conjunto vazio
+ * \param dependents Ponteiro para o conjunto
+ */
+void DEPENDENTS_init(Dependents* dependents);
+
+/**
+ * Libera a memória alocada pelo conjunto, deixando-o vazio
+ * \param dependents Ponteiro para o conjunto
+ */
+void DEPENDENTS_clear(Dependents* dependents);
+
+/**
+ * Adiciona um elemento no conjunto (elementos repetidos são ignorados)
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento a ser adicionado (não negativo)
+ */
+int DEPENDENTS_add(Dependents* dependents, int value);
+
+/**
+ * Remove um elemento do conjunto. A ordem dos demais elementos pode mudar
+ * \return 1 se o elemento foi removido, 0 se não estava no conjunto
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento a ser removido
+ */
+int DEPENDENTS_remove(Dependents* dependents, int value);
+
+/**
+ * Verifica se um elemento está no conjunto
+ * \return 1 se o elemento estiver no conjunto, 0 em caso contrário
+ * \param dependents Ponteiro para o conjunto
+ * \param value Elemento procurado
+ */
+int DEPENDENTS_contains(Dependents* dependents, int value);
+
+/**
+ * Obtém a quantidade de elementos do conjunto
+ * \return Quantidade de elementos
+ * \param dependents Ponteiro para o conjunto
+ */
+int DEPENDENTS_getSize(Dependents* dependents);
+
+/**
+ * Obtém os elementos do conjunto, em um vetor contíguo de DEPENDENTS_getSize
+ * posições. O vetor deixa de ser válido quando o conjunto é alterado
+ * \return Ponteiro para o primeiro elemento
+ * \param dependents Ponteiro para o conjunto
+ */
+const int* DEPENDENTS_getItems(Dependents* dependents);
+
+#endif /* DEPENDENTS_H_ */
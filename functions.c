@@ -5,6 +5,18 @@
 
 #include "functions.h"
 
+// quantidade máxima de funções registradas
+#define FUNCTIONS_MAX_AMOUNT 32
+
+// tamanho da tabela hash de nomes (potência de 2, maior que FUNCTIONS_MAX_AMOUNT)
+#define TABLE_SIZE 64
+
+// posição livre da tabela hash
+#define NONE -1
+
+// tamanho do bloco de zeros passado no lugar de células não alocadas
+#define ZEROS_SIZE 64
+
 /********************************************************************************
  * Estruturas
  ********************************************************************************/
@@ -17,88 +29,191 @@ struct listDouble{
     ListDouble* next;
 };
 
+/**
+ * Estrutura do registro de funções
+ */
+typedef struct registry Registry;
+struct registry{
+    FunctionDefinition definitions[FUNCTIONS_MAX_AMOUNT];
+    int amount; ///< quantidade de funções registradas
+    int table[TABLE_SIZE]; ///< tabela hash (endereçamento aberto) de nomes para identificadores
+    int ready; ///< 1 depois que as funções embutidas foram registradas
+};
+
+static Registry registry = {.amount = 0, .ready = 0};
+
 /********************************************************************************
  * Funções privadas
  ********************************************************************************/
 
 /**
- * Calcula a soma de uma lista de valores
- * \return Retorna a soma
- * \param list Lista de doubles
+ * Acumula valores somando-os (sum e mean)
+ * \param accumulator Ponteiro para o acumulador
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
  */
-double FUNCTIONS_sum(ListDouble** list){
-    if(!list || !(*list)) return 0;
+void FUNCTIONS_accumulateSum(FunctionAccumulator* accumulator, const double* values, int size){
+    REDUCTION_sum(values, size, &accumulator->result, &accumulator->compensation);
+}
 
-    double total=0;
+/**
+ * Acumula valores guardando o maior (max)
+ * \param accumulator Ponteiro para o acumulador
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ */
+void FUNCTIONS_accumulateMax(FunctionAccumulator* accumulator, const double* values, int size){
+    // começa pelo primeiro valor recebido
+    if(!accumulator->amount){
+        accumulator->result = values[0];
+        values++;
+        size--;
+    }
+    accumulator->result = REDUCTION_max(values, size, accumulator->result);
+}
 
-    ListDouble* current = (*list);
+/**
+ * Acumula valores guardando o menor (min)
+ * \param accumulator Ponteiro para o acumulador
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ */
+void FUNCTIONS_accumulateMin(FunctionAccumulator* accumulator, const double* values, int size){
+    if(!accumulator->amount){
+        accumulator->result = values[0];
+        values++;
+        size--;
+    }
+    accumulator->result = REDUCTION_min(values, size, accumulator->result);
+}
 
-    while(current){
-        total += current->value;
-        current = current->next;
+/**
+ * Troca um valor do máximo (max)
+ * \return 1 em caso de sucesso, 0 se o maior valor foi diminuído
+ * \param accumulator Ponteiro para o acumulador
+ * \param oldValue Valor recebido anteriormente
+ * \param newValue Valor que o substitui
+ */
+int FUNCTIONS_updateMax(FunctionAccumulator* accumulator, double oldValue, double newValue){
+    if(oldValue != oldValue || newValue != newValue) return 0;
+
+    if(newValue >= accumulator->result){
+        accumulator->result = newValue;
+        return 1;
     }
 
-    return total;
+    // o valor trocado não era o maior
+    return (oldValue < accumulator->result);
 }
 
 /**
- * Calcula a média de uma lista de valores
- * \return Retorna a média
- * \param list Lista de doubles
+ * Troca um valor do mínimo (min)
+ * \return 1 em caso de sucesso, 0 se o menor valor foi aumentado
+ * \param accumulator Ponteiro para o acumulador
+ * \param oldValue Valor recebido anteriormente
+ * \param newValue Valor que o substitui
  */
-double FUNCTIONS_mean(ListDouble** list){
-    if(!list || !(*list)) return 0;
-
-    double total = FUNCTIONS_sum(&(*list));
+int FUNCTIONS_updateMin(FunctionAccumulator* accumulator, double oldValue, double newValue){
+    if(oldValue != oldValue || newValue != newValue) return 0;
 
-    int amount = 0;
-    ListDouble* current = (*list);
-    while(current){
-        amount++;
-        current = current->next;
+    if(newValue <= accumulator->result){
+        accumulator->result = newValue;
+        return 1;
     }
 
-    return (total/amount);
+    return (oldValue > accumulator->result);
 }
 
 /**
- * Procura pelo maior valor de uma lista de valores
- * \return Retorna o maior valor
- * \param list Lista de doubles
+ * Resultado da soma compensada
+ * \return Soma dos valores
+ * \param accumulator Ponteiro para o acumulador
  */
-double FUNCTIONS_max(ListDouble** list){
-    if(!list || !(*list)) return 0;
+double FUNCTIONS_endSum(FunctionAccumulator* accumulator){
+    return accumulator->result + accumulator->compensation;
+}
 
-    double value = (*list)->value;
-    ListDouble* current = (*list)->next;
+/**
+ * Resultado da média
+ * \return Média dos valores
+ * \param accumulator Ponteiro para o acumulador
+ */
+double FUNCTIONS_endMean(FunctionAccumulator* accumulator){
+    return (accumulator->result + accumulator->compensation)/accumulator->amount;
+}
 
-    while(current){
-        if(current->value > value)
-            value = current->value;
-        current = current->next;
+/**
+ * Resultado de max e min
+ * \return Valor extremo guardado
+ * \param accumulator Ponteiro para o acumulador
+ */
+double FUNCTIONS_endExtreme(FunctionAccumulator* accumulator){
+    return accumulator->result;
+}
+
+/**
+ * Calcula o hash do nome de uma função (FNV-1a)
+ * \return Hash do nome
+ * \param name Nome da função
+ */
+unsigned int FUNCTIONS_hash(const char* name){
+    unsigned int hash = 2166136261u;
+
+    while(*name){
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
     }
 
-    return value;
+    return hash;
 }
 
 /**
- * Procura pelo menor valor de uma lista de valores
- * \return Retorna o menor valor
- * \param list Lista de doubles
+ * Procura a posição de um nome na tabela hash
+ * \return Posição do nome, ou a posição livre onde ele deve ser guardado
+ * \param name Nome da função
  */
-double FUNCTIONS_min(ListDouble** list){
-    if(!list || !(*list)) return 0;
+int FUNCTIONS_findSlot(const char* name){
+    int slot = FUNCTIONS_hash(name) & (TABLE_SIZE-1);
 
-    double value = (*list)->value;
-    ListDouble* current = (*list)->next;
+    // a tabela nunca fica cheia, então sempre há uma posição livre no caminho
+    while(registry.table[slot] != NONE
+            && strcmp(registry.definitions[registry.table[slot]].name, name) != 0)
+        slot = (slot+1) & (TABLE_SIZE-1);
 
-    while(current){
-        if(current->value < value)
-            value = current->value;
-        current = current->next;
-    }
+    return slot;
+}
 
-    return value;
+/**
+ * Registra as funções embutidas na primeira vez que o registro é usado
+ */
+void FUNCTIONS_init(){
+    // a soma e a média não são atualizadas pela diferença: o arredondamento
+    // dependeria da ordem das alterações, e o resultado de uma planilha editada
+    // deixaria de ser igual ao da mesma planilha carregada de uma vez
+    static const FunctionDefinition builtins[] = {
+        {"sum", "soma uma lista de valores", 0, -1, 0, 1,
+                FUNCTIONS_SUMMARY_SUM, FUNCTIONS_accumulateSum,
+                FUNCTIONS_endSum, NULL},
+        {"mean", "calcula a media de uma lista de valores", 0, -1, 0, 1,
+                FUNCTIONS_SUMMARY_SUM, FUNCTIONS_accumulateSum,
+                FUNCTIONS_endMean, NULL},
+        {"max", "retorna o maior valor de uma lista de valores", 0, -1, 0, 1,
+                FUNCTIONS_SUMMARY_MAX, FUNCTIONS_accumulateMax,
+                FUNCTIONS_endExtreme, FUNCTIONS_updateMax},
+        {"min", "retorna o menor valor de uma lista de valores", 0, -1, 0, 1,
+                FUNCTIONS_SUMMARY_MIN, FUNCTIONS_accumulateMin,
+                FUNCTIONS_endExtreme, FUNCTIONS_updateMin}
+    };
+
+    if(registry.ready) return;
+    registry.ready = 1;
+
+    int count;
+    for(count=0; count < TABLE_SIZE; count++)
+        registry.table[count] = NONE;
+
+    for(count=0; count < (int) (sizeof(builtins)/sizeof(builtins[0])); count++)
+        FUNCTIONS_register(&builtins[count]);
 }
 
 /********************************************************************************
@@ -109,10 +224,12 @@ double FUNCTIONS_min(ListDouble** list){
  * Lista funções disponíveis para o usuário
  */
 void FUNCTIONS_listFunctions(){
-    printf("sum(value1, value2, ..., valueN) - soma uma lista de valores\n");
-    printf("mean(value1, value2, ..., valueN) - calcula a media de uma lista de valores\n");
-    printf("max(value1, value2, ..., valueN) - retorna o maior valor de uma lista de valores\n");
-    printf("min(value1, value2, ..., valueN) - retorna o menor valor de uma lista de valores\n");
+    FUNCTIONS_init();
+
+    int count;
+    for(count=0; count < registry.amount; count++)
+        printf("%s(value1, value2, ..., valueN) - %s\n", registry.definitions[count].name,
+                registry.definitions[count].description);
 }
 
 /**
@@ -172,6 +289,31 @@ ListDouble* FUNCTIONS_addValue(ListDouble* list, double value){
     return list;
 }
 
+/**
+ * Adiciona valor no final da lista de doubles em tempo constante
+ * \return Ponteiro para a lista de doubles
+ * \param list Ponteiro para a lista de doubles
+ * \param last Ponteiro duplo para o último elemento da lista (NULL na lista vazia),
+ * atualizado a cada valor adicionado
+ * \param value Valor a ser adicionado na lista
+ */
+ListDouble* FUNCTIONS_appendValue(ListDouble* list, ListDouble** last, double value){
+
+    ListDouble* element = malloc(sizeof(ListDouble));
+    if(!element) return list;
+
+    element->value = value;
+    element->next = NULL;
+
+    if(!list)
+        list = element;
+    else
+        (*last)->next = element;
+    (*last) = element;
+
+    return list;
+}
+
 /**
  * Executa uma função do módulo
  * \return O resultado da execução da função na lista fornecida
@@ -180,18 +322,166 @@ ListDouble* FUNCTIONS_addValue(ListDouble* list, double value){
  */
 double FUNCTIONS_evalFunction(const char* function, ListDouble** list){
 
-    if(!FUNCTIONS_isFunction(function)) return 0;
+    int id = FUNCTIONS_getFunction(function);
+    if(id == -1) return 0;
+
+    FunctionAccumulator accumulator;
+    FUNCTIONS_begin(&accumulator, id);
+
+    ListDouble* current = (*list);
+    while(current){
+        FUNCTIONS_accumulate(&accumulator, &current->value, 1);
+        current = current->next;
+    }
+
+    return FUNCTIONS_end(&accumulator);
+}
+
+/**
+ * Registra uma nova função, que passa a poder ser usada nas expressões
+ * \return Identificador da função, ou -1 se o nome for inválido ou já existir,
+ * se a função for volátil (ainda não suportado) ou se o registro estiver cheio
+ * \param definition Descrição da função (é copiada; os textos devem continuar válidos)
+ */
+int FUNCTIONS_register(const FunctionDefinition* definition){
+    FUNCTIONS_init();
+
+    if(!definition || !definition->name || !definition->name[0]
+            || strlen(definition->name) >= FUNCTIONS_NAME_SIZE
+            || !definition->accumulate || !definition->end
+            || definition->isVolatile || registry.amount == FUNCTIONS_MAX_AMOUNT)
+        return -1;
+
+    int slot = FUNCTIONS_findSlot(definition->name);
+    if(registry.table[slot] != NONE) return -1;
+
+    registry.definitions[registry.amount] = (*definition);
+    registry.table[slot] = registry.amount;
+
+    return registry.amount++;
+}
+
+/**
+ * Obtém o identificador de uma função, usado pelos acumuladores
+ * \return Identificador da função, ou -1 se não for uma função válida
+ * \param function Nome da função
+ */
+int FUNCTIONS_getFunction(const char* function){
+    if(!function) return -1;
+
+    FUNCTIONS_init();
+
+    return registry.table[FUNCTIONS_findSlot(function)];
+}
+
+/**
+ * Obtém a descrição de uma função do registro
+ * \return Ponteiro para a descrição, ou NULL se o identificador for inválido
+ * \param function Identificador da função (FUNCTIONS_getFunction)
+ */
+const FunctionDefinition* FUNCTIONS_getDefinition(int function){
+    FUNCTIONS_init();
+
+    if(function < 0 || function >= registry.amount) return NULL;
+
+    return &registry.definitions[function];
+}
+
+/**
+ * Inicia o acumulador de uma função, sem nenhum valor
+ * \param accumulator Ponteiro para o acumulador
+ * \param function Identificador da função (FUNCTIONS_getFunction)
+ */
+void FUNCTIONS_begin(FunctionAccumulator* accumulator, int function){
+    accumulator->function = function;
+    accumulator->amount = 0;
+    accumulator->result = 0;
+    accumulator->compensation = 0;
+}
+
+/**
+ * Passa valores consecutivos para o acumulador, na ordem dos argumentos
+ * \param accumulator Ponteiro para o acumulador
+ * \param values Vetor de valores, ou NULL para passar size valores iguais a 0
+ * (células não alocadas)
+ * \param size Quantidade de valores
+ */
+void FUNCTIONS_accumulate(FunctionAccumulator* accumulator, const double* values, int size){
+    static const double zeros[ZEROS_SIZE] = {0};
+
+    if(size <= 0 || accumulator->function < 0 || accumulator->function >= registry.amount)
+        return;
+
+    const FunctionDefinition* definition = &registry.definitions[accumulator->function];
+
+    if(values){
+        definition->accumulate(accumulator, values, size);
+        accumulator->amount += size;
+        return;
+    }
+
+    // células não alocadas são passadas como blocos de zeros
+    int length;
+    while(size > 0){
+        length = (size < ZEROS_SIZE) ? size : ZEROS_SIZE;
+        definition->accumulate(accumulator, zeros, length);
+        accumulator->amount += length;
+        size -= length;
+    }
+}
+
+/**
+ * Passa para o acumulador o resumo de size valores consecutivos (do tipo
+ * indicado no campo summary da função), no lugar dos próprios valores
+ * \param accumulator Ponteiro para o acumulador
+ * \param summary Resumo dos valores
+ * \param compensation Erro de arredondamento do resumo (0 se não houver)
+ * \param size Quantidade de valores resumidos
+ */
+void FUNCTIONS_accumulateSummary(FunctionAccumulator* accumulator, double summary,
+        double compensation, int size){
+    if(size <= 0 || accumulator->function < 0 || accumulator->function >= registry.amount)
+        return;
+
+    // a soma, o máximo e o mínimo de valores já resumidos entram como um único valor
+    registry.definitions[accumulator->function].accumulate(accumulator, &summary, 1);
+    accumulator->amount += size;
+
+    // o erro da soma continua à parte, para que os valores grandes recebidos
+    // depois não apaguem os pequenos
+    accumulator->compensation += compensation;
+}
 
-    if(strcmp(function, "sum")==0)
-        return FUNCTIONS_sum(&(*list));
-    else if(strcmp(function, "mean")==0)
-        return FUNCTIONS_mean(&(*list));
-    else if(strcmp(function, "max")==0)
-        return FUNCTIONS_max(&(*list));
-    else if(strcmp(function, "min")==0)
-        return FUNCTIONS_min(&(*list));
+/**
+ * Troca um dos valores já recebidos pelo acumulador por um novo valor, sem
+ * passar os demais valores de novo (máximo e mínimo só falham quando o valor
+ * extremo é trocado por um menos extremo; soma e média sempre falham)
+ * \return 1 em caso de sucesso, 0 se os valores precisarem ser passados de novo
+ * \param accumulator Ponteiro para o acumulador
+ * \param oldValue Valor recebido anteriormente
+ * \param newValue Valor que o substitui
+ */
+int FUNCTIONS_update(FunctionAccumulator* accumulator, double oldValue, double newValue){
+    if(!accumulator->amount || accumulator->function < 0
+            || accumulator->function >= registry.amount
+            || !registry.definitions[accumulator->function].update)
+        return 0;
 
-    return 0;
+    return registry.definitions[accumulator->function].update(accumulator, oldValue,
+            newValue);
+}
+
+/**
+ * Obtém o resultado da função sobre os valores recebidos pelo acumulador
+ * \return Resultado da função (0 se nenhum valor foi recebido)
+ * \param accumulator Ponteiro para o acumulador
+ */
+double FUNCTIONS_end(FunctionAccumulator* accumulator){
+    if(!accumulator->amount || accumulator->function < 0
+            || accumulator->function >= registry.amount)
+        return 0;
+
+    return registry.definitions[accumulator->function].end(accumulator);
 }
 
 /**
@@ -200,9 +490,5 @@ double FUNCTIONS_evalFunction(const char* function, ListDouble** list){
  * \param function Nome da função
  */
 int FUNCTIONS_isFunction(const char* function){
-    if(strcmp(function, "sum")==0 || strcmp(function, "mean")==0
-            || strcmp(function, "max")==0 || strcmp(function, "min")==0)
-        return 1;
-    else
-        return 0;
+    return (FUNCTIONS_getFunction(function) != -1);
 }
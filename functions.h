@@ -9,12 +9,66 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "reduction.h"
+
+/**
+ * Tamanho máximo do nome de uma função, incluindo o caractere final
+ */
+#define FUNCTIONS_NAME_SIZE 10
+
+/**
+ * Resumos de um intervalo de células que podem ser passados para o acumulador
+ * no lugar dos valores do intervalo (FUNCTIONS_accumulateSummary)
+ */
+#define FUNCTIONS_SUMMARY_NONE 0 ///< a função precisa de todos os valores
+#define FUNCTIONS_SUMMARY_SUM 1 ///< soma dos valores
+#define FUNCTIONS_SUMMARY_MAX 2 ///< maior valor
+#define FUNCTIONS_SUMMARY_MIN 3 ///< menor valor
 
 /**
  * Estrutura de uma lista de valores
  */
 typedef struct listDouble ListDouble;
 
+/**
+ * Estrutura do acumulador de uma função. Recebe os valores dos argumentos em
+ * uma única passada, sem lista intermediária. É pública para que possa ser
+ * declarada na pilha; use apenas as funções abaixo para acessar seus campos
+ */
+typedef struct functionAccumulator FunctionAccumulator;
+struct functionAccumulator{
+    int function; ///< identificador da função (FUNCTIONS_getFunction)
+    int amount; ///< quantidade de valores recebidos
+    double result; ///< soma dos valores (sum e mean) ou valor extremo (max e min)
+    double compensation; ///< erro de arredondamento acumulado da soma (sum e mean)
+};
+
+/**
+ * Estrutura com a descrição de uma função do registro. É pública para que novas
+ * funções possam ser registradas com FUNCTIONS_register
+ */
+typedef struct functionDefinition FunctionDefinition;
+struct functionDefinition{
+    const char* name; ///< nome usado nas expressões (menor que FUNCTIONS_NAME_SIZE)
+    const char* description; ///< descrição mostrada ao usuário
+    int minArguments; ///< quantidade mínima de argumentos (um intervalo conta como um)
+    int maxArguments; ///< quantidade máxima de argumentos, ou -1 se não houver limite
+    /// deve ser 0: funções voláteis (cujo resultado muda sem que os argumentos
+    /// mudem) ainda não são suportadas, pois as células só são recalculadas
+    /// quando os seus argumentos mudam, e FUNCTIONS_register as recusa
+    int isVolatile;
+    int acceptsRanges; ///< 1 se aceita intervalos de células como argumento
+    int summary; ///< resumo que substitui os valores de um intervalo (FUNCTIONS_SUMMARY_*)
+
+    /// recebe valores consecutivos (values nunca é NULL; amount ainda não inclui size)
+    void (*accumulate)(FunctionAccumulator* accumulator, const double* values, int size);
+    /// obtém o resultado (chamada apenas se algum valor foi recebido)
+    double (*end)(FunctionAccumulator* accumulator);
+    /// troca um valor já recebido por outro sem percorrer os demais; devolve 0 se
+    /// não for possível e os valores precisarem ser passados de novo (pode ser NULL)
+    int (*update)(FunctionAccumulator* accumulator, double oldValue, double newValue);
+};
+
 /**
  * Lista funções disponíveis para o usuário
  */
@@ -41,6 +95,16 @@ ListDouble* FUNCTIONS_free(ListDouble* list);
  */
 ListDouble* FUNCTIONS_addValue(ListDouble* list, double value);
 
+/**
+ * Adiciona valor no final da lista de doubles em tempo constante
+ * \return Ponteiro para a lista de doubles
+ * \param list Ponteiro para a lista de doubles
+ * \param last Ponteiro duplo para o último elemento da lista (NULL na lista vazia),
+ * atualizado a cada valor adicionado
+ * \param value Valor a ser adicionado na lista
+ */
+ListDouble* FUNCTIONS_appendValue(ListDouble* list, ListDouble** last, double value);
+
 /**
  * Executa uma função do módulo
  * \return O resultado da execução da função na lista fornecida
@@ -49,6 +113,73 @@ ListDouble* FUNCTIONS_addValue(ListDouble* list, double value);
  */
 double FUNCTIONS_evalFunction(const char* function, ListDouble** list);
 
+/**
+ * Registra uma nova função, que passa a poder ser usada nas expressões
+ * \return Identificador da função, ou -1 se o nome for inválido ou já existir,
+ * se a função for volátil (ainda não suportado) ou se o registro estiver cheio
+ * \param definition Descrição da função (é copiada; os textos devem continuar válidos)
+ */
+int FUNCTIONS_register(const FunctionDefinition* definition);
+
+/**
+ * Obtém o identificador de uma função, usado pelos acumuladores
+ * \return Identificador da função, ou -1 se não for uma função válida
+ * \param function Nome da função
+ */
+int FUNCTIONS_getFunction(const char* function);
+
+/**
+ * Obtém a descrição de uma função do registro
+ * \return Ponteiro para a descrição, ou NULL se o identificador for inválido
+ * \param function Identificador da função (FUNCTIONS_getFunction)
+ */
+const FunctionDefinition* FUNCTIONS_getDefinition(int function);
+
+/**
+ * Inicia o acumulador de uma função, sem nenhum valor
+ * \param accumulator Ponteiro para o acumulador
+ * \param function Identificador da função (FUNCTIONS_getFunction)
+ */
+void FUNCTIONS_begin(FunctionAccumulator* accumulator, int function);
+
+/**
+ * Passa valores consecutivos para o acumulador, na ordem dos argumentos
+ * \param accumulator Ponteiro para o acumulador
+ * \param values Vetor de valores, ou NULL para passar size valores iguais a 0
+ * (células não alocadas)
+ * \param size Quantidade de valores
+ */
+void FUNCTIONS_accumulate(FunctionAccumulator* accumulator, const double* values, int size);
+
+/**
+ * Passa para o acumulador o resumo de size valores consecutivos (do tipo
+ * indicado no campo summary da função), no lugar dos próprios valores
+ * \param accumulator Ponteiro para o acumulador
+ * \param summary Resumo dos valores
+ * \param compensation Erro de arredondamento do resumo (0 se não houver)
+ * \param size Quantidade de valores resumidos
+ */
+void FUNCTIONS_accumulateSummary(FunctionAccumulator* accumulator, double summary,
+        double compensation, int size);
+
+/**
+ * Troca um dos valores já recebidos pelo acumulador por um novo valor, sem
+ * passar os demais valores de novo (máximo e mínimo só falham quando o valor
+ * extremo é trocado por um menos extremo; soma e média sempre falham)
+ * \return 1 em caso de sucesso, 0 se os valores precisarem ser passados de novo
+ * \param accumulator Ponteiro para o acumulador
+ * \param oldValue Valor recebido anteriormente
+ * \param newValue Valor que o substitui
+ */
+int FUNCTIONS_update(FunctionAccumulator* accumulator, double oldValue, double newValue);
+
+/**
+ * Obtém o resultado da função sobre os valores recebidos pelo acumulador
+ * \return Resultado da função (0 se nenhum valor foi recebido)
+ * \param accumulator Ponteiro para o acumulador
+ */
+double FUNCTIONS_end(FunctionAccumulator* accumulator);
+
 /**
  * Verifica se a string fornecida é o nome de uma função válida
  * \return 1 em caso positivo, ou 0 em caso negativo
@@ -25,6 +25,9 @@
 // borda superior e inferior "desligada"
 #define CELLUPDOWNBORDEROFF '-'
 
+// marcador de célula com valor desatualizado (cálculo manual)
+#define CELLSTALE '~'
+
 // equivalente a uma linha
 #define ROW 1
 // equivalente a uma coluna
@@ -41,6 +44,7 @@ typedef struct windowCell WindowCell;
 struct windowCell{
     WINDOW* cell;
     int status;
+    int stale; ///< se o valor mostrado está desatualizado
 };
 
 /**
@@ -141,6 +145,7 @@ GraphicCells* GRAPHICSCELLS_create(int positionX, int positionY, int rows, int c
                 return NULL;
             }
 
+            graphic->windowCell[index]->stale = false;
             if(countRow==1 && countColumn==1)
                 graphic->windowCell[index]->status = ON;
             else
@@ -189,7 +194,8 @@ GraphicCells* GRAPHICSCELLS_free(GraphicCells* graphicCells){
 
 /**
  * Atualiza o gráfico de uma célula
- * \return 1 em caso de sucesso, ou 0 em caso de falha
+ * \return 1 em caso de sucesso, ou 0 em caso de falha (ou se a célula estiver fora
+ * da área desenhada)
  * \param row Linha da célula
  * \param column Coluna da célula
  * \param value Valor a ser colocado na célula
@@ -202,6 +208,10 @@ int GRAPHICSCELLS_updateCell(GraphicCells** graphicCells, int row, int column, d
         int mark, int disable){
     if(!graphicCells || !(*graphicCells)) return 0;
 
+    // células fora da área desenhada não são mostradas
+    if(row < 1 || row > (*graphicCells)->rows || column < 1
+            || column > (*graphicCells)->columns) return 0;
+
     int index = GRAPHICSCELLS_getIndex(row,column, (*graphicCells)->columns);
 
     wclear((*graphicCells)->windowCell[index]->cell);
@@ -214,8 +224,12 @@ int GRAPHICSCELLS_updateCell(GraphicCells** graphicCells, int row, int column, d
     else
         GRAPHICSCELLS_drawBox(&((*graphicCells)->windowCell[index]),OFF);
 
-    if(!disable)
+    if(!disable){
         mvwprintw((*graphicCells)->windowCell[index]->cell, ROW*1, COLUMN*2, "%.2f", value);
+        // valor desatualizado aparece com o marcador antes dele
+        if((*graphicCells)->windowCell[index]->stale)
+            mvwaddch((*graphicCells)->windowCell[index]->cell, ROW*1, COLUMN*1, CELLSTALE);
+    }
     else
         mvwprintw((*graphicCells)->windowCell[index]->cell, ROW*1, COLUMN*2, "");
     wrefresh((*graphicCells)->windowCell[index]->cell);
@@ -223,6 +237,39 @@ int GRAPHICSCELLS_updateCell(GraphicCells** graphicCells, int row, int column, d
     return 1;
 }
 
+/**
+ * Define se o valor de uma célula está desatualizado. A célula passa a ser
+ * desenhada com o marcador na próxima atualização (GRAPHICSCELLS_updateCell)
+ * \return 1 em caso de sucesso, ou 0 em caso de falha (ou se a célula estiver fora
+ * da área desenhada)
+ * \param graphicCells Ponteiro para objeto GraphicCells
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param stale Se o valor está desatualizado. booleano
+ */
+int GRAPHICSCELLS_setStale(GraphicCells** graphicCells, int row, int column, int stale){
+    if(!GRAPHICSCELLS_isVisible(&(*graphicCells), row, column)) return 0;
+
+    int index = GRAPHICSCELLS_getIndex(row,column, (*graphicCells)->columns);
+    (*graphicCells)->windowCell[index]->stale = stale;
+
+    return 1;
+}
+
+/**
+ * Verifica se uma célula está dentro da área desenhada
+ * \return 1 em caso positivo, 0 em caso negativo
+ * \param graphicCells Ponteiro para objeto GraphicCells
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ */
+int GRAPHICSCELLS_isVisible(GraphicCells** graphicCells, int row, int column){
+    if(!graphicCells || !(*graphicCells)) return 0;
+
+    return (row >= 1 && row <= (*graphicCells)->rows && column >= 1
+            && column <= (*graphicCells)->columns);
+}
+
 /**
  * Pega altura da janela
  * \return Altura da janela
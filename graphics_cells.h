@@ -46,7 +46,8 @@ GraphicCells* GRAPHICSCELLS_free(GraphicCells* graphicCells);
 
 /**
  * Atualiza o gráfico de uma célula
- * \return 1 em caso de sucesso, ou 0 em caso de falha
+ * \return 1 em caso de sucesso, ou 0 em caso de falha (ou se a célula estiver fora
+ * da área desenhada)
  * \param graphicCells Ponteiro para objeto GraphicCells
  * \param row Linha da célula
  * \param column Coluna da célula
@@ -59,6 +60,27 @@ GraphicCells* GRAPHICSCELLS_free(GraphicCells* graphicCells);
 int GRAPHICSCELLS_updateCell(GraphicCells** graphicCells, int row, int column, double value,
         int mark, int disable);
 
+/**
+ * Define se o valor de uma célula está desatualizado. A célula passa a ser
+ * desenhada com o marcador na próxima atualização (GRAPHICSCELLS_updateCell)
+ * \return 1 em caso de sucesso, ou 0 em caso de falha (ou se a célula estiver fora
+ * da área desenhada)
+ * \param graphicCells Ponteiro para objeto GraphicCells
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param stale Se o valor está desatualizado. booleano
+ */
+int GRAPHICSCELLS_setStale(GraphicCells** graphicCells, int row, int column, int stale);
+
+/**
+ * Verifica se uma célula está dentro da área desenhada
+ * \return 1 em caso positivo, 0 em caso negativo
+ * \param graphicCells Ponteiro para objeto GraphicCells
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ */
+int GRAPHICSCELLS_isVisible(GraphicCells** graphicCells, int row, int column);
+
 /**
  * Pega altura da janela
  * \return Altura da janela
@@ -17,6 +17,9 @@
 // define a borda superior e inferior da janela
 #define WINDOWBORDERUPDOWN '*'
 
+// capacidade inicial do texto lido por GRAPHICUSER_getLine
+#define LINE_CAPACITY 64
+
 /**********************************************************************************
  * Estruturas
  **********************************************************************************/
@@ -132,6 +135,61 @@ void GRAPHICUSER_get(GraphicUser** graphic, char* text, int positionX, int posit
     mvwgetnstr((*graphic)->userWindow,positionY, positionX, text, 60);
 }
 
+/**
+ * Recebe entrada do usuário de qualquer tamanho. Quando o texto não cabe na
+ * janela, apenas o seu final é mostrado
+ * \return Texto digitado (deve ser liberado com free), ou NULL em caso de falha
+ * de alocação
+ * \param graphic Ponteiro duplo para GraphicUser (a janela de usuário)
+ * \param positionX Coordenada x da entrada do usuário
+ * \param positionY Coordenada y da entrada do usuário
+ */
+char* GRAPHICUSER_getLine(GraphicUser** graphic, int positionX, int positionY){
+    if(!graphic || !(*graphic)) return NULL;
+
+    int capacity = LINE_CAPACITY, size = 0, key, shown;
+    char* text = malloc(capacity);
+    char* grown;
+    if(!text) return NULL;
+    text[0] = 0;
+
+    // caracteres visíveis entre a posição da entrada e a borda da janela
+    int visible = (*graphic)->width - positionX - 1;
+    if(visible < 1) visible = 1;
+
+    // o texto é mostrado aqui, e não pelo eco do terminal
+    noecho();
+    keypad((*graphic)->userWindow, TRUE);
+
+    while((key = mvwgetch((*graphic)->userWindow, positionY, positionX + (size < visible ?
+            size : visible-1))) != '\n' && key != '\r' && key != KEY_ENTER){
+
+        if(key == KEY_BACKSPACE || key == 127 || key == 8){
+            if(size) text[--size] = 0;
+        }
+        else if(key >= ' ' && key <= '~'){
+            if(size+1 == capacity){
+                grown = realloc(text, capacity*2);
+                if(!grown) continue;
+                text = grown;
+                capacity *= 2;
+            }
+            text[size++] = key;
+            text[size] = 0;
+        }
+
+        // mostra o final do texto, deixando espaço para o cursor
+        shown = size < visible ? size : visible-1;
+        mvwprintw((*graphic)->userWindow, positionY, positionX, "%-*s", visible,
+                text + size - shown);
+        wrefresh((*graphic)->userWindow);
+    }
+
+    echo();
+
+    return text;
+}
+
 /**
  * Obtem posição x da janela
  * \return Posição x da janela
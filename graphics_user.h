@@ -57,6 +57,17 @@ void GRAPHICUSER_write(GraphicUser** graphic, const char *text, int positionX, i
  */
 void GRAPHICUSER_get(GraphicUser** graphic, char* text, int positionX, int positionY);
 
+/**
+ * Recebe entrada do usuário de qualquer tamanho. Quando o texto não cabe na
+ * janela, apenas o seu final é mostrado
+ * \return Texto digitado (deve ser liberado com free), ou NULL em caso de falha
+ * de alocação
+ * \param graphic Ponteiro duplo para GraphicUser (a janela de usuário)
+ * \param positionX Coordenada x da entrada do usuário
+ * \param positionY Coordenada y da entrada do usuário
+ */
+char* GRAPHICUSER_getLine(GraphicUser** graphic, int positionX, int positionY);
+
 /**
  * Obtem posição x da janela
  * \return Posição x da janela
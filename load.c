@@ -43,7 +43,9 @@ void LOAD_makeWorkspaceOptions(GraphicSelect** select, mxml_node_t** top){
 }
 
 /**
- * Preenche dados na matriz de acordo com o nome do espaço de trabalho
+ * Preenche dados na matriz de acordo com o nome do espaço de trabalho. Todas as
+ * células são passadas de uma vez para a matriz, que monta as dependências e
+ * calcula os valores uma única vez no final
  * \param Matrix Ponteiro para a matriz de células
  * \param top Ponteiro para árvore xml
  * \param workspaceName Nome do espaço de trabalho escolhido
@@ -55,23 +57,40 @@ void LOAD_loadData(Matrix** matrix, mxml_node_t** top, const char* workspaceName
     mxml_node_t* node = mxmlFindElement(*top, *top, workspaceName,
             NULL, NULL, MXML_DESCEND);
 
-    // guarda dados da linha e coluna
-    int row, column;
-
-    // pega primeiro filho
-    mxml_node_t* child = mxmlGetFirstChild(node);
-
-    // enquanto child não é nulo, preenche dados na matriz
-    while(child){
-        // pega linha e coluna
-        row = atoi(mxmlElementGetAttr(child, "row"));
-        column = atoi(mxmlElementGetAttr(child, "column"));
-        // preenche matriz
-        MATRIX_setExpression(&(*matrix), row, column, mxmlElementGetAttr(child, "expression"),
-                NULL, NULL);
+    // conta as células salvas
+    int size = 0;
+    mxml_node_t* child;
+    for(child = mxmlGetFirstChild(node); child; child = mxmlGetNextSibling(child))
+        size++;
+    if(!size) return;
+
+    // linha, coluna e expressão de cada célula (as expressões continuam na árvore)
+    int* rows = malloc(sizeof(int)*size);
+    int* columns = malloc(sizeof(int)*size);
+    const char** expressions = malloc(sizeof(const char*)*size);
+
+    int count = 0;
+    for(child = mxmlGetFirstChild(node); child && rows && columns && expressions;
+            child = mxmlGetNextSibling(child)){
+        rows[count] = atoi(mxmlElementGetAttr(child, "row"));
+        columns[count] = atoi(mxmlElementGetAttr(child, "column"));
+        expressions[count] = mxmlElementGetAttr(child, "expression");
+        count++;
+    }
 
-        child = mxmlGetNextSibling(child);
+    // sem memória para as listas, preenche célula a célula
+    if(!rows || !columns || !expressions){
+        for(child = mxmlGetFirstChild(node); child; child = mxmlGetNextSibling(child))
+            MATRIX_setExpression(&(*matrix), atoi(mxmlElementGetAttr(child, "row")),
+                    atoi(mxmlElementGetAttr(child, "column")),
+                    mxmlElementGetAttr(child, "expression"), NULL, NULL);
     }
+    else
+        MATRIX_setExpressions(&(*matrix), size, rows, columns, expressions, NULL, NULL);
+
+    free(rows);
+    free(columns);
+    free(expressions);
 }
 
 /***********************************************************************
@@ -5,47 +5,101 @@
 
 #include "matrix.h"
 
-// a quantidade máxima de células
-#define MAX_CELLS 100
+// quantidade de células em cada bloco do armazenamento (potência de 2)
+#define TILE_BITS 8
+#define TILE_SIZE (1 << TILE_BITS)
 
-// valores da tabela ascii para referência
-#define MIN_ASCII_NUMBER 48
-#define MAX_ASCII_NUMBER 57
-#define MIN_ASCII_CAP_LETTER 65
-#define MAX_ASCII_CAP_LETTER 90
-#define MIN_ASCII_LETTER 97
-#define MAX_ASCII_LETTER 122
+// quantidade de blocos em cada página do diretório (potência de 2)
+#define PAGE_BITS 11
+#define PAGE_SIZE (1 << PAGE_BITS)
+
+// quantidade de páginas do diretório (cobre MATRIX_MAX_ROWS*MATRIX_MAX_COLUMNS células)
+#define DIRECTORY_SIZE ((MATRIX_MAX_ROWS*MATRIX_MAX_COLUMNS) >> (TILE_BITS+PAGE_BITS))
+
+// defina MATRIX_REFERENCE_EVAL (ex.: CFLAGS= -c -Wall -DMATRIX_REFERENCE_EVAL) para
+// calcular as células com a árvore de expressão binária, a implementação de
+// referência usada para comparar resultados
+#ifdef MATRIX_REFERENCE_EVAL
+#define MATRIX_RUN_PROGRAM PROGRAM_runReference
+#else
+#define MATRIX_RUN_PROGRAM PROGRAM_run
+#endif
+
+// quantidade máxima de caracteres de uma referência mostrados nas mensagens
+#define MESSAGE_REFERENCE_SIZE 20
+
+// tamanho dos blocos de memória pedidos ao sistema pela arena da matriz
+#define ARENA_BLOCK_SIZE (1 << 16)
+
+// quantidade de blocos de células reservados de cada vez na arena
+#define TILE_POOL_SLAB 16
+
+// menor altura de intervalo respondida pelo índice da coluna (intervalos mais
+// baixos são lidos célula a célula)
+#define COLUMN_INDEX_MIN_ROWS 64
+
+// estados do valor de uma célula nos modos preguiçoso e manual
+#define CLEAN 0 ///< valor atualizado
+#define DIRTY 1 ///< valor precisa ser recalculado
+#define PULLING 2 ///< precedentes sendo calculados antes da célula
+
+// menor quantidade de células de um recálculo dividido entre as threads
+// (recálculos menores são feitos pela thread que alterou a célula)
+#define PARALLEL_MIN_CONE 512
 
 /****************************************************************************
  * Estruturas
  ****************************************************************************/
 
 /**
- * Estrutura da lista de dependências de cada célula
+ * Estrutura de cada célula. Guarda apenas os dados usados ao alterar a
+ * expressão e ao percorrer o grafo; o valor calculado fica no bloco da célula
  */
-typedef struct dependency Dependency;
-struct dependency{
-    int value;
-    Dependency *next;
+typedef struct cell Cell;
+struct cell{
+    Dependents dependents; ///< células que referenciam esta diretamente
+    int expression; ///< handle da expressão no conjunto de textos da matriz
+    Program* program; ///< programa compilado da expressão (NULL se vazia ou número)
+    int literal; ///< se a expressão é apenas um número (valor guardado sem programa)
+
+    int mark; ///< época da última visita em uma busca no grafo
+    int order; ///< posição da célula na ordem topológica mantida
+    int pending; ///< precedentes ainda não calculados durante o recálculo
+    int position; ///< posição da célula no cone durante o recálculo em paralelo
+    int dirty; ///< estado do valor nos modos preguiçoso e manual (CLEAN, DIRTY ou PULLING)
+    int changed; ///< se precisa ser calculada (programa novo ou precedente com valor alterado)
+    int queued; ///< época em que entrou na fila do recálculo pela ordem topológica
 };
 
 /**
- * Estrutura de cada célula
+ * Estrutura de um bloco de células consecutivas (na ordem do índice no grafo).
+ * Os valores ficam em um vetor contíguo à parte, de modo que a leitura de um
+ * intervalo percorre a memória em sequência sem passar pelas células
  */
-typedef struct cell Cell;
-struct cell{
-    Dependency* first;
-    char expression[60];
+typedef struct tile Tile;
+struct tile{
+    double values[TILE_SIZE]; ///< valores calculados, contíguos (0 nas células não alocadas)
+    Cell* cells[TILE_SIZE];
+    int amount; ///< quantidade de células alocadas no bloco
+};
 
-    double value;
+/**
+ * Estrutura de uma página do diretório de blocos
+ */
+typedef struct page Page;
+struct page{
+    Tile* tiles[PAGE_SIZE];
+    int amount; ///< quantidade de blocos alocados na página
 };
 
 /**
- * Estrutura do grafo que conterá as células
+ * Estrutura do grafo que conterá as células. As células ficam em blocos de
+ * tamanho fixo, alocados na primeira escrita e liberados quando esvaziam,
+ * encontrados por um diretório de dois níveis a partir do índice da célula
  */
 typedef struct graph Graph;
 struct graph{
-    Cell* cells[MAX_CELLS];
+    Page* pages[DIRECTORY_SIZE];
 };
 
 /**
@@ -55,6 +109,42 @@ struct matrix{
     int rows;
     int columns;
     Graph graph;
+
+    int epoch; ///< época atual das buscas no grafo
+    StackInt* work; ///< pilha de trabalho das buscas no grafo
+    StackInt* cone; ///< células alcançadas pela última busca
+    StackInt* dependents; ///< dependentes diretos da célula sendo visitada
+    StackInt* batch; ///< células alteradas por uma operação em lote
+
+    StackInt* captured; ///< células cujo valor mudou durante a captura de valores
+    double* capturedValues; ///< valor anterior de cada célula de captured
+    int capturedCapacity; ///< capacidade de capturedValues
+    int captureLimit; ///< máximo de células da captura em andamento (0 se nenhuma)
+
+    RangeIndex* ranges; ///< intervalos usados pelas expressões, com a célula que os usa
+    StackInt* aggregates; ///< células que usam em intervalos a célula cujo valor mudou
+    ColumnIndex** columnIndexes; ///< índice de cada coluna (NULL até um intervalo alto usá-la)
+
+    ThreadPool* threadPool; ///< trabalhadores do recálculo em paralelo (NULL se sequencial)
+    pthread_mutex_t lock; ///< protege as escritas de valores durante o recálculo em paralelo
+    int parallel; ///< se um recálculo em paralelo está em andamento
+    StackInt* edges; ///< posições no cone dos dependentes de cada célula do cone
+    StackInt* offsets; ///< início dos dependentes de cada célula do cone em edges
+
+    int lazy; ///< se as alterações apenas marcam os dependentes (calculados na leitura)
+    int manual; ///< se as alterações apenas marcam os dependentes (calculados sob pedido)
+    int dirtyCells; ///< quantidade de células marcadas (modo preguiçoso ou manual)
+
+    Arena* arena; ///< memória das células, blocos e páginas
+    Pool* cellPool;
+    Pool* tilePool;
+    Pool* pagePool;
+
+    StringPool* strings; ///< textos das expressões (cada texto distinto uma única vez)
+
+    int orderValid; ///< se a ordem topológica das células está válida
+    int lowOrder; ///< menor posição já usada na ordem topológica
+    int highOrder; ///< maior posição já usada na ordem topológica
 };
 
 /****************************************************************************
@@ -62,30 +152,145 @@ struct matrix{
  ****************************************************************************/
 
 /**
- * Desaloca células do grafo recursivamente
- * \param cells Array de ponteiros para Cell
- * \param index Valor que será incrementado a cada chamada da função
- * (começa em zero)
+ * Obtém uma célula do grafo
+ * \return Ponteiro para a célula, ou NULL se não estiver alocada
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
  */
-void MATRIX_freeGraphCells(Cell** cells, int index){
-    if(index >= MAX_CELLS) return;
+Cell* MATRIX_getCell(Matrix** matrix, int cellIndex){
+    Page* page = (*matrix)->graph.pages[cellIndex >> (TILE_BITS+PAGE_BITS)];
+    if(!page) return NULL;
 
-    if(cells[index]){
-        Cell* cell = cells[index];
-        if(cell->first){
-            Dependency* current = cell->first;
-            Dependency* previous = NULL;
-            while(current){
-                previous = current;
-                current = current->next;
-                free(previous);
-            }
-            cell->first = NULL;
+    Tile* tile = page->tiles[(cellIndex >> TILE_BITS) & (PAGE_SIZE-1)];
+    if(!tile) return NULL;
+
+    return tile->cells[cellIndex & (TILE_SIZE-1)];
+}
+
+/**
+ * Obtém a posição do valor de uma célula no vetor de valores do seu bloco
+ * \return Ponteiro para o valor, ou NULL se o bloco não estiver alocado
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+double* MATRIX_getValueSlot(Matrix** matrix, int cellIndex){
+    Page* page = (*matrix)->graph.pages[cellIndex >> (TILE_BITS+PAGE_BITS)];
+    if(!page) return NULL;
+
+    Tile* tile = page->tiles[(cellIndex >> TILE_BITS) & (PAGE_SIZE-1)];
+    if(!tile) return NULL;
+
+    return &tile->values[cellIndex & (TILE_SIZE-1)];
+}
+
+/**
+ * Obtém a posição de uma célula no seu bloco, alocando a página e o bloco
+ * se necessário
+ * \return Ponteiro para a posição da célula, ou NULL em caso de falha de alocação
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+Cell** MATRIX_getSlot(Matrix** matrix, int cellIndex){
+    Page** page = &(*matrix)->graph.pages[cellIndex >> (TILE_BITS+PAGE_BITS)];
+    if(!(*page)){
+        (*page) = POOL_alloc(&(*matrix)->pagePool);
+        if(!(*page)) return NULL;
+        memset((*page), 0, sizeof(Page));
+    }
+
+    Tile** tile = &(*page)->tiles[(cellIndex >> TILE_BITS) & (PAGE_SIZE-1)];
+    if(!(*tile)){
+        (*tile) = POOL_alloc(&(*matrix)->tilePool);
+        if(!(*tile)) return NULL;
+        memset((*tile), 0, sizeof(Tile));
+        (*page)->amount++;
+    }
+
+    return &(*tile)->cells[cellIndex & (TILE_SIZE-1)];
+}
+
+/**
+ * Atualiza a quantidade de células do bloco de uma célula que acabou de ser
+ * alocada ou liberada, liberando o bloco e a página quando esvaziam
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param amount 1 se a célula foi alocada, -1 se foi liberada
+ */
+void MATRIX_countCell(Matrix** matrix, int cellIndex, int amount){
+    Page** page = &(*matrix)->graph.pages[cellIndex >> (TILE_BITS+PAGE_BITS)];
+    Tile** tile = &(*page)->tiles[(cellIndex >> TILE_BITS) & (PAGE_SIZE-1)];
+
+    // célula liberada volta a valer 0
+    if(amount < 0)
+        (*tile)->values[cellIndex & (TILE_SIZE-1)] = 0;
+
+    (*tile)->amount += amount;
+    if((*tile)->amount > 0) return;
+
+    POOL_release(&(*matrix)->tilePool, (*tile));
+    (*tile) = NULL;
+
+    if(--(*page)->amount > 0) return;
+
+    POOL_release(&(*matrix)->pagePool, (*page));
+    (*page) = NULL;
+}
+
+/**
+ * Obtém o índice da próxima célula alocada no grafo, pulando blocos e páginas
+ * não alocados
+ * \return Índice da próxima célula alocada, ou -1 se não houver
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice a partir do qual procurar (informe -1 para começar
+ * do início)
+ */
+int MATRIX_nextCellIndex(Matrix** matrix, int cellIndex){
+    int index = cellIndex + 1, last = (*matrix)->rows * (*matrix)->columns;
+    Page* page;
+    Tile* tile;
+
+    while(index < last){
+        page = (*matrix)->graph.pages[index >> (TILE_BITS+PAGE_BITS)];
+        if(!page){
+            index = ((index >> (TILE_BITS+PAGE_BITS)) + 1) << (TILE_BITS+PAGE_BITS);
+            continue;
         }
-        free(cell);
-        cells[index] = NULL;
+
+        tile = page->tiles[(index >> TILE_BITS) & (PAGE_SIZE-1)];
+        if(!tile){
+            index = ((index >> TILE_BITS) + 1) << TILE_BITS;
+            continue;
+        }
+
+        if(tile->cells[index & (TILE_SIZE-1)]) return index;
+        index++;
+    }
+
+    return -1;
+}
+
+/**
+ * Desaloca todas as células do grafo, seus blocos e páginas. Cada célula só
+ * libera o que alocou fora da arena (programa e conjunto de dependentes); as
+ * células, blocos e páginas são liberados de uma vez junto com a arena
+ * \param matrix Ponteiro duplo para matriz de células
+ */
+void MATRIX_freeGraphCells(Matrix** matrix){
+    int cellIndex = MATRIX_nextCellIndex(&(*matrix), -1);
+    Cell* cell;
+
+    while(cellIndex != -1){
+        cell = MATRIX_getCell(&(*matrix), cellIndex);
+        DEPENDENTS_clear(&cell->dependents);
+        cell->program = PROGRAM_free(cell->program);
+
+        cellIndex = MATRIX_nextCellIndex(&(*matrix), cellIndex);
     }
-    MATRIX_freeGraphCells(cells, index+1);
+
+    (*matrix)->pagePool = POOL_free((*matrix)->pagePool);
+    (*matrix)->tilePool = POOL_free((*matrix)->tilePool);
+    (*matrix)->cellPool = POOL_free((*matrix)->cellPool);
+    (*matrix)->arena = ARENA_free((*matrix)->arena);
 }
 
 /**
@@ -110,39 +315,6 @@ void MATRIX_showError(GraphicInstructions** graphic, const char *errorMessage,
     }
 }
 
-/**
- * Verifica se um caractere é número
- * \return Um valor diferente de 0 se for número, 0 em caso contrário
- * \param value Caractere a ser testado
- */
-int MATRIX_charIsNumber(char value){
-    return (MIN_ASCII_NUMBER<= value && value<=MAX_ASCII_NUMBER);
-}
-
-/**
- * Verifica se um caractere é letra do alfabeto
- * \return 0 se não for letra de alfabeto, 1 se for letra maiúscula e
- * 2 se for letra minúscula
- * \param value Caractere a ser testado
- */
-int MATRIX_charIsAlpha(char value){
-    if(MIN_ASCII_CAP_LETTER<= value && value<=MAX_ASCII_CAP_LETTER)
-        return 1;
-    else if(MIN_ASCII_LETTER<= value && value<=MAX_ASCII_LETTER)
-        return 2;
-    else
-        return 0;
-}
-
-/**
- * Verifica se um caractere é um operador (+, -, * ou /)
- * \return Um valor diferente de 0 se for um operador, 0 em caso contrário
- * \param value Caractere a ser testado
- */
-int MATRIX_charIsOperator(char value){
-    return (value=='+' || value=='-' || value=='*' || value=='/');
-}
-
 /**
  * Calcula índice da célula no grafo com base na linha e coluna
  * \return Valor do índice da célula no grafo
@@ -176,651 +348,1374 @@ int MATRIX_getColumn(int cellIndex, int max_column){
 }
 
 /**
- * Obtém o índice no grafo de uma célula com base na string de referência ('A2' por exemplo)
- * \return Índice da célula no grafo
- * \param expression Expressão que contém a referência
- * \param count Ponteiro para inteiro que indica o índice da referência na expressão
- * \param columns Quantidade de colunas da matriz
+ * Verifica se a linha e a coluna informadas estão dentro da matriz
+ * \return 1 se a célula estiver dentro da matriz, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param row Linha da célula
+ * \param column Coluna da célula
  */
-int MATRIX_getCellIndex_fromReference(const char *expression, int *count, int columns){
-
-    // variáveis para guardar o valor de uma letra, linha e coluna
-    int letter, coords[2];
-
-    // pega valor ascii do caractere e converte para um valor de coluna
-    letter = expression[(*count)];
-    if(MATRIX_charIsAlpha(letter)==1)
-        coords[1] = letter - MIN_ASCII_CAP_LETTER+1;
-    else
-        coords[1] = letter - MIN_ASCII_LETTER+1;
-    // move para o próximo caractere e pega valor da linha
-    (*count)++;
-    coords[0] = expression[(*count)] - MIN_ASCII_NUMBER;
-
-    // retorna o índice da célula no grafo
-    return MATRIX_evalCellIndex(coords[0],coords[1], columns);
+int MATRIX_validCell(Matrix** matrix, int row, int column){
+    return (row >= 1 && row <= (*matrix)->rows && column >= 1 && column <= (*matrix)->columns);
 }
 
 /**
  * Remove uma dependência da célula
+ * \param matrix Ponteiro duplo para a matriz de células
  * \param cell Ponteiro duplo para uma célula da matriz
  * \param value Índice da célula no grafo que irá ser removido
  */
-void MATRIX_removeDependency(Cell** cell, int value){
-    if(!cell || !(*cell) || !(*cell)->first) return;
+void MATRIX_removeDependency(Matrix** matrix, Cell** cell, int value){
+    if(!cell || !(*cell)) return;
 
-    Dependency* current = (*cell)->first;
-    // se encontrou de primeira, remove a dependência
-    if(current->value == value){
-        (*cell)->first = current->next;
-        free(current);
+    if(!DEPENDENTS_remove(&(*cell)->dependents, value)) return;
 
-        // se a célula não contém dependências e nenhuma expressão, libera memória
-        if((*cell)->first == NULL && strcmp((*cell)->expression, "")==0){
-            free(*cell);
-            (*cell) = NULL;
-        }
-        return;
-    }
-
-    // se não encontrou de primeira, procura
-    while(current->next && current->next->value != value)
-        current = current->next;
-
-    // se encontrou, remove e libera a memória
-    if(current->next){
-        Dependency* remove = current->next;
-        current->next = current->next->next;
-        free(remove);
+    // se a célula não contém dependências e nenhuma expressão, libera memória
+    if(!DEPENDENTS_getSize(&(*cell)->dependents) && (*cell)->expression == STRINGPOOL_EMPTY){
+        DEPENDENTS_clear(&(*cell)->dependents);
+        POOL_release(&(*matrix)->cellPool, (*cell));
+        (*cell) = NULL;
     }
-
 }
 
 /**
  * Adiciona uma dependência da célula
+ * \param matrix Ponteiro duplo para a matriz de células
  * \param cell Ponteiro duplo para uma célula da matriz
  * \param value Índice da célula no grafo que irá ser adicionado
  */
-void MATRIX_addDependency(Cell** cell, int value){
+void MATRIX_addDependency(Matrix** matrix, Cell** cell, int value){
 
     // se a célula não estiver alocada, aloca memória
     if(!(*cell)){
-        (*cell) = malloc(sizeof(Cell));
+        (*cell) = POOL_alloc(&(*matrix)->cellPool);
         if(!(*cell)) return;
 
-        (*cell)->first = NULL;
-        strcpy((*cell)->expression, "");
+        DEPENDENTS_init(&(*cell)->dependents);
+        (*cell)->expression = STRINGPOOL_EMPTY;
+        (*cell)->program = NULL;
+        (*cell)->literal = false;
+        (*cell)->mark = 0;
+        (*cell)->dirty = CLEAN;
+        (*cell)->changed = false;
+        (*cell)->queued = 0;
+    }
+
+    // dependências repetidas são ignoradas pelo conjunto
+    DEPENDENTS_add(&(*cell)->dependents, value);
+}
+
+/**
+ * Obtém valor de uma célula para o programa compilado
+ * \return Valor da célula (0 se a célula não estiver alocada)
+ * \param source Ponteiro para a matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+double MATRIX_readValue(void* source, int cellIndex){
+    Matrix* matrix = source;
+    double* value = MATRIX_getValueSlot(&matrix, cellIndex);
+
+    if(!value)
+        return 0;
+
+    return (*value);
+}
+
+/**
+ * Obtém para o programa compilado os valores de células consecutivas, direto do
+ * vetor de valores do bloco (sem passar do final do bloco)
+ * \return Quantidade de células consecutivas disponíveis a partir de cellIndex
+ * \param source Ponteiro para a matriz de células
+ * \param cellIndex Índice da primeira célula no grafo
+ * \param size Quantidade máxima de células desejadas
+ * \param values Variável a ser preenchida com o vetor de valores, ou com NULL se
+ * o bloco não estiver alocado (todas as células valem 0)
+ */
+int MATRIX_readValues(void* source, int cellIndex, int size, const double** values){
+    Matrix* matrix = source;
+    int offset = cellIndex & (TILE_SIZE-1);
+
+    if(size > TILE_SIZE - offset)
+        size = TILE_SIZE - offset;
+
+    (*values) = MATRIX_getValueSlot(&matrix, cellIndex);
+    return size;
+}
+
+/**
+ * Obtém o índice de uma coluna, montando-o com os valores atuais da coluna na
+ * primeira vez que é usado. Apenas as células alocadas são percorridas, e o
+ * índice cobre só as linhas até a última com valor diferente de 0
+ * \return Ponteiro para o índice, ou NULL em caso de falha de alocação
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param column Coluna (começando em 0)
+ */
+ColumnIndex* MATRIX_getColumnIndex(Matrix** matrix, int column){
+    if(!(*matrix)->columnIndexes){
+        (*matrix)->columnIndexes = calloc((*matrix)->columns, sizeof(ColumnIndex*));
+        if(!(*matrix)->columnIndexes) return NULL;
     }
 
-    // se a célula não tiver dependências, adiciona
-    if(!(*cell)->first){
-        (*cell)->first = malloc(sizeof(Dependency));
-        if(!(*cell)->first) return;
+    ColumnIndex** columnIndex = &(*matrix)->columnIndexes[column];
+    if(*columnIndex) return (*columnIndex);
 
-        (*cell)->first->next = NULL;
-        (*cell)->first->value = value;
+    (*columnIndex) = COLUMNINDEX_create();
+    if(!(*columnIndex)) return NULL;
+
+    // o índice começa com todos os valores iguais a 0
+    double value;
+    int current;
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        if(current % (*matrix)->columns != column) continue;
+
+        value = (*MATRIX_getValueSlot(&(*matrix), current));
+        if(value != 0 && !COLUMNINDEX_set(&(*columnIndex), current / (*matrix)->columns, value)){
+            (*columnIndex) = COLUMNINDEX_free(*columnIndex);
+            return NULL;
+        }
+    }
+
+    return (*columnIndex);
+}
+
+/**
+ * Obtém para o programa compilado o resumo de um intervalo de uma coluna pelo
+ * índice da coluna. Apenas intervalos com ao menos COLUMN_INDEX_MIN_ROWS
+ * linhas são resumidos
+ * \return 1 se o resumo foi obtido, 0 se as células devem ser lidas uma a uma
+ * \param source Ponteiro para a matriz de células
+ * \param summary Tipo do resumo (FUNCTIONS_SUMMARY_SUM, _MAX ou _MIN)
+ * \param firstCell Índice da primeira célula (linha de cima)
+ * \param lastCell Índice da última célula (linha de baixo, mesma coluna)
+ * \param value Variável a ser preenchida com o resumo
+ * \param compensation Variável a ser preenchida com o erro de arredondamento do
+ * resumo (apenas na soma; 0 nos demais)
+ */
+int MATRIX_readSummary(void* source, int summary, int firstCell, int lastCell,
+        double* value, double* compensation){
+    Matrix* matrix = source;
+    int first = firstCell / matrix->columns, last = lastCell / matrix->columns;
+
+    if(last - first + 1 < COLUMN_INDEX_MIN_ROWS) return 0;
+
+    if(matrix->parallel)
+        pthread_mutex_lock(&matrix->lock);
+
+    int found = 0;
+    (*compensation) = 0;
+    ColumnIndex* columnIndex = MATRIX_getColumnIndex(&matrix, firstCell % matrix->columns);
+    if(columnIndex){
+        switch(summary){
+        case FUNCTIONS_SUMMARY_SUM:
+            found = COLUMNINDEX_sum(&columnIndex, first, last, &(*value), &(*compensation));
+            break;
+        case FUNCTIONS_SUMMARY_MAX:
+            found = COLUMNINDEX_max(&columnIndex, first, last, &(*value));
+            break;
+        case FUNCTIONS_SUMMARY_MIN:
+            found = COLUMNINDEX_min(&columnIndex, first, last, &(*value));
+            break;
+        }
+    }
+
+    if(matrix->parallel)
+        pthread_mutex_unlock(&matrix->lock);
+
+    return found;
+}
+
+/**
+ * Guarda o valor anterior de uma célula cujo valor mudou durante a captura de
+ * valores. Acima do limite, a captura é abandonada
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param value Valor anterior da célula
+ */
+void MATRIX_captureValue(Matrix** matrix, int cellIndex, double value){
+    int size = STACKINT_getSize(&(*matrix)->captured);
+
+    if(size == (*matrix)->capturedCapacity){
+        int capacity = (*matrix)->capturedCapacity ? (*matrix)->capturedCapacity*2 : 64;
+        double* values = NULL;
+        if(size < (*matrix)->captureLimit)
+            values = realloc((*matrix)->capturedValues, sizeof(double)*capacity);
+        if(!values){
+            (*matrix)->captureLimit = 0;
+            return;
+        }
+
+        (*matrix)->capturedValues = values;
+        (*matrix)->capturedCapacity = capacity;
+    }
+
+    if(size == (*matrix)->captureLimit || !STACKINT_push(&(*matrix)->captured, cellIndex)){
+        (*matrix)->captureLimit = 0;
         return;
     }
 
-    Dependency* current = (*cell)->first;
+    (*matrix)->capturedValues[size] = value;
+}
+
+/**
+ * Guarda o valor de uma célula alocada, atualizando o índice da coluna e
+ * avisando as células que usam a célula em intervalos
+ * \return 1 se o valor mudou (bit a bit), 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param value Novo valor da célula
+ */
+int MATRIX_writeValue(Matrix** matrix, int cellIndex, double value){
+    double* slot = MATRIX_getValueSlot(&(*matrix), cellIndex);
+    if(!slot) return 0;
+
+    double oldValue = (*slot);
+    (*slot) = value;
+
+    // valores iguais bit a bit não mudam nenhum resultado que dependa deles
+    // (0 e -0 são diferentes; o mesmo NaN não)
+    int changed = memcmp(&oldValue, &value, sizeof(double)) != 0;
+    if(changed && (*matrix)->captureLimit)
+        MATRIX_captureValue(&(*matrix), cellIndex, oldValue);
+
+    // NaN nunca é igual a si mesmo e sempre é informado
+    if(oldValue == value) return changed;
+
+    // o índice da coluna que não consegue crescer é descartado (montado de
+    // novo na próxima consulta)
+    int column = MATRIX_getColumn(cellIndex, (*matrix)->columns);
+    if((*matrix)->columnIndexes && (*matrix)->columnIndexes[column-1]
+            && !COLUMNINDEX_set(&(*matrix)->columnIndexes[column-1],
+                MATRIX_getRow(cellIndex, (*matrix)->columns)-1, value))
+        (*matrix)->columnIndexes[column-1] = COLUMNINDEX_free((*matrix)->columnIndexes[column-1]);
+
+    StackInt** aggregates = &(*matrix)->aggregates;
+    STACKINT_clear(&(*aggregates));
+    RANGEINDEX_query(&(*matrix)->ranges, MATRIX_getRow(cellIndex, (*matrix)->columns),
+            column, &(*aggregates));
+    if(STACKINT_isEmpty(&(*aggregates))) return changed;
+
+    // cada célula é avisada uma única vez, mesmo que use a célula em vários
+    // intervalos (o programa percorre todos eles)
+    (*matrix)->epoch++;
 
-    // se encontrou a dependência, simplesmente sai
-    if(current->value == value) return;
+    Cell* cell;
+    int count;
+    for(count=0; count < STACKINT_getSize(&(*aggregates)); count++){
+        cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*aggregates), count));
+        if(!cell || cell->mark == (*matrix)->epoch) continue;
+
+        cell->mark = (*matrix)->epoch;
+        if(!cell->program) continue;
+
+        // só o máximo e o mínimo são atualizados, e de forma exata: o
+        // resultado não depende da ordem em que as mudanças chegam
+        PROGRAM_notifyChange(&cell->program, cellIndex, oldValue, value);
+    }
 
-    while(current->next && current->next->value != value)
-        current = current->next;
+    return changed;
+}
 
-    // se encontrou a dependência, simplesmente sai
-    if(current->next) return;
+/**
+ * Guarda o valor de uma célula alocada. Todas as escritas de valores passam por
+ * aqui: quando o valor muda, as células que usam a célula em intervalos são
+ * avisadas, atualizando ou descartando o resultado parcial das suas funções.
+ * Durante o recálculo em paralelo as escritas são feitas uma de cada vez
+ * \return 1 se o valor mudou (bit a bit), 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param value Novo valor da célula
+ */
+int MATRIX_storeValue(Matrix** matrix, int cellIndex, double value){
+    if(!(*matrix)->parallel)
+        return MATRIX_writeValue(&(*matrix), cellIndex, value);
 
-    // não encontrou a dependência. adiciona
-    current->next = malloc(sizeof(Dependency));
-    if(!current->next) return;
+    pthread_mutex_lock(&(*matrix)->lock);
+    int changed = MATRIX_writeValue(&(*matrix), cellIndex, value);
+    pthread_mutex_unlock(&(*matrix)->lock);
 
-    current->next->next = NULL;
-    current->next->value = value;
+    return changed;
+}
 
+/**
+ * Coloca uma célula em uma posição da ordem topológica, aumentando o limite
+ * dos intervalos que a contêm
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula alocada
+ * \param order Nova posição da célula
+ */
+void MATRIX_setOrder(Matrix** matrix, int cellIndex, int order){
+    MATRIX_getCell(&(*matrix), cellIndex)->order = order;
+    RANGEINDEX_raiseBounds(&(*matrix)->ranges, MATRIX_getRow(cellIndex, (*matrix)->columns),
+            MATRIX_getColumn(cellIndex, (*matrix)->columns), order);
 }
 
 /**
- * Extrai dependências de um intervalo, adicionando ou removendo essas dependências
- * \return Valor atualizado de count
- * \param count Contador que percorre expressão
- * \param expression Expressão que contém o intervalo
- * \param isRemove define se adiciona ou remove a dependência encontrada
- * \param cellIndex Índice da célula que será adicionada/removida da lista
- * de dependências da célula de destino
- * \param matrix Ponteiro para a matriz de células
- * \param firstCell Valor da primeira célula do intervalo (já computada)
- */
-int MATRIX_extractDepsFromInterval(int count, const char* expression, int isRemove,
-        int cellIndex, Matrix** matrix, int firstCell) {
-
-    // última célula do intervalo
-    int lastCell;
-    // flag que indica qual a célula já computada anteriormente
-    int computeFirstCell;
-
-    // percorre linha e coluna
-    int countRow, countColumn;
-
-    // pula os dois pontos
-    count++;
-    // pula espaços em branco
-    while (expression[count] == ' ')
-        count++;
-    // pega segunda referência
-    int cellDestiny = MATRIX_getCellIndex_fromReference(expression, &count,
-            (*matrix)->columns);
-    // verifica qual a referência maior e configura lastCell e firstCell de acordo
-    if (firstCell > cellDestiny) {
-        lastCell = firstCell;
-        firstCell = cellDestiny;
-        computeFirstCell = true;
-    } else {
-        lastCell = cellDestiny;
-        computeFirstCell = false;
-    }
-    // configura variáveis de intervalo
+ * Obtém um limite para a posição na ordem topológica das células de um
+ * intervalo: o limite guardado no índice, se o intervalo já estiver nele, ou a
+ * maior posição entre as células alocadas do intervalo
+ * \return Limite das posições, ou INT_MIN se o intervalo não tiver células
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param firstCell Índice da primeira célula do intervalo
+ * \param lastCell Índice da última célula do intervalo
+ */
+int MATRIX_rangeOrder(Matrix** matrix, int firstCell, int lastCell){
     int firstRow = MATRIX_getRow(firstCell, (*matrix)->columns);
+    int firstColumn = MATRIX_getColumn(firstCell, (*matrix)->columns);
     int lastRow = MATRIX_getRow(lastCell, (*matrix)->columns);
+    int lastColumn = MATRIX_getColumn(lastCell, (*matrix)->columns);
+    int current, column, order = INT_MIN;
+
+    if(RANGEINDEX_getBound(&(*matrix)->ranges, firstRow, firstColumn, lastRow, lastColumn,
+            -1, &order))
+        return order;
+
+    // percorre só as células alocadas das linhas do intervalo
+    for(current = MATRIX_nextCellIndex(&(*matrix), firstCell-1);
+            current != -1 && current <= lastCell;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        column = MATRIX_getColumn(current, (*matrix)->columns);
+        if(column >= firstColumn && column <= lastColumn
+                && MATRIX_getCell(&(*matrix), current)->order > order)
+            order = MATRIX_getCell(&(*matrix), current)->order;
+    }
+
+    return order;
+}
+
+/**
+ * Altera o estado de atualização de uma célula, mantendo a quantidade de células
+ * marcadas da matriz e de cada intervalo que contém a célula
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula alocada
+ * \param dirty Novo estado da célula (CLEAN, DIRTY ou PULLING)
+ */
+void MATRIX_setDirty(Matrix** matrix, int cellIndex, int dirty){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int amount = (dirty != CLEAN) - (cell->dirty != CLEAN);
+
+    cell->dirty = dirty;
+    if(!amount) return;
+
+    (*matrix)->dirtyCells += amount;
+    RANGEINDEX_addCounts(&(*matrix)->ranges, MATRIX_getRow(cellIndex, (*matrix)->columns),
+            MATRIX_getColumn(cellIndex, (*matrix)->columns), amount);
+}
+
+/**
+ * Obtém a quantidade de células marcadas de um intervalo: a guardada no índice,
+ * se o intervalo já estiver nele, ou a contada entre as células alocadas do
+ * intervalo
+ * \return Quantidade de células marcadas do intervalo
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param firstCell Índice da primeira célula do intervalo
+ * \param lastCell Índice da última célula do intervalo
+ */
+int MATRIX_rangeDirty(Matrix** matrix, int firstCell, int lastCell){
+    int firstRow = MATRIX_getRow(firstCell, (*matrix)->columns);
     int firstColumn = MATRIX_getColumn(firstCell, (*matrix)->columns);
+    int lastRow = MATRIX_getRow(lastCell, (*matrix)->columns);
     int lastColumn = MATRIX_getColumn(lastCell, (*matrix)->columns);
-    // percorre intervalo de células
-    for (countRow = firstRow; countRow <= lastRow; countRow++) {
-        for (countColumn = firstColumn; countColumn <= lastColumn; countColumn++) {
-            // não computa primeira ou última célula
-            if ((!computeFirstCell
-                    && (countColumn != firstColumn || countRow != firstRow))
-                    || (computeFirstCell
-                            && (countColumn != lastColumn
-                                    || countRow != lastRow))) {
-                // pega índice da célula
-                cellDestiny = MATRIX_evalCellIndex(countRow, countColumn,
-                        (*matrix)->columns);
-                // remove ou adiciona
-                if (isRemove)
-                    MATRIX_removeDependency(
-                            &((*matrix)->graph.cells[cellDestiny]), cellIndex);
-                else
-                    MATRIX_addDependency(&((*matrix)->graph.cells[cellDestiny]),
-                            cellIndex);
-            }
-        }
+    int current, column, dirty = 0;
+
+    if(!(*matrix)->dirtyCells) return 0;
+
+    if(RANGEINDEX_getCount(&(*matrix)->ranges, firstRow, firstColumn, lastRow, lastColumn,
+            -1, &dirty))
+        return dirty;
+
+    // percorre só as células alocadas das linhas do intervalo
+    for(current = MATRIX_nextCellIndex(&(*matrix), firstCell-1);
+            current != -1 && current <= lastCell;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        column = MATRIX_getColumn(current, (*matrix)->columns);
+        if(column >= firstColumn && column <= lastColumn
+                && MATRIX_getCell(&(*matrix), current)->dirty != CLEAN)
+            dirty++;
     }
-    return count;
+
+    return dirty;
 }
 
 /**
  * Remove ou adiciona todas as dependências em relação a uma célula específica,
- * com base na expressão
+ * com base no programa compilado da sua expressão. Referências simples ficam no
+ * conjunto de dependentes da célula referenciada, e cada intervalo é guardado uma
+ * única vez no índice de intervalos
  * \param matrix Ponteiro duplo para a matriz de células
  * \param cellIndex Índice da célula que será removida da lista de dependência
- * de outras células com base na expressão
- * \param expression Expressão que contém informações de dependências
+ * de outras células com base no programa
+ * \param program Ponteiro duplo para o programa que contém as referências
  * \param isRemove Se true, deverá remover a dependência. Caso contrário, adiciona
  */
-void MATRIX_modDependencies(Matrix** matrix, int cellIndex, const char* expression,
+void MATRIX_modDependencies(Matrix** matrix, int cellIndex, Program** program,
         int isRemove){
 
-    // variáveis para computar intervalos
-    // primeira célula
-    int firstCell;
-
-    int count=0, cellDestiny;
-    // percorre a expressão
-    while(expression[count]!=0){
-
-        // se encontrou dois pontos, então computa intervalo
-        if(expression[count]==':'){
-            // extrair dependências do intervalo e atualiza contador
-            count = MATRIX_extractDepsFromInterval(count, expression,isRemove, cellIndex,
-                    &(*matrix),firstCell);
-        }
+    // primeira e última célula de cada dependência do programa
+    int firstCell, lastCell;
 
-        // faz comparações com base na table ascii
-        // um caractere não-número seguido de um número?
-        else if(MATRIX_charIsAlpha(expression[count])
-                && expression[count+1]!=0 && MATRIX_charIsNumber(expression[count+1])){
+    // posição da célula de destino no seu bloco
+    Cell** slot;
 
-            // pega índice da célula no grafo
-            cellDestiny = MATRIX_getCellIndex_fromReference(expression, &count,
-                    (*matrix)->columns);
+    int count, size = PROGRAM_getPrecedentsSize(&(*program));
+    for(count=0; count < size; count++){
+        PROGRAM_getPrecedent(&(*program), count, &firstCell, &lastCell);
 
-            // remove ou adiciona
+        // intervalos são guardados inteiros no índice de intervalos
+        if(firstCell != lastCell){
             if(isRemove)
-                MATRIX_removeDependency(&((*matrix)->graph.cells[cellDestiny]), cellIndex);
+                RANGEINDEX_remove(&(*matrix)->ranges,
+                        MATRIX_getRow(firstCell, (*matrix)->columns),
+                        MATRIX_getColumn(firstCell, (*matrix)->columns),
+                        MATRIX_getRow(lastCell, (*matrix)->columns),
+                        MATRIX_getColumn(lastCell, (*matrix)->columns), cellIndex);
             else
-                MATRIX_addDependency(&((*matrix)->graph.cells[cellDestiny]), cellIndex);
+                RANGEINDEX_add(&(*matrix)->ranges,
+                        MATRIX_getRow(firstCell, (*matrix)->columns),
+                        MATRIX_getColumn(firstCell, (*matrix)->columns),
+                        MATRIX_getRow(lastCell, (*matrix)->columns),
+                        MATRIX_getColumn(lastCell, (*matrix)->columns), cellIndex,
+                        MATRIX_rangeOrder(&(*matrix), firstCell, lastCell),
+                        MATRIX_rangeDirty(&(*matrix), firstCell, lastCell));
+            continue;
+        }
+
+        // referências simples ficam no conjunto de dependentes da célula
+        if(isRemove){
+            if(!MATRIX_getCell(&(*matrix), firstCell)) continue;
+
+            slot = MATRIX_getSlot(&(*matrix), firstCell);
+            MATRIX_removeDependency(&(*matrix), &(*slot), cellIndex);
+            // célula sem expressão e sem dependências foi liberada; o valor
+            // pode ainda não ter sido calculado (modo preguiçoso, operações em
+            // lote) e passa a ser 0 antes que o bloco seja liberado
+            if(!(*slot)){
+                MATRIX_storeValue(&(*matrix), firstCell, 0);
+                MATRIX_countCell(&(*matrix), firstCell, -1);
+            }
+        }
+        else{
+            slot = MATRIX_getSlot(&(*matrix), firstCell);
+            if(!slot) continue;
 
-            // presume que essa referência é a primeira de um intervalo
-            firstCell = cellDestiny;
+            if(*slot){
+                MATRIX_addDependency(&(*matrix), &(*slot), cellIndex);
+                continue;
+            }
+
+            MATRIX_addDependency(&(*matrix), &(*slot), cellIndex);
+            if(*slot){
+                MATRIX_countCell(&(*matrix), firstCell, 1);
+                // célula nova não possui precedentes: vai para o início da ordem
+                MATRIX_setOrder(&(*matrix), firstCell, --(*matrix)->lowOrder);
+            }
         }
-        // pula um caractere
-        count++;
     }
 }
 
 /**
- * Adiciona valor numérico na pilha de árvore de expressão binária
- * \return Valor de count atualizado
- * \param count Contador que permanece no começo do número (ele é atualizado
- * para o valor de check ao final do algoritmo)
- * \param expression Expressão que contém a sequência numérica
- * \param stackBin Ponteiro para pilha de árvore de expressão numérica
+ * Mostra no gráfico o valor atual da célula
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param graphic Ponteiro duplo para GraphicCells
  */
-int MATRIX_pushNumberValue(int count, char* expression,StackBinExpTree** stackBin) {
-    // usa check para percorrer a expressão mantendo count no lugar
-    int check = count;
+void MATRIX_drawCell(Matrix** matrix, int cellIndex, GraphicCells** graphic){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    if(!cell || !graphic || !(*graphic)) return;
+
+    // células marcadas mostram o valor anterior como desatualizado
+    GRAPHICSCELLS_setStale(&(*graphic), MATRIX_getRow(cellIndex, (*matrix)->columns),
+            MATRIX_getColumn(cellIndex,(*matrix)->columns), cell->dirty != CLEAN);
+
+    // células sem expressão aparecem desabilitadas
+    GRAPHICSCELLS_updateCell(&(*graphic), MATRIX_getRow(cellIndex, (*matrix)->columns),
+            MATRIX_getColumn(cellIndex,(*matrix)->columns),
+            (*MATRIX_getValueSlot(&(*matrix), cellIndex)), KEEP_MARK,
+            !cell->literal && !cell->program);
+}
 
-    // guarda string do número
-    char number_char[60];
+/**
+ * Computa o valor da célula
+ * \return 1 se o valor pode ter mudado, 0 se o novo valor é igual ao anterior
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo que terá o valor atualizado
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_evalCellValue(Matrix ** matrix, int cellIndex, GraphicCells** graphic){
+    // célula liberada: o valor passou a ser 0 quando a expressão foi retirada
+    if(!matrix || !(*matrix) || !MATRIX_getCell(&(*matrix), cellIndex)) return 1;
+
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int changed = 1;
+
+    // número: o valor foi guardado quando a expressão foi definida
+    // se não há programa (expressão vazia), valor da célula é zero
+    // nos demais casos, o valor da célula será o resultado do programa compilado
+    if(!cell->literal && !cell->program)
+        changed = MATRIX_storeValue(&(*matrix), cellIndex, 0);
+    else if(!cell->literal)
+        changed = MATRIX_storeValue(&(*matrix), cellIndex, MATRIX_RUN_PROGRAM(&cell->program,
+                MATRIX_readValue, MATRIX_readValues, MATRIX_readSummary, *matrix));
 
-    // enquanto for caractere pertencente ao número...
-    while (MATRIX_charIsNumber(expression[check]) || expression[check] == '.') {
-        // vai preenchendo number_char
-        number_char[check - count] = expression[check];
-        check++;
+    // atualiza valor no gráfico
+    MATRIX_drawCell(&(*matrix), cellIndex, &(*graphic));
+
+    return changed;
+}
+
+/**
+ * Computa o valor da célula apenas se ela recebeu um novo programa ou se algum
+ * precedente mudou de valor desde o último cálculo. Caso contrário, o valor
+ * atual já é o resultado e os dependentes não precisam ser avisados
+ * \return 1 se o valor pode ter mudado, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_evalChangedValue(Matrix** matrix, int cellIndex, GraphicCells** graphic){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+
+    // no recálculo em paralelo, a indicação é escrita pelas threads dos
+    // precedentes antes de liberarem a célula
+    if(cell){
+        if(!__atomic_load_n(&cell->changed, __ATOMIC_RELAXED)) return 0;
+        __atomic_store_n(&cell->changed, false, __ATOMIC_RELAXED);
     }
-    // final de linha
-    number_char[check - count] = 0;
-    // adiciona valor na pilha de expressão binária
-    STACKBINEXPTREE_pushValue(&(*stackBin), atof(number_char));
-    // atualiza count
-    count = check;
-    return count;
+
+    return MATRIX_evalCellValue(&(*matrix), cellIndex, &(*graphic));
 }
 
 /**
- * Coloca valor da referência na pilha de árvore de expressão binária
- * \return Valor de count atualizado
- * \param expression Expressão que contém a referência
- * \param count Contador que percorre a expressão
- * \param matrix Ponteiro para a matriz de células
- * \param stackBin Ponteiro para a pilha de árvores de expressão binária
- */
-int MATRIX_pushReference(char* expression, int count,
-        Matrix** matrix, StackBinExpTree** stackBin) {
-
-    // pega índice da célula com base na referência
-    int cellTempIndex = MATRIX_getCellIndex_fromReference(expression, &count,
-            (*matrix)->columns);
-    // coloca valor na pilha de expressão binária
-    if (!(*matrix)->graph.cells[cellTempIndex])
-        STACKBINEXPTREE_pushValue(&*stackBin, 0);
-    else
-        STACKBINEXPTREE_pushValue(&*stackBin,
-                (*matrix)->graph.cells[cellTempIndex]->value);
+ * Obtém as células que dependem diretamente de uma célula, tanto por referência
+ * simples (conjunto de dependentes da célula) quanto por intervalo (índice de
+ * intervalos). A célula não precisa estar alocada
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ * \param dependents Ponteiro duplo para a pilha que receberá os índices (é
+ * esvaziada antes)
+ */
+void MATRIX_getDependents(Matrix** matrix, int cellIndex, StackInt** dependents){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    const int* items;
+    int count, size;
+
+    STACKINT_clear(&(*dependents));
+
+    if(cell){
+        items = DEPENDENTS_getItems(&cell->dependents);
+        size = DEPENDENTS_getSize(&cell->dependents);
+        for(count=0; count < size; count++)
+            STACKINT_push(&(*dependents), items[count]);
+    }
 
-    // vai para o próximo caractere
-    count++;
-    return count;
+    RANGEINDEX_query(&(*matrix)->ranges, MATRIX_getRow(cellIndex, (*matrix)->columns),
+            MATRIX_getColumn(cellIndex, (*matrix)->columns), &(*dependents));
 }
 
 /**
- * Extrai lista de valores de uma sequência de referências
- * \return Valor atualizado de count
- * \param count Contador que percorre a expressão
- * \param expression Expressão que contém o intervalo
- * \param matrix Ponteiro para a matriz de células
- * \param firstCell Índice da primeira célula do intervalo no grafo (já computada)
- * \param list Lista de valores a ser computada na função posteriormente
- */
-int MATRIX_extractList(int count, char* expression, Matrix** matrix, int firstCell,
-        ListDouble** list) {
-
-    // flag que indica qual a célula já computada anteriormente
-    int computeFirstCell;
-
-    // última célula do intervalo
-    int lastCell;
-
-    // contadores de linha e coluna
-    int countRow, countColumn;
-
-    // pula os dois pontos
-    count++;
-    // pula espaços em branco
-    while (expression[count] == ' ')
-        count++;
-    // pega segunda referência
-    int cellTempIndex = MATRIX_getCellIndex_fromReference(expression, &count,
-            (*matrix)->columns);
-
-    // verifica qual a referência maior e configura lastCell e firstCell de acordo
-    if (firstCell > cellTempIndex) {
-        lastCell = firstCell;
-        firstCell = cellTempIndex;
-        computeFirstCell = true;
-    } else {
-        lastCell = cellTempIndex;
-        computeFirstCell = false;
-    }
-    // configura variáveis de intervalo
-    int firstRow = MATRIX_getRow(firstCell, (*matrix)->columns);
-    int lastRow = MATRIX_getRow(lastCell, (*matrix)->columns);
-    int firstColumn = MATRIX_getColumn(firstCell, (*matrix)->columns);
-    int lastColumn = MATRIX_getColumn(lastCell, (*matrix)->columns);
-    // percorre intervalo de células
-    for (countRow = firstRow; countRow <= lastRow; countRow++) {
-        for (countColumn = firstColumn; countColumn <= lastColumn;countColumn++) {
-            // não computa primeira ou última célula
-            if ((!computeFirstCell
-                    && (countColumn != firstColumn || countRow != firstRow))
-                    || (computeFirstCell
-                            && (countColumn != lastColumn
-                                    || countRow != lastRow))) {
-                // pega índice da célula
-                cellTempIndex = MATRIX_evalCellIndex(countRow, countColumn,
-                        (*matrix)->columns);
-                // adiciona na lista da função
-                if (!(*matrix)->graph.cells[cellTempIndex])
-                    *list = FUNCTIONS_addValue(*list, 0);
-                else
-                    *list = FUNCTIONS_addValue(*list,
-                            (*matrix)->graph.cells[cellTempIndex]->value);
-            }
+ * Verifica se alguma célula depende diretamente de uma célula
+ * \return 1 se houver células dependentes, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+int MATRIX_hasDependents(Matrix** matrix, int cellIndex){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    if(cell && DEPENDENTS_getSize(&cell->dependents)) return 1;
+
+    MATRIX_getDependents(&(*matrix), cellIndex, &(*matrix)->dependents);
+    return !STACKINT_isEmpty(&(*matrix)->dependents);
+}
+
+/**
+ * Coleta, sem recursão, as células da pilha de trabalho e todas as células que
+ * dependem direta ou indiretamente delas, zerando o contador de precedentes de
+ * cada uma. A pilha de trabalho termina vazia
+ * \param matrix Ponteiro duplo para matriz de células
+ */
+void MATRIX_collectCone(Matrix** matrix){
+    StackInt** work = &(*matrix)->work;
+    StackInt** cone = &(*matrix)->cone;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count, current, dependent;
+
+    STACKINT_clear(&(*cone));
+
+    // marca células visitadas com uma nova época
+    (*matrix)->epoch++;
+
+    for(count=0; count < STACKINT_getSize(&(*work)); count++){
+        cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*work), count));
+        if(cell){
+            cell->mark = (*matrix)->epoch;
+            cell->pending = 0;
+        }
+    }
+
+    // busca em profundidade com pilha explícita
+    while(!STACKINT_isEmpty(&(*work))){
+        current = STACKINT_pop(&(*work));
+        STACKINT_push(&(*cone), current);
+
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(count=0; count < STACKINT_getSize(&(*dependents)); count++){
+            dependent = STACKINT_get(&(*dependents), count);
+            cell = MATRIX_getCell(&(*matrix), dependent);
+            if(!cell || cell->mark == (*matrix)->epoch) continue;
+
+            cell->mark = (*matrix)->epoch;
+            cell->pending = 0;
+            STACKINT_push(&(*work), dependent);
         }
     }
-    // pula para o próximo caractere
-    count++;
-    return count;
 }
 
 /**
- * Adiciona valor da referência na lista que será usada para computar valor da função
- * \return Valor atualizado de count
- * \param count Contador que percorrre a expressão
- * \param countComma Conta quantas vírgulas já apareceram na função
- * \param expression Expressão que contém o número
- * \param matrix Ponteiro para a matriz de células
- * \param list Lista de valores a ser computada pela função posteriormente
- * \param firstCell Guarda índice da primeira célula
+ * Calcula uma célula do cone no recálculo em paralelo (se precisar) e libera os
+ * dependentes cujos precedentes já foram todos calculados
+ * \param threadPool Ponteiro duplo para os trabalhadores
+ * \param worker Trabalhador que executa a tarefa
+ * \param position Posição da célula no cone
+ * \param context Ponteiro para a matriz de células
  */
-int MATRIX_pushReferenceToList(int count, int countComma,char* expression,
-        Matrix** matrix, ListDouble** list, int* firstCell) {
+void MATRIX_evalTask(ThreadPool** threadPool, int worker, int position, void* context){
+    Matrix* matrix = context;
+    Cell* cell;
+    int count, dependent, last = STACKINT_get(&matrix->offsets, position+1);
 
-    // pega índice da célula no grafo
-    int cellTempIndex = MATRIX_getCellIndex_fromReference(expression, &count,
-            (*matrix)->columns);
-    // adiciona valor na lista
-    if (!(*matrix)->graph.cells[cellTempIndex])
-        *list = FUNCTIONS_addValue(*list, 0);
-    else
-        *list = FUNCTIONS_addValue(*list,
-                (*matrix)->graph.cells[cellTempIndex]->value);
+    int changed = MATRIX_evalChangedValue(&matrix, STACKINT_get(&matrix->cone, position), NULL);
+
+    for(count = STACKINT_get(&matrix->offsets, position); count < last; count++){
+        dependent = STACKINT_get(&matrix->edges, count);
+        cell = MATRIX_getCell(&matrix, STACKINT_get(&matrix->cone, dependent));
 
-    // se não encontrou vírgula, é possível primeira célula de um intervalo
-    if (!countComma)
-        *firstCell = cellTempIndex;
+        // a indicação é publicada para a célula junto com o contador
+        if(changed)
+            __atomic_store_n(&cell->changed, true, __ATOMIC_RELAXED);
 
-    // pula para o próximo caractere
-    count++;
-    return count;
+        // quem calcula o último precedente libera a célula
+        if(__atomic_sub_fetch(&cell->pending, 1, __ATOMIC_ACQ_REL) == 0)
+            THREADPOOL_push(&(*threadPool), worker, dependent);
+    }
 }
 
 /**
- * Adiciona valor numérico na lista que será posteriormente processada pela função
- * \return Valor atualizado de count
- * \param count Contador que percorre a expressão
- * \param expression Expressão que possui o valor numérico
- * \para list Lista de valores a ser posteriormente processada pela função
+ * Conta, para cada célula do cone, quantos precedentes também estão no cone
+ * (o contador de cada célula já deve estar zerado). No recálculo em paralelo,
+ * guarda também os dependentes de cada célula como posições no cone, para que
+ * as threads não consultem o grafo
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param parallel Se verdadeiro, guarda os dependentes de cada célula
  */
-int MATRIX_pushNumberToList(int count, char* expression, ListDouble** list) {
-    // usa variável check para percorrer expressão mantendo count no lugar
-    int check = count;
+void MATRIX_countPending(Matrix** matrix, int parallel){
+    StackInt** cone = &(*matrix)->cone;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count, position;
+
+    if(parallel){
+        STACKINT_clear(&(*matrix)->edges);
+        STACKINT_clear(&(*matrix)->offsets);
+        for(count=0; count < STACKINT_getSize(&(*cone)); count++)
+            if((cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*cone), count))))
+                cell->position = count;
+    }
 
-    // guarda valor numérico que possa existir na expressão
-    char number_char[60];
+    for(count=0; count < STACKINT_getSize(&(*cone)); count++){
+        if(parallel)
+            STACKINT_push(&(*matrix)->offsets, STACKINT_getSize(&(*matrix)->edges));
 
-    // enquanto não encontrar vírgula ou parênteses...
-    while (expression[check] != ',' && expression[check] != ')') {
-        // preenche number_char
-        number_char[check - count] = expression[check];
-        check++;
+        MATRIX_getDependents(&(*matrix), STACKINT_get(&(*cone), count), &(*dependents));
+        for(position=0; position < STACKINT_getSize(&(*dependents)); position++)
+            if((cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*dependents), position)))){
+                cell->pending++;
+                if(parallel)
+                    STACKINT_push(&(*matrix)->edges, cell->position);
+            }
     }
-    // final de linha
-    number_char[check - count] = 0;
-    // adiciona valor na lista (converte number_char para double)
-    *list = FUNCTIONS_addValue(*list, atof(number_char));
-    // atualiza count
-    count = check;
-    return count;
+
+    if(parallel)
+        STACKINT_push(&(*matrix)->offsets, STACKINT_getSize(&(*matrix)->edges));
 }
 
 /**
- * Adiciona valor da função na pilha de árvore de expressão binária
- * \return Valor atualizado de count
- * \param count Contador que percorre a expressão
- * \param expression Expressão que contém a função
- * \param matrix Ponteiro para a matriz de células
- * \param stackBin Ponteiro para a pilha de árvore de expressão binária
+ * Calcula as células da fila de trabalho e, à medida que os precedentes de
+ * cada dependente são calculados, também o dependente (células em um ciclo
+ * nunca ficam prontas e não são calculadas). Uma célula só é calculada se
+ * algum precedente mudou de valor, de modo que a propagação termina onde
+ * os valores deixam de mudar
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param graphic Ponteiro duplo para GraphicCells
  */
-int MATRIX_pushFunctionValue(int count, char *expression, Matrix** matrix,
-        StackBinExpTree** stackBin) {
+void MATRIX_evalQueue(Matrix** matrix, GraphicCells** graphic){
+    StackInt** queue = &(*matrix)->work;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count, position, current, changed;
 
-    // usa check para percorrer a expressão mantendo count no lugar
-    int check = count;
+    for(count=0; count < STACKINT_getSize(&(*queue)); count++){
+        current = STACKINT_get(&(*queue), count);
+        changed = MATRIX_evalChangedValue(&(*matrix), current, &(*graphic));
 
-    // guarda nome da função
-    char function[10];
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(position=0; position < STACKINT_getSize(&(*dependents)); position++){
+            cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*dependents), position));
+            if(!cell) continue;
+
+            if(changed)
+                cell->changed = true;
+            if(--cell->pending == 0)
+                STACKINT_push(&(*queue), STACKINT_get(&(*dependents), position));
+        }
+    }
+}
 
-    // Lista de valores para computar em uma função
-    ListDouble* list;
+/**
+ * Recalcula o cone já contado dividindo as células entre as threads: cada
+ * célula fica pronta quando o seu último precedente é calculado. Cada célula é
+ * calculada depois de todos os seus precedentes, então os valores são os
+ * mesmos de um recálculo sequencial em qualquer quantidade de threads. O
+ * gráfico é atualizado no final, por esta thread
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação (nenhuma
+ * célula é calculada)
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param ready Posições no cone das células calculadas primeiro
+ * \param size Quantidade de posições em ready
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_recalculateParallel(Matrix** matrix, const int* ready, int size,
+        GraphicCells** graphic){
+    StackInt** cone = &(*matrix)->cone;
+    Cell* cell;
+    int count;
 
-    // conta vírgulas
-    int countComma;
+    (*matrix)->parallel = true;
+    int done = THREADPOOL_run(&(*matrix)->threadPool, ready, size, STACKINT_getSize(&(*cone)),
+            MATRIX_evalTask, *matrix);
+    (*matrix)->parallel = false;
+    if(!done) return 0;
 
-    // variáveis para computar intervalos
-    // primeira célula
-    int firstCell;
+    if(!graphic || !(*graphic)) return 1;
 
-    // enquanto não encontrar um abre parênteses...
-    while (expression[check] != '(') {
-        // preenche function
-        function[check - count] = expression[check];
-        check++;
+    // células em um ciclo nunca ficam prontas e não são calculadas (a não ser
+    // as calculadas primeiro, que não esperam os precedentes)
+    for(count=0; count < STACKINT_getSize(&(*cone)); count++){
+        cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*cone), count));
+        if(cell && cell->pending == 0)
+            MATRIX_drawCell(&(*matrix), STACKINT_get(&(*cone), count), &(*graphic));
+    }
+    for(count=0; count < size; count++){
+        cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*cone), ready[count]));
+        if(cell && cell->pending != 0)
+            MATRIX_drawCell(&(*matrix), STACKINT_get(&(*cone), ready[count]), &(*graphic));
     }
-    // final de linha
-    function[check - count] = 0;
-    // atualiza count para um caractere a mais que check, para pular o parênteses
-    count = check + 1;
 
-    // cria lista de valores a ser usada com a função
-    list = FUNCTIONS_createList();
-    // inicializa contador de vírgulas
-    countComma = 0;
-    // enquanto o caractere não for fechar parênteses...
-    while (expression[count] != ')') {
+    return 1;
+}
 
-        // pula espaços
-        if (expression[count] == ' ') {
-            count++;
+/**
+ * Calcula as células do cone (com os contadores de precedentes zerados) em
+ * ordem topológica, começando pelas que não têm precedentes no cone. Se o cone
+ * tiver ao menos PARALLEL_MIN_CONE células e a matriz tiver threads, as células
+ * são divididas entre elas; caso contrário (ou em caso de falha de alocação),
+ * são calculadas pela fila de trabalho
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param first Se verdadeiro, a primeira célula do cone (a célula alterada) é
+ * calculada primeiro mesmo que tenha precedentes no cone (em um ciclo)
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+void MATRIX_evalCone(Matrix** matrix, int first, GraphicCells** graphic){
+    StackInt** cone = &(*matrix)->cone;
+    StackInt** ready = &(*matrix)->work;
+    Cell* cell;
+    int count, size = STACKINT_getSize(&(*cone));
+
+    int parallel = (*matrix)->threadPool && size >= PARALLEL_MIN_CONE;
+    MATRIX_countPending(&(*matrix), parallel);
+
+    // primeiro em paralelo (posições no cone) e, se falhar, pela fila (índices)
+    while(1){
+        STACKINT_clear(&(*ready));
+        for(count=0; count < size; count++){
+            cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*cone), count));
+            if((first && count == 0) || (cell && cell->pending == 0))
+                STACKINT_push(&(*ready), parallel ? count : STACKINT_get(&(*cone), count));
         }
 
-        // pula vírgulas
-        else if (expression[count] == ',') {
-            count++;
-            countComma++;
+        if(!parallel){
+            MATRIX_evalQueue(&(*matrix), &(*graphic));
+            return;
         }
+        if(MATRIX_recalculateParallel(&(*matrix), STACKINT_getItems(&(*ready)),
+                STACKINT_getSize(&(*ready)), &(*graphic)))
+            return;
 
-        // se encontrou dois pontos, inicializa intervalo
-        else if (expression[count] == ':') {
-            // extrai lista de valores e atualiza valor do contador
-            count = MATRIX_extractList(count,expression, &(*matrix), firstCell, &list);
-        }
+        parallel = false;
+    }
+}
 
-        // uma referência de célula
-        else if (MATRIX_charIsAlpha(expression[count])
-                && MATRIX_charIsNumber(expression[count + 1])) {
+/**
+ * Coloca uma célula na fila de prioridade (heap binário) do recálculo pela
+ * ordem topológica mantida
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param heap Ponteiro duplo para a pilha usada como heap
+ * \param cellIndex Índice da célula (alocada)
+ */
+int MATRIX_heapPush(Matrix** matrix, StackInt** heap, int cellIndex){
+    int position = STACKINT_getSize(&(*heap)), parent;
+    int order = MATRIX_getCell(&(*matrix), cellIndex)->order;
 
-            // Adiciona valor da referência na lista e atualiza count
-            count = MATRIX_pushReferenceToList(count, countComma,
-                    expression, matrix, &list, &firstCell);
+    if(!STACKINT_push(&(*heap), cellIndex)) return 0;
+
+    while(position > 0){
+        parent = (position-1)/2;
+        if(MATRIX_getCell(&(*matrix), STACKINT_get(&(*heap), parent))->order <= order) break;
+
+        STACKINT_set(&(*heap), position, STACKINT_get(&(*heap), parent));
+        position = parent;
+    }
+    STACKINT_set(&(*heap), position, cellIndex);
+
+    return 1;
+}
+
+/**
+ * Retira da fila de prioridade a célula que vem primeiro na ordem topológica
+ * \return Índice da célula
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param heap Ponteiro duplo para a pilha usada como heap (não vazia)
+ */
+int MATRIX_heapPop(Matrix** matrix, StackInt** heap){
+    int first = STACKINT_get(&(*heap), 0);
+    int last = STACKINT_pop(&(*heap));
+    int size = STACKINT_getSize(&(*heap)), position = 0, child;
+
+    if(!size) return first;
+
+    // a última célula desce a partir da raiz
+    int order = MATRIX_getCell(&(*matrix), last)->order;
+    while((child = 2*position+1) < size){
+        if(child+1 < size && MATRIX_getCell(&(*matrix), STACKINT_get(&(*heap), child+1))->order
+                < MATRIX_getCell(&(*matrix), STACKINT_get(&(*heap), child))->order)
+            child++;
+        if(MATRIX_getCell(&(*matrix), STACKINT_get(&(*heap), child))->order >= order) break;
+
+        STACKINT_set(&(*heap), position, STACKINT_get(&(*heap), child));
+        position = child;
+    }
+    STACKINT_set(&(*heap), position, last);
+
+    return first;
+}
+
+/**
+ * Recalcula uma célula e, seguindo a ordem topológica mantida (que precisa
+ * estar válida), apenas os dependentes de células cujo valor mudou: onde os
+ * valores deixam de mudar, os dependentes nem são visitados. Quando os
+ * dependentes visitados chegam a PARALLEL_MIN_CONE e a matriz tem threads, as
+ * células que estão na fila e os seus dependentes (nenhum deles já calculado,
+ * pois vêm depois na ordem) são terminados pelo cone, sem calcular de novo as
+ * células já calculadas
+ * \return 1 se o recálculo terminou, 0 em caso de falha de alocação
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula alterada
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_propagate(Matrix** matrix, int cellIndex, GraphicCells** graphic){
+    StackInt** heap = &(*matrix)->work;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int count, dependent, visited = 0, current = cellIndex;
+
+    // a época só identifica as células já colocadas na fila (as escritas de
+    // valores usam outras épocas)
+    int epoch = ++(*matrix)->epoch;
+
+    STACKINT_clear(&(*heap));
+    if(cell){
+        cell->changed = true;
+        cell->queued = epoch;
+    }
+
+    while(1){
+        if(MATRIX_evalChangedValue(&(*matrix), current, &(*graphic))){
+            MATRIX_getDependents(&(*matrix), current, &(*dependents));
+            for(count=0; count < STACKINT_getSize(&(*dependents)); count++){
+                dependent = STACKINT_get(&(*dependents), count);
+                cell = MATRIX_getCell(&(*matrix), dependent);
+                if(!cell) continue;
+
+                cell->changed = true;
+                if(cell->queued == epoch) continue;
+
+                cell->queued = epoch;
+                if(!MATRIX_heapPush(&(*matrix), &(*heap), dependent)) return 0;
+                visited++;
+            }
         }
-        // um número
-        else {
-            // usa variável check para percorrer expressão mantendo count no lugar
-            count = MATRIX_pushNumberToList(count,expression, &list);
+
+        if(STACKINT_isEmpty(&(*heap))) return 1;
+
+        // as células da fila já estão indicadas como precisando ser calculadas
+        if((*matrix)->threadPool && visited >= PARALLEL_MIN_CONE){
+            MATRIX_collectCone(&(*matrix));
+            MATRIX_evalCone(&(*matrix), false, &(*graphic));
+            return 1;
         }
+
+        current = MATRIX_heapPop(&(*matrix), &(*heap));
     }
-    // pula para o próximo caractere (que está em um fecha parênteses)
-    count++;
-    // adiciona resultado da função na pilha de árvore de expressão binária
-    STACKBINEXPTREE_pushValue(&*stackBin,
-            FUNCTIONS_evalFunction(function, &list));
-    // libera fila de valores doubles
-    list = FUNCTIONS_free(list);
-    return count;
 }
 
 /**
- * Computa o valor da célula
+ * Recalcula uma célula e as células que dependem dela, em ordem topológica,
+ * calculando cada célula no máximo uma vez e apenas se algum precedente mudou
+ * de valor. A célula alterada pode não estar alocada (quando acabou de ser
+ * esvaziada). Com a ordem topológica mantida válida, só são visitados os
+ * dependentes de células que mudaram; caso contrário, o cone inteiro é
+ * percorrido. Cones com ao menos PARALLEL_MIN_CONE células são divididos entre
+ * as threads da matriz
  * \param matrix Ponteiro duplo para matriz de células
- * \param cellIndex Índice da célula no grafo que terá o valor atualizado
+ * \param cellIndex Índice da célula alterada
  * \param graphic Ponteiro duplo para GraphicCells
  */
-void MATRIX_evalCellValue(Matrix ** matrix, int cellIndex, GraphicCells** graphic){
-    if(!matrix || !(*matrix) || !(*matrix)->graph.cells[cellIndex]) return;
+void MATRIX_recalculate(Matrix** matrix, int cellIndex, GraphicCells** graphic){
+    if((*matrix)->orderValid && MATRIX_propagate(&(*matrix), cellIndex, &(*graphic)))
+        return;
 
-    // copia expressão para uma variável
-    char expression[60];
-    strcpy(expression, (*matrix)->graph.cells[cellIndex]->expression);
+    // a célula alterada sempre é calculada
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    if(cell)
+        cell->changed = true;
 
-    // se expressão vazia, valor da célula é zero
-    if(strcmp(expression,"")==0){
-        // O valor da célula será o resultado da árvore de expressão binária
-        (*matrix)->graph.cells[cellIndex]->value = 0;
+    STACKINT_clear(&(*matrix)->work);
+    STACKINT_push(&(*matrix)->work, cellIndex);
+    MATRIX_collectCone(&(*matrix));
+    MATRIX_evalCone(&(*matrix), true, &(*graphic));
+}
 
-        // atualiza valor no gráfico
-        if(graphic && (*graphic))
-            GRAPHICSCELLS_updateCell(&(*graphic), MATRIX_getRow(cellIndex, (*matrix)->columns),
-                    MATRIX_getColumn(cellIndex,(*matrix)->columns),
-                    (*matrix)->graph.cells[cellIndex]->value, KEEP_MARK, true);
-        return;
+/**
+ * Marca como desatualizadas as células que dependem direta ou indiretamente de
+ * uma célula alterada, sem calculá-las (modos preguiçoso e manual). A busca não
+ * passa por células já marcadas, pois os dependentes delas também já estão
+ * marcados
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula alterada
+ */
+void MATRIX_markDirty(Matrix** matrix, int cellIndex){
+    StackInt** work = &(*matrix)->work;
+    StackInt** marked = &(*matrix)->cone;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int count, current, dependent;
+
+    STACKINT_clear(&(*work));
+    STACKINT_clear(&(*marked));
+
+    // apenas células com programa esperam ser calculadas
+    if(cell && cell->program){
+        cell->changed = true;
+        if(cell->dirty == CLEAN){
+            MATRIX_setDirty(&(*matrix), cellIndex, DIRTY);
+            STACKINT_push(&(*marked), cellIndex);
+        }
     }
+    STACKINT_push(&(*work), cellIndex);
+
+    while(!STACKINT_isEmpty(&(*work))){
+        current = STACKINT_pop(&(*work));
+
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(count=0; count < STACKINT_getSize(&(*dependents)); count++){
+            dependent = STACKINT_get(&(*dependents), count);
+            cell = MATRIX_getCell(&(*matrix), dependent);
+            if(!cell) continue;
+
+            // o valor da célula alterada pode ter mudado: os dependentes diretos
+            // precisam ser calculados (os demais, só se algum precedente mudar)
+            if(current == cellIndex)
+                cell->changed = true;
+            if(cell->dirty != CLEAN) continue;
+
+            MATRIX_setDirty(&(*matrix), dependent, DIRTY);
+            STACKINT_push(&(*marked), dependent);
+            STACKINT_push(&(*work), dependent);
+        }
+    }
+}
 
-    // Pilha de árvore de expressão binária
-    StackBinExpTree* stackBin = STACKBINEXPTREE_create();
+/**
+ * Empilha os precedentes desatualizados de uma célula. Intervalos sem células
+ * marcadas são pulados sem percorrer as suas células
+ * \return Quantidade de precedentes empilhados
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cell Célula
+ * \param work Ponteiro duplo para a pilha
+ */
+int MATRIX_pushDirtyPrecedents(Matrix** matrix, Cell* cell, StackInt** work){
+    Cell* precedent;
+    int count, firstCell, lastCell, row, column, index, pushed = 0;
+    int columns = (*matrix)->columns, size = PROGRAM_getPrecedentsSize(&cell->program);
 
-    // percorre expressão
-    int count=0;
-    while(expression[count] != 0){
+    for(count=0; count < size; count++){
+        PROGRAM_getPrecedent(&cell->program, count, &firstCell, &lastCell);
 
-        // pula espaços em branco
-        if(expression[count]==' '){
-            count++;
-        }
+        if(firstCell != lastCell && !MATRIX_rangeDirty(&(*matrix), firstCell, lastCell))
+            continue;
 
-        // operador
-        else if(MATRIX_charIsOperator(expression[count])){
-            // adiciona operador na pilha de expressão binária
-            STACKBINEXPTREE_pushSymbol(&stackBin, expression[count]);
-            // vai para o próximo caractere
-            count++;
-        }
+        for(row = firstCell/columns; row <= lastCell/columns; row++){
+            for(column = firstCell%columns; column <= lastCell%columns; column++){
+                index = column + row*columns;
+                precedent = MATRIX_getCell(&(*matrix), index);
 
-        // número
-        else if(MATRIX_charIsNumber(expression[count])){
-            // coloca valor numérico na pilha de árvore de expressão binário e
-            // atualiza count
-            count = MATRIX_pushNumberValue(count, expression,&stackBin);
+                // precedentes sendo calculados fecham um ciclo e são ignorados
+                if(precedent && precedent->dirty == DIRTY){
+                    STACKINT_push(&(*work), index);
+                    pushed++;
+                }
+            }
         }
+    }
+
+    return pushed;
+}
+
+/**
+ * Indica aos dependentes diretos de uma célula que o valor dela mudou
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+void MATRIX_markChanged(Matrix** matrix, int cellIndex){
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count;
+
+    MATRIX_getDependents(&(*matrix), cellIndex, &(*dependents));
+    for(count=0; count < STACKINT_getSize(&(*dependents)); count++)
+        if((cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*dependents), count))))
+            cell->changed = true;
+}
+
+/**
+ * Atualiza o valor de uma célula marcada no modo preguiçoso, calculando antes
+ * apenas os precedentes marcados dos quais ela depende (busca em profundidade
+ * com pilha explícita)
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula no grafo
+ */
+void MATRIX_pullValue(Matrix** matrix, int cellIndex){
+    StackInt** work = &(*matrix)->work;
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int current;
+
+    if(!cell || cell->dirty == CLEAN) return;
 
-        // referência para uma célula
-        else if(MATRIX_charIsAlpha(expression[count]) && expression[count+1]!=0
-                && MATRIX_charIsNumber(expression[count+1]) ){
+    STACKINT_clear(&(*work));
+    STACKINT_push(&(*work), cellIndex);
 
-            // coloca valor da referência na pilha de árvore de expressão binária
-            // e atualiza valor de count
-            count = MATRIX_pushReference(expression, count,
-                    &(*matrix), &stackBin);
+    while(!STACKINT_isEmpty(&(*work))){
+        current = STACKINT_get(&(*work), STACKINT_getSize(&(*work))-1);
+        cell = MATRIX_getCell(&(*matrix), current);
+
+        // já calculada por outro caminho
+        if(cell->dirty == CLEAN){
+            STACKINT_pop(&(*work));
+            continue;
         }
 
-        // função
-        else{
-            // Coloca valor da função na pilha de árvore de expressão binária
-            // e atualiza count
-            count = MATRIX_pushFunctionValue(count, expression,&(*matrix),
-                    &stackBin);
+        // primeira visita: calcula antes os precedentes marcados
+        if(cell->dirty == DIRTY){
+            cell->dirty = PULLING;
+            if(MATRIX_pushDirtyPrecedents(&(*matrix), cell, &(*work))) continue;
         }
+
+        // precedentes atualizados: calcula a célula (se algum mudou de valor)
+        STACKINT_pop(&(*work));
+        MATRIX_setDirty(&(*matrix), current, CLEAN);
+        if(MATRIX_evalChangedValue(&(*matrix), current, NULL))
+            MATRIX_markChanged(&(*matrix), current);
     }
+}
 
-    // O valor da célula será o resultado da árvore de expressão binária
-    (*matrix)->graph.cells[cellIndex]->value = STACKBINEXPTREE_pop(&stackBin);
+/**
+ * Calcula todas as células marcadas de uma só vez, em ordem topológica (cada
+ * célula no máximo uma vez, e apenas se algum precedente mudou de valor).
+ * Células marcadas que estão em um ciclo não são calculadas. As células
+ * marcadas que aparecem no gráfico são mostradas no final, calculadas ou não
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+void MATRIX_flushDirty(Matrix** matrix, GraphicCells** graphic){
+    StackInt** marked = &(*matrix)->cone;
+    Cell* cell;
+    int count, current;
 
-    // atualiza valor no gráfico
-    if(graphic && (*graphic))
-        GRAPHICSCELLS_updateCell(&(*graphic), MATRIX_getRow(cellIndex, (*matrix)->columns),
-                MATRIX_getColumn(cellIndex,(*matrix)->columns),
-                (*matrix)->graph.cells[cellIndex]->value, KEEP_MARK, false);
+    if(!(*matrix)->dirtyCells) return;
+
+    STACKINT_clear(&(*marked));
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        cell = MATRIX_getCell(&(*matrix), current);
+        if(cell->dirty == CLEAN) continue;
 
-    // libera pilha de árvore de expressão binária
-    stackBin = STACKBINEXPTREE_free(stackBin);
+        // a célula deixa de estar marcada antes de ser calculada e desenhada
+        cell->dirty = CLEAN;
+        cell->pending = 0;
+        STACKINT_push(&(*marked), current);
+    }
+    (*matrix)->dirtyCells = 0;
+    RANGEINDEX_resetCounts(&(*matrix)->ranges);
+
+    // os dependentes de uma célula marcada também estão marcados: as células
+    // marcadas formam o cone
+    MATRIX_evalCone(&(*matrix), false, NULL);
+
+    // células que não mudaram de valor ainda podem estar desenhadas como
+    // desatualizadas (modo manual)
+    if(!graphic || !(*graphic)) return;
+    for(count=0; count < STACKINT_getSize(&(*marked)); count++){
+        current = STACKINT_get(&(*marked), count);
+        if(GRAPHICSCELLS_isVisible(&(*graphic), MATRIX_getRow(current, (*matrix)->columns),
+                MATRIX_getColumn(current, (*matrix)->columns)))
+            MATRIX_drawCell(&(*matrix), current, &(*graphic));
+    }
 }
 
 /**
- * Calcula valor de todas as células da lista de dependência
+ * Trata uma célula alterada nos modos preguiçoso e manual: marca os dependentes
+ * e, no modo preguiçoso, calcula apenas as células marcadas que aparecem no
+ * gráfico (no modo manual, elas são mostradas como desatualizadas)
  * \param matrix Ponteiro duplo para matriz de células
- * \param cellIndex Índice da célula que terá células dependentes atualizadas
- * \param originalCell Índice da célula original que começou a recursão (no
- * início, cellIndex e originalCell possuem o mesmo valor)
+ * \param cellIndex Índice da célula alterada
  * \param graphic Ponteiro duplo para GraphicCells
  */
-void MATRIX_evalCellDepsValue(Matrix** matrix, int cellIndex, int originalCell,
-        GraphicCells** graphic){
+void MATRIX_invalidate(Matrix** matrix, int cellIndex, GraphicCells** graphic){
+    StackInt** marked = &(*matrix)->cone;
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    int count, current;
+
+    // número ou expressão vazia: o valor já é conhecido
+    if(cell && !cell->program)
+        MATRIX_evalCellValue(&(*matrix), cellIndex, &(*graphic));
+
+    MATRIX_markDirty(&(*matrix), cellIndex);
+    if(!graphic || !(*graphic)) return;
+
+    // a lista de marcadas é usada por MATRIX_pullValue apenas para leitura
+    for(count=0; count < STACKINT_getSize(&(*marked)); count++){
+        current = STACKINT_get(&(*marked), count);
+        if(!GRAPHICSCELLS_isVisible(&(*graphic), MATRIX_getRow(current, (*matrix)->columns),
+                MATRIX_getColumn(current, (*matrix)->columns)))
+            continue;
 
-    Dependency* dep = NULL;
-    if((*matrix)->graph.cells[cellIndex])
-        dep = (*matrix)->graph.cells[cellIndex]->first;
-
-    // enquanto o nó de dependência for diferente de nulo...
-    while(dep){
-        // se o índice da célula dependente for diferente da célula original
-        // (isso evita o problema de loop infinito em referências cíclicas)
-        if(dep->value != originalCell && dep->value != cellIndex){
-            // atualiza valor da célula
-            MATRIX_evalCellValue(&(*matrix), dep->value, &(*graphic));
-            // atualiza valor das células dependentes desta
-            MATRIX_evalCellDepsValue(&(*matrix), dep->value, originalCell, &(*graphic));
-        }
-        dep = dep->next;
+        if(!(*matrix)->manual)
+            MATRIX_pullValue(&(*matrix), current);
+        MATRIX_drawCell(&(*matrix), current, &(*graphic));
     }
 }
 
 /**
- * Procura recursivamente por dependência cíclica
- * \return 1 se encontrar dependência cíclica, e 0 se não encontrar
- * \param cellIndex índice da célula atual que está realizando a checagem
- * \param indexCheck Índice a ser checado (que pode causar uma referência cíclica)
- * \param matrix Ponteiro duplo para Matrix, que possui informações sobre as células
+ * Mostra no gráfico as células alocadas que aparecem nele, calculando antes as
+ * que estiverem marcadas no modo preguiçoso (no modo manual, as marcadas são
+ * mostradas como desatualizadas)
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param graphic Ponteiro duplo para GraphicCells
  */
-int MATRIX_checkCyclicDependencyRecursive(int cellIndex, int indexCheck,
-        Matrix** matrix){
-
-    if(!(*matrix)->graph.cells[cellIndex]) return 0;
+void MATRIX_drawVisible(Matrix** matrix, GraphicCells** graphic){
+    int current;
 
-    Dependency* cellDependency = (*matrix)->graph.cells[cellIndex]->first;
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        if(!GRAPHICSCELLS_isVisible(&(*graphic), MATRIX_getRow(current, (*matrix)->columns),
+                MATRIX_getColumn(current, (*matrix)->columns)))
+            continue;
 
-    int result;
+        if(!(*matrix)->manual)
+            MATRIX_pullValue(&(*matrix), current);
+        MATRIX_drawCell(&(*matrix), current, &(*graphic));
+    }
+}
 
-    // percorre as dependências da célula atual
-    while(cellDependency){
-        // se a dependência atual bate com o índice da célula atual, erro
-        if(cellDependency->value == indexCheck){
+/**
+ * Verifica se uma célula está dentro de alguma dependência de um programa
+ * \return 1 se a célula for referenciada pelo programa, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param program Ponteiro duplo para o programa
+ * \param cellIndex Índice da célula no grafo
+ */
+int MATRIX_programReferences(Matrix** matrix, Program** program, int cellIndex){
+    int row = MATRIX_getRow(cellIndex, (*matrix)->columns);
+    int column = MATRIX_getColumn(cellIndex, (*matrix)->columns);
+    int count, firstCell, lastCell, size = PROGRAM_getPrecedentsSize(&(*program));
+
+    for(count=0; count < size; count++){
+        PROGRAM_getPrecedent(&(*program), count, &firstCell, &lastCell);
+        if(MATRIX_getRow(firstCell, (*matrix)->columns) <= row
+                && row <= MATRIX_getRow(lastCell, (*matrix)->columns)
+                && MATRIX_getColumn(firstCell, (*matrix)->columns) <= column
+                && column <= MATRIX_getColumn(lastCell, (*matrix)->columns))
             return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Recalcula a ordem topológica de todas as células alocadas. A ordem só é
+ * considerada válida se não houver ciclos no grafo
+ * \param matrix Ponteiro duplo para matriz de células
+ */
+void MATRIX_rebuildOrder(Matrix** matrix){
+    StackInt** queue = &(*matrix)->work;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count, position, current, dependent, allocated = 0, order = 0;
+
+    // conta os precedentes de cada célula
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current))
+        MATRIX_getCell(&(*matrix), current)->pending = 0;
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current)){
+        allocated++;
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(position=0; position < STACKINT_getSize(&(*dependents)); position++)
+            if((cell = MATRIX_getCell(&(*matrix), STACKINT_get(&(*dependents), position))))
+                cell->pending++;
+    }
+
+    // ordena a partir das células sem precedentes (os limites dos intervalos
+    // voltam a acompanhar as novas posições)
+    RANGEINDEX_resetBounds(&(*matrix)->ranges, INT_MIN);
+    STACKINT_clear(&(*queue));
+    for(current = MATRIX_nextCellIndex(&(*matrix), -1); current != -1;
+            current = MATRIX_nextCellIndex(&(*matrix), current))
+        if(MATRIX_getCell(&(*matrix), current)->pending == 0)
+            STACKINT_push(&(*queue), current);
+
+    for(count=0; count < STACKINT_getSize(&(*queue)); count++){
+        current = STACKINT_get(&(*queue), count);
+        MATRIX_setOrder(&(*matrix), current, order++);
+
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(position=0; position < STACKINT_getSize(&(*dependents)); position++){
+            dependent = STACKINT_get(&(*dependents), position);
+            cell = MATRIX_getCell(&(*matrix), dependent);
+            if(cell && --cell->pending == 0)
+                STACKINT_push(&(*queue), dependent);
         }
-        // chama função recursiva para checar na célula dependente
-        result = MATRIX_checkCyclicDependencyRecursive(cellDependency->value,
-                indexCheck, &(*matrix));
+    }
+
+    (*matrix)->lowOrder = 0;
+    (*matrix)->highOrder = order;
+    (*matrix)->orderValid = (order == allocated);
+}
+
+/**
+ * Verifica se todas as dependências de um programa vêm antes da célula na
+ * ordem topológica mantida. Cada intervalo é verificado pelo limite guardado
+ * no índice de intervalos, sem percorrer as suas células
+ * \return 1 se a ordem for respeitada, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula que possui o programa
+ * \param program Ponteiro duplo para o programa
+ */
+int MATRIX_respectsOrder(Matrix** matrix, int cellIndex, Program** program){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    Cell* precedent;
+    int count, firstCell, lastCell;
+    int size = PROGRAM_getPrecedentsSize(&(*program));
+
+    if(!(*matrix)->orderValid || !cell) return 0;
 
-        // encontrou dependência cíclica
-        if(result) return 1;
+    for(count=0; count < size; count++){
+        PROGRAM_getPrecedent(&(*program), count, &firstCell, &lastCell);
+
+        if(firstCell != lastCell){
+            if(MATRIX_rangeOrder(&(*matrix), firstCell, lastCell) >= cell->order)
+                return 0;
+            continue;
+        }
 
-        cellDependency = cellDependency->next;
+        precedent = MATRIX_getCell(&(*matrix), firstCell);
+        if(precedent && precedent->order >= cell->order)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Mantém a ordem topológica válida depois que uma célula recebe um novo programa
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula alterada
+ */
+void MATRIX_updateOrder(Matrix** matrix, int cellIndex){
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+
+    if(!(*matrix)->orderValid || !cell) return;
+
+    if(MATRIX_respectsOrder(&(*matrix), cellIndex, &cell->program)) return;
+
+    // se nenhuma célula depende desta, ela pode ir para o final da ordem
+    if(!MATRIX_hasDependents(&(*matrix), cellIndex)){
+        MATRIX_setOrder(&(*matrix), cellIndex, ++(*matrix)->highOrder);
+        return;
+    }
+
+    // a ordem será recalculada na próxima verificação de ciclos
+    (*matrix)->orderValid = false;
+}
+
+/**
+ * Procura por dependência cíclica caso um programa seja colocado em uma célula.
+ * Usa a ordem topológica mantida quando possível e, caso contrário, uma busca
+ * iterativa que visita cada célula dependente uma única vez
+ * \return 1 se houver dependência cíclica, 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz de células
+ * \param cellIndex Índice da célula que receberá o programa
+ * \param program Ponteiro duplo para o programa
+ */
+int MATRIX_findCycle(Matrix** matrix, int cellIndex, Program** program){
+    StackInt** work = &(*matrix)->work;
+    StackInt** dependents = &(*matrix)->dependents;
+    Cell* cell;
+    int count, current, dependent;
+
+    // a célula não pode depender de si mesma
+    if(MATRIX_programReferences(&(*matrix), &(*program), cellIndex)) return 1;
+
+    // se nenhuma célula depende desta, não há como fechar um ciclo
+    if(!MATRIX_hasDependents(&(*matrix), cellIndex)) return 0;
+
+    // se todas as dependências vêm antes da célula na ordem, não há ciclo
+    if(!(*matrix)->orderValid)
+        MATRIX_rebuildOrder(&(*matrix));
+    if(MATRIX_respectsOrder(&(*matrix), cellIndex, &(*program))) return 0;
+
+    // procura alguma dependência entre as células que dependem desta
+    (*matrix)->epoch++;
+    if((cell = MATRIX_getCell(&(*matrix), cellIndex)))
+        cell->mark = (*matrix)->epoch;
+    STACKINT_clear(&(*work));
+    STACKINT_push(&(*work), cellIndex);
+
+    while(!STACKINT_isEmpty(&(*work))){
+        current = STACKINT_pop(&(*work));
+
+        MATRIX_getDependents(&(*matrix), current, &(*dependents));
+        for(count=0; count < STACKINT_getSize(&(*dependents)); count++){
+            dependent = STACKINT_get(&(*dependents), count);
+            cell = MATRIX_getCell(&(*matrix), dependent);
+            if(!cell || cell->mark == (*matrix)->epoch) continue;
+
+            if(MATRIX_programReferences(&(*matrix), &(*program), dependent)) return 1;
+
+            cell->mark = (*matrix)->epoch;
+            STACKINT_push(&(*work), dependent);
+        }
     }
 
-    // tudo ok
     return 0;
 }
 
@@ -837,13 +1732,13 @@ int MATRIX_VAL_checkNumber(const char *expression, int* count, GraphicInstructio
     char message[100];
 
     // percorre número
-    while(MATRIX_charIsNumber(expression[*count]) || expression[*count]=='.')
+    while(REFERENCE_charIsNumber(expression[*count]) || expression[*count]=='.')
             (*count)++;
 
     // se depois de percorrer número encontrar caractere inválido, erro
     if(expression[*count]!=0 && expression[*count]!=' '
-            && !MATRIX_charIsAlpha(expression[*count])
-            && !MATRIX_charIsOperator(expression[*count])){
+            && !REFERENCE_charIsAlpha(expression[*count])
+            && !REFERENCE_charIsOperator(expression[*count])){
         sprintf(message, "caractere nao valido %c na posicao %d",
                 expression[*count],*count);
         MATRIX_showError(&(*graphic), message, 0, "");
@@ -859,44 +1754,41 @@ int MATRIX_VAL_checkNumber(const char *expression, int* count, GraphicInstructio
  * \return 1 em caso de sucesso, e 0 caso contrário
  * \param expression Expressão que contém a referência
  * \param count Contador que percorre a expressão
- * \param charLimitCap Valor ascii para o maior caractere maiúsculo na referência
- * \param charLimit Valor ascii para o maior caractere minúsculo na referência
- * \param intLimit Maior valor numérico na referência
+ * \param rows Quantidade de linhas da matriz de células
+ * \param columns Quantidade de colunas da matriz de células
  * \param graphic Ponteiro para a tela de instruções
  */
-int MATRIX_VAL_checkReference(const char *expression, int *count, int charLimitCap,
-        int charLimit, int intLimit ,GraphicInstructions** graphic){
+int MATRIX_VAL_checkReference(const char *expression, int *count, int rows,
+        int columns, GraphicInstructions** graphic){
 
     // armazena mensagem
     char message[100];
 
-    if(MATRIX_charIsAlpha(expression[*count])==1 && expression[*count] > charLimitCap){
-        sprintf(message,
-           "a referencia %c, na posicao %d, vai alem da quantidade de colunas",
-           expression[*count],*count);
-        MATRIX_showError(&(*graphic), message, 0, __FILE__);
-        return 0;
-    }
-    else if(MATRIX_charIsAlpha(expression[*count])==2
-            && expression[*count] > charLimit){
+    // linha e coluna da referência
+    int row, column;
+    int length = REFERENCE_read(expression + (*count), &row, &column);
+
+    // tamanho da referência mostrado na mensagem
+    int size = length < MESSAGE_REFERENCE_SIZE ? length : MESSAGE_REFERENCE_SIZE;
+
+    if(column > columns){
         sprintf(message,
-           "a referencia %c, na posicao %d, vai alem da quantidade de colunas",
-           expression[*count],*count);
+           "a referencia %.*s, na posicao %d, vai alem da quantidade de colunas",
+           size, expression + (*count), *count);
         MATRIX_showError(&(*graphic), message, 0, "");
         return 0;
     }
 
-    // vai para a parte numérica da referência
-    (*count)++;
-    if(expression[*count] > intLimit || expression[*count]==MIN_ASCII_NUMBER){
+    if(row < 1 || row > rows){
         sprintf(message,
-           "a referencia %c, na posicao %d, vai alem da quantidade de linhas",
-           expression[*count],*count);
+           "a referencia %.*s, na posicao %d, vai alem da quantidade de linhas",
+           size, expression + (*count), *count);
         MATRIX_showError(&(*graphic), message, 0,"");
         return 0;
     }
+
     // vai para o próximo caractere
-    (*count)++;
+    (*count) += length;
 
     return 1;
 }
@@ -932,7 +1824,7 @@ int MATRIX_VAL_FUNC_checkNumber(const char *expression, int countColon, int coun
     if(!countColon && !countComma)
         *typeFirstArgument = 'n';
 
-    while(MATRIX_charIsNumber(expression[*count]) || expression[*count]=='.')
+    while(REFERENCE_charIsNumber(expression[*count]) || expression[*count]=='.')
         (*count)++;
 
     return 1;
@@ -951,13 +1843,12 @@ int MATRIX_VAL_FUNC_checkNumber(const char *expression, int countColon, int coun
  * \param typeFirstArgument Controla se o primeiro argumento da função é
  * um número ('n') ou uma referência ('r'). a ser preenchido pela função
  * (essa não é uma string literal, e sim um ponteiro para char)
- * \param charLimitCap Valor ascii para o maior caractere maiúsculo na referência
- * \param charLimit Valor ascii para o maior caractere minúsculo na referência
- * \param intLimit Maior valor numérico na referência
+ * \param rows Quantidade de linhas da matriz de células
+ * \param columns Quantidade de colunas da matriz de células
  */
 int MATRIX_VAL_FUNC_checkReference(const char *expression, int *count, int *countReference,
         int countColon, int countComma, const char *function, GraphicInstructions** graphic,
-        char * typeFirstArgument, int charLimitCap, int charLimit, int intLimit){
+        char * typeFirstArgument, int rows, int columns){
 
     // guarda mensagem
     char message[100];
@@ -980,43 +1871,11 @@ int MATRIX_VAL_FUNC_checkReference(const char *expression, int *count, int *coun
     else if(countColon && *typeFirstArgument=='n'){
         sprintf(message,"expressao inadequada na funcao %s",function);
         MATRIX_showError(&(*graphic), message, 0, "");
-        return 0;
-    }
-
-    // referência vai além da quantidade de colunas
-    if(MATRIX_charIsAlpha(expression[*count])==1
-            && expression[*count] > charLimitCap){
-        sprintf(message,
-     "a referencia %c, na posicao %d, vai alem da quantidade de colunas",
-           expression[*count],*count);
-        MATRIX_showError(&(*graphic), message, 0, "");
-        return 0;
-    }
-    else if(MATRIX_charIsAlpha(expression[*count])==2
-            && expression[*count] > charLimit){
-        sprintf(message,
-    "a referencia %c, na posicao %d, vai alem da quantidade de colunas",
-           expression[*count],*count);
-        MATRIX_showError(&(*graphic), message, 0, "");
-        return 0;
-    }
-
-    // vai para a parte numérica da referência
-    (*count)++;
-
-    // referência vai além da quantidade de linhas
-    if(expression[*count] > intLimit || expression[*count]==MIN_ASCII_NUMBER){
-        sprintf(message,
-      "a referencia %c, na posicao %d, vai alem da quantidade de linhas",
-           expression[*count],*count);
-        MATRIX_showError(&(*graphic), message, 0,"");
-        return 0;
-    }
-
-    // vai para o próximo caractere
-    (*count)++;
+        return 0;
+    }
 
-    return 1;
+    // referência vai além da quantidade de linhas ou colunas
+    return MATRIX_VAL_checkReference(expression, &(*count), rows, columns, &(*graphic));
 }
 
 /**
@@ -1024,16 +1883,15 @@ int MATRIX_VAL_FUNC_checkReference(const char *expression, int *count, int *coun
  * \return 1 se estiver tudo ok, 0 em caso contrário
  * \param expression Expressão que contém a função
  * \param count Contador que percorre a expressão
- * \param charLimitCap Valor ascii para o maior caractere maiúsculo na referência
- * \param charLimit Valor ascii para o maior caractere minúsculo na referência
- * \param intLimit Maior valor numérico na referência
+ * \param rows Quantidade de linhas da matriz de células
+ * \param columns Quantidade de colunas da matriz de células
  * \param graphic Ponteiro para a tela de instruções
  */
-int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCap,
-        int charLimit, int intLimit, GraphicInstructions** graphic){
+int MATRIX_VAL_checkFunction(const char *expression, int *count, int rows,
+        int columns, GraphicInstructions** graphic){
 
     // guarda nome da função
-    char function[10];
+    char function[FUNCTIONS_NAME_SIZE];
 
     // guarda mensagem
     char message[100];
@@ -1045,18 +1903,23 @@ int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCa
     char typeFirstArgument = '-';
 
     // usa check para percorrer a expressão mantendo count no lugar
-    int check=*count;
+    int check=*count, size=0;
     // enquanto não encontrar um abre parênteses...
-    while(expression[check]!='('){
+    while(expression[check]!=0 && expression[check]!='('){
         // preenche function
-        function[check-(*count)] = expression[check];
+        if(size < (int) sizeof(function)-1)
+            function[size++] = expression[check];
         check++;
     }
     // final de linha
-    function[check-(*count)] = 0;
+    function[size] = 0;
+
+    // descrição da função no registro
+    const FunctionDefinition* definition = FUNCTIONS_getDefinition(
+            FUNCTIONS_getFunction(function));
 
-    // se a função não existir, sai com erro
-    if(!FUNCTIONS_isFunction(function)){
+    // se a função não existir (ou não abrir parênteses), sai com erro
+    if(!definition || expression[check]==0){
         sprintf(message, "funcao %s nao existente na posicao %d", function,*count);
         MATRIX_showError(&(*graphic), message, 0, "");
         return 0;
@@ -1070,6 +1933,9 @@ int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCa
     // contador de referências começa em zero
     int countReference = 0;
 
+    // linha e coluna de uma referência
+    int row, column;
+
     // enquanto não encontrar um fecha parênteses...
     while(expression[*count]!=')'){
 
@@ -1108,7 +1974,7 @@ int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCa
         }
 
         // número
-        if(MATRIX_charIsNumber(expression[*count])){
+        if(REFERENCE_charIsNumber(expression[*count])){
 
             // verifica se número é válido
             if(!MATRIX_VAL_FUNC_checkNumber(expression, countColon, countComma,
@@ -1116,13 +1982,12 @@ int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCa
 
         }
         // referência de célula
-        else if(MATRIX_charIsAlpha(expression[*count]) && expression[(*count)+1]!=0
-                && MATRIX_charIsNumber(expression[(*count)+1])){
+        else if(REFERENCE_read(expression + (*count), &row, &column)){
 
             // verifica se a referência é válida
             if(!MATRIX_VAL_FUNC_checkReference(expression,&(*count),&countReference,countColon,
-                    countComma, function, &(*graphic), &typeFirstArgument,charLimitCap,
-                    charLimit, intLimit)) return 0;
+                    countComma, function, &(*graphic), &typeFirstArgument, rows,
+                    columns)) return 0;
         }
         // caractere inválido
         else{
@@ -1139,45 +2004,406 @@ int MATRIX_VAL_checkFunction(const char *expression, int *count, int charLimitCa
             return 0;
         }
     }
+
+    // quantidade de argumentos (um intervalo conta como um argumento)
+    int arguments = (typeFirstArgument=='-') ? 0 : countComma+1;
+
+    if(arguments < definition->minArguments
+            || (definition->maxArguments != -1 && arguments > definition->maxArguments)){
+        sprintf(message,"quantidade de argumentos inadequada na funcao %s",function);
+        MATRIX_showError(&(*graphic), message, 0,"");
+        return 0;
+    }
+
+    if(countColon && !definition->acceptsRanges){
+        sprintf(message,"funcao %s nao aceita intervalos",function);
+        MATRIX_showError(&(*graphic), message, 0,"");
+        return 0;
+    }
+
     // está em um parênteses
     (*count)++;
 
     return 1;
 }
 
+/**
+ * Coloca uma expressão em uma célula, atualizando as dependências, sem calcular
+ * a célula nem as que dependem dela
+ * \return 1 se obtiver sucesso, e 0 caso contrário
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param expression expressão a ser colocada na célula
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer. Informe NULL caso
+ * não queira guarda a informação na fila de desfazer/refazer
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_installExpression(Matrix** matrix, int row, int column, const char* expression,
+        UndoRedoCells** undoRedo, GraphicCells** graphic){
+    int cellIndex = MATRIX_evalCellIndex(row, column, (*matrix)->columns);
+
+    // texto da nova expressão no conjunto de textos (com uma referência da célula)
+    int newExpression = STRINGPOOL_intern(&(*matrix)->strings, expression);
+    if(newExpression == -1) return 0;
+
+    // ponteiro para a célula de interesse
+    Cell* cell = MATRIX_getCell(&(*matrix), cellIndex);
+    if(!cell){
+        Cell** slot = MATRIX_getSlot(&(*matrix), cellIndex);
+        if(!slot){
+            STRINGPOOL_release(&(*matrix)->strings, newExpression);
+            return 0;
+        }
+
+        cell = POOL_alloc(&(*matrix)->cellPool);
+        if(!cell){
+            // libera o bloco caso tenha sido alocado apenas para esta célula
+            (*slot) = NULL;
+            MATRIX_countCell(&(*matrix), cellIndex, 0);
+            STRINGPOOL_release(&(*matrix)->strings, newExpression);
+            return 0;
+        }
+
+        DEPENDENTS_init(&cell->dependents);
+        cell->expression = STRINGPOOL_EMPTY;
+        cell->program = NULL;
+        cell->literal = false;
+        cell->mark = 0;
+        cell->dirty = CLEAN;
+        cell->changed = false;
+        cell->queued = 0;
+
+        (*slot) = cell;
+        MATRIX_countCell(&(*matrix), cellIndex, 1);
+
+        // célula nova ainda não possui precedentes: vai para o início da ordem
+        MATRIX_setOrder(&(*matrix), cellIndex, --(*matrix)->lowOrder);
+    }
+
+    // guarda expressão atual (que será anterior) da célula
+    int oldExpression = cell->expression;
+
+    // um número é guardado diretamente como valor, sem programa nem dependências;
+    // as demais expressões são compiladas uma única vez
+    double literal;
+    int isLiteral = PROGRAM_readLiteral(expression, &literal);
+    Program* program = NULL;
+    if(!isLiteral)
+        program = PROGRAM_compile(expression, (*matrix)->columns);
+
+    // retira dependências em relação à célula atual, com base no antigo programa
+    if(cell->program)
+        MATRIX_modDependencies(&(*matrix), cellIndex, &cell->program, true);
+
+    // adiciona dependências em relação à célula atual, com base no novo programa
+    if(program)
+        MATRIX_modDependencies(&(*matrix), cellIndex, &program, false);
+
+    // substitui o programa da célula
+    cell->program = PROGRAM_free(cell->program);
+    cell->program = program;
+    cell->literal = isLiteral;
+    if(isLiteral)
+        MATRIX_storeValue(&(*matrix), cellIndex, literal);
+
+    // sem programa, a célula não espera mais ser calculada
+    if(!program)
+        MATRIX_setDirty(&(*matrix), cellIndex, CLEAN);
+
+    // mantém a ordem topológica usada na verificação de ciclos
+    MATRIX_updateOrder(&(*matrix), cellIndex);
+
+    // se undoRedo não nulo, adiciona na fila de desfazer/refazer
+    if(undoRedo && (*undoRedo)){
+        UNDOREDOCELLS_newItem(&(*undoRedo), oldExpression, newExpression, cellIndex);
+    }
+
+    // guarda nova expressão, retirando a referência da célula à anterior
+    cell->expression = newExpression;
+    STRINGPOOL_release(&(*matrix)->strings, oldExpression);
+
+    // se a célula possui expressão vazia e nenhuma outra a referencia
+    // diretamente, desaloca (células que a usam em intervalos ainda são
+    // recalculadas abaixo)
+    if(cell->expression == STRINGPOOL_EMPTY && !DEPENDENTS_getSize(&cell->dependents)){
+        MATRIX_storeValue(&(*matrix), cellIndex, 0);
+        cell->program = PROGRAM_free(cell->program);
+        POOL_release(&(*matrix)->cellPool, cell);
+        (*MATRIX_getSlot(&(*matrix), cellIndex)) = NULL;
+        MATRIX_countCell(&(*matrix), cellIndex, -1);
+        if(graphic)
+            GRAPHICSCELLS_updateCell(&(*graphic), row, column, 0, KEEP_MARK, true);
+    }
+
+    return 1;
+}
+
+/**
+ * Calcula, em uma só passagem em ordem topológica, células cujas expressões
+ * acabaram de ser colocadas (MATRIX_installExpression) e as que dependem delas,
+ * cada uma uma única vez (nos modos preguiçoso e manual, apenas marcadas)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param cells Ponteiro duplo para a pilha com as células alteradas
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+void MATRIX_recalculateCells(Matrix** matrix, StackInt** cells, GraphicCells** graphic){
+    Cell* cell;
+    int count, cellIndex;
+
+    // números e expressões vazias já têm o valor conhecido; as demais células e
+    // as que dependem delas são marcadas (cada célula uma única vez)
+    for(count=0; count < STACKINT_getSize(&(*cells)); count++){
+        cellIndex = STACKINT_get(&(*cells), count);
+        cell = MATRIX_getCell(&(*matrix), cellIndex);
+        if(cell && !cell->program)
+            MATRIX_evalCellValue(&(*matrix), cellIndex, &(*graphic));
+
+        MATRIX_markDirty(&(*matrix), cellIndex);
+    }
+
+    if(!(*matrix)->lazy && !(*matrix)->manual)
+        MATRIX_flushDirty(&(*matrix), &(*graphic));
+    else if(graphic && (*graphic))
+        MATRIX_drawVisible(&(*matrix), &(*graphic));
+}
+
+/**
+ * Abre na fila de desfazer/refazer o grupo de uma alteração e, se possível,
+ * começa a guardar o valor anterior de cada célula cujo valor mudar. Os
+ * valores só são guardados no cálculo automático, com todas as células
+ * calculadas
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer (ou NULL)
+ */
+void MATRIX_beginCapture(Matrix** matrix, UndoRedoCells** undoRedo){
+    if(!undoRedo || !(*undoRedo)) return;
+
+    UNDOREDOCELLS_beginGroup(&(*undoRedo));
+
+    if((*matrix)->lazy || (*matrix)->manual || (*matrix)->dirtyCells) return;
+
+    STACKINT_clear(&(*matrix)->captured);
+    (*matrix)->captureLimit = UNDOREDOCELLS_getSnapshotLimit(&(*undoRedo));
+}
+
+/**
+ * Fecha o grupo aberto por MATRIX_beginCapture, guardando nele os valores
+ * das células alteradas, antes e depois da alteração
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer (ou NULL)
+ */
+void MATRIX_endCapture(Matrix** matrix, UndoRedoCells** undoRedo){
+    if(!undoRedo || !(*undoRedo)) return;
+
+    if((*matrix)->captureLimit){
+        (*matrix)->captureLimit = 0;
+
+        const int* cells = STACKINT_getItems(&(*matrix)->captured);
+        int count, size = STACKINT_getSize(&(*matrix)->captured);
+        double* after = malloc(sizeof(double)*(size ? size : 1));
+        if(after){
+            for(count=0; count < size; count++)
+                after[count] = MATRIX_readValue(*matrix, cells[count]);
+
+            UNDOREDOCELLS_setSnapshot(&(*undoRedo), size, cells,
+                    (*matrix)->capturedValues, after);
+            free(after);
+        }
+    }
+
+    UNDOREDOCELLS_endGroup(&(*undoRedo));
+}
+
+/**
+ * Coloca nas células os valores guardados junto a um grupo da fila de
+ * desfazer/refazer, sem calcular nenhuma célula, e mostra no gráfico as
+ * células alteradas
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param size Quantidade de células
+ * \param cells Índice de cada célula
+ * \param values Valor de cada célula
+ * \param undo Se os valores são os anteriores à alteração (colocados do último
+ * para o primeiro, de modo que o valor mais antigo de uma célula repetida
+ * prevaleça)
+ * \param cellsInstalled Ponteiro duplo para a pilha com as células que
+ * receberam expressão
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+void MATRIX_restoreValues(Matrix** matrix, int size, const int* cells, const double* values,
+        int undo, StackInt** cellsInstalled, GraphicCells** graphic){
+    int count, index;
+
+    for(count=0; count < size; count++){
+        index = undo ? size-1 - count : count;
+        MATRIX_storeValue(&(*matrix), cells[index], values[index]);
+    }
+
+    if(!graphic || !(*graphic)) return;
+
+    for(count=0; count < size; count++)
+        MATRIX_drawCell(&(*matrix), cells[count], &(*graphic));
+    for(count=0; count < STACKINT_getSize(&(*cellsInstalled)); count++)
+        MATRIX_drawCell(&(*matrix), STACKINT_get(&(*cellsInstalled), count), &(*graphic));
+}
+
+/**
+ * Desfaz ou refaz o próximo grupo de alterações da fila. Se o grupo guarda os
+ * valores das células alteradas, eles são colocados diretamente; caso
+ * contrário, um grupo de uma só célula é calculado como em MATRIX_setExpression
+ * e, em um grupo maior, todas as expressões são colocadas antes e as células
+ * são calculadas uma única vez
+ * \return 1 se obtiver sucesso e 0 em caso contrário
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer
+ * \param redo Se refaz (true) ou desfaz (false)
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_replay(Matrix** matrix, UndoRedoCells** undoRedo, int redo, GraphicCells** graphic){
+    StackInt** batch = &(*matrix)->batch;
+    const int* cells = NULL;
+    const double* values = NULL;
+    int expression, cellIndex, row, column, last, size = 0, snapshot = false, success = 1;
+
+    // valores guardados só valem a partir de células todas calculadas
+    int restore = !(*matrix)->lazy && !(*matrix)->manual && !(*matrix)->dirtyCells;
+
+    STACKINT_clear(&(*batch));
+
+    do{
+        // variáveis a serem obtidas da fila undoRedo
+        if(redo ? !UNDOREDOCELLS_redo(&(*undoRedo), &expression, &cellIndex)
+                : !UNDOREDOCELLS_undo(&(*undoRedo), &expression, &cellIndex))
+            break;
+
+        last = !(redo ? UNDOREDOCELLS_redoContinues(&(*undoRedo))
+                : UNDOREDOCELLS_undoContinues(&(*undoRedo)));
+
+        // os valores ficam no item mais recente do grupo: o primeiro a ser
+        // desfeito e o último a ser refeito
+        if(restore && (redo ? last : STACKINT_isEmpty(&(*batch))))
+            snapshot = UNDOREDOCELLS_getSnapshot(&(*undoRedo), &size, &cells, &values);
+
+        // obtém linha e coluna correspondentes
+        row = MATRIX_getRow(cellIndex, (*matrix)->columns);
+        column = MATRIX_getColumn(cellIndex, (*matrix)->columns);
+
+        // alteração isolada: calcula apenas o que de fato mudar
+        if(!snapshot && last && STACKINT_isEmpty(&(*batch)))
+            return MATRIX_setExpression(&(*matrix), row, column,
+                    STRINGPOOL_get(&(*matrix)->strings, expression), NULL, &(*graphic));
+
+        // preenche expressão da célula correta, sem colocar na pilha novamente
+        if(!MATRIX_installExpression(&(*matrix), row, column,
+                STRINGPOOL_get(&(*matrix)->strings, expression), NULL, &(*graphic))
+                || !STACKINT_push(&(*batch), cellIndex))
+            success = 0;
+    } while(!last);
+
+    if(snapshot && success)
+        MATRIX_restoreValues(&(*matrix), size, cells, values, !redo, &(*batch), &(*graphic));
+    else
+        MATRIX_recalculateCells(&(*matrix), &(*batch), &(*graphic));
+
+    return success;
+}
+
 /****************************************************************************
  * Funções públicas
  ****************************************************************************/
 
 /**
- * Cria uma matriz com a quantidade de linhas e colunas especificadas
- * \return Ponteiro para a matriz criada
+ * Cria uma matriz com a quantidade de linhas e colunas especificadas. As células
+ * só ocupam memória quando recebem uma expressão ou são referenciadas
+ * \return Ponteiro para a matriz criada, ou NULL se as dimensões forem inválidas
+ * (limitadas por MATRIX_MAX_ROWS e MATRIX_MAX_COLUMNS) ou em caso de falha de alocação
  * \param rows Quantidade de linhas da matriz
  * \param columns Quantidade de colunas da matriz
  */
 Matrix* MATRIX_create(int rows, int columns){
+    if(rows < 1 || rows > MATRIX_MAX_ROWS || columns < 1 || columns > MATRIX_MAX_COLUMNS)
+        return NULL;
+
     Matrix* matrix = malloc(sizeof(Matrix));
     if(!matrix) return NULL;
 
     matrix->rows = rows;
     matrix->columns = columns;
 
+    matrix->epoch = 0;
+    matrix->orderValid = true;
+    matrix->lowOrder = 0;
+    matrix->highOrder = 0;
+    matrix->work = STACKINT_create();
+    matrix->cone = STACKINT_create();
+    matrix->dependents = STACKINT_create();
+    matrix->batch = STACKINT_create();
+    matrix->captured = STACKINT_create();
+    matrix->capturedValues = NULL;
+    matrix->capturedCapacity = 0;
+    matrix->captureLimit = 0;
+    matrix->ranges = RANGEINDEX_create();
+    matrix->aggregates = STACKINT_create();
+    matrix->columnIndexes = NULL;
+    matrix->threadPool = NULL;
+    matrix->parallel = false;
+    matrix->lazy = false;
+    matrix->manual = false;
+    matrix->dirtyCells = 0;
+    matrix->edges = STACKINT_create();
+    matrix->offsets = STACKINT_create();
+    pthread_mutex_init(&matrix->lock, NULL);
+
     int count;
-    for(count=0; count<MAX_CELLS; count++)
-        matrix->graph.cells[count] = NULL;
+    for(count=0; count < DIRECTORY_SIZE; count++)
+        matrix->graph.pages[count] = NULL;
+
+    // células, blocos e páginas são reservados em grupos na arena
+    matrix->arena = ARENA_create(ARENA_BLOCK_SIZE);
+    matrix->cellPool = POOL_create(&matrix->arena, sizeof(Cell), TILE_SIZE);
+    matrix->tilePool = POOL_create(&matrix->arena, sizeof(Tile), TILE_POOL_SLAB);
+    matrix->pagePool = POOL_create(&matrix->arena, sizeof(Page), 1);
+    matrix->strings = STRINGPOOL_create();
+
+    if(!matrix->work || !matrix->cone || !matrix->dependents || !matrix->batch
+            || !matrix->captured            || !matrix->ranges
+            || !matrix->aggregates || !matrix->edges || !matrix->offsets
+            || !matrix->cellPool || !matrix->tilePool || !matrix->pagePool
+            || !matrix->strings)
+        return MATRIX_free(matrix);
 
     return matrix;
 }
 
 /**
- * Libera memória alocada na matriz
+ * Libera memória alocada na matriz. Filas de desfazer/refazer criadas com o
+ * conjunto de textos da matriz (MATRIX_getStrings) devem ser liberadas antes
  * \return NULL
  * \param matrix Ponteiro para matriz Matrix
  */
 Matrix* MATRIX_free(Matrix* matrix){
     if(!matrix) return NULL;
 
-    MATRIX_freeGraphCells(matrix->graph.cells, 0);
+    matrix->threadPool = THREADPOOL_free(matrix->threadPool);
+    MATRIX_freeGraphCells(&matrix);
+    matrix->work = STACKINT_free(matrix->work);
+    matrix->cone = STACKINT_free(matrix->cone);
+    matrix->dependents = STACKINT_free(matrix->dependents);
+    matrix->batch = STACKINT_free(matrix->batch);
+    matrix->captured = STACKINT_free(matrix->captured);
+    free(matrix->capturedValues);
+    matrix->aggregates = STACKINT_free(matrix->aggregates);
+    matrix->edges = STACKINT_free(matrix->edges);
+    matrix->offsets = STACKINT_free(matrix->offsets);
+    pthread_mutex_destroy(&matrix->lock);
+    if(matrix->columnIndexes){
+        int count;
+        for(count=0; count < matrix->columns; count++)
+            COLUMNINDEX_free(matrix->columnIndexes[count]);
+        free(matrix->columnIndexes);
+    }
+    matrix->ranges = RANGEINDEX_free(matrix->ranges);
+    matrix->strings = STRINGPOOL_free(matrix->strings);
     free(matrix);
     matrix = NULL;
 
@@ -1207,26 +2433,163 @@ int MATRIX_getColumns(Matrix** matrix){
 }
 
 /**
- * Obtém expressão de uma célula específica da matriz
+ * Define a quantidade de threads usadas para recalcular as células. Com mais de
+ * uma thread, recálculos com ao menos PARALLEL_MIN_CONE células são divididos
+ * entre elas, com os mesmos resultados do recálculo sequencial
+ * \return 1 em caso de sucesso, 0 em caso de erro ou de falha ao criar as threads
+ * (a matriz continua com as threads anteriores)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param threads Quantidade de threads (1 para recalcular sem threads, ou 0
+ * para uma thread por processador disponível)
+ */
+int MATRIX_setThreads(Matrix** matrix, int threads){
+    if(!matrix || !(*matrix) || threads < 0) return 0;
+
+    if(threads == 0)
+        threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if(threads < 1)
+        threads = 1;
+
+    if(threads == MATRIX_getThreads(&(*matrix))) return 1;
+
+    ThreadPool* threadPool = NULL;
+    if(threads > 1 && !(threadPool = THREADPOOL_create(threads))) return 0;
+
+    THREADPOOL_free((*matrix)->threadPool);
+    (*matrix)->threadPool = threadPool;
+
+    return 1;
+}
+
+/**
+ * Obtém a quantidade de threads usadas para recalcular as células
+ * \return Quantidade de threads, ou -1 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_getThreads(Matrix** matrix){
+    if(!matrix || !(*matrix)) return -1;
+
+    if(!(*matrix)->threadPool) return 1;
+
+    return THREADPOOL_getThreads(&(*matrix)->threadPool);
+}
+
+/**
+ * Liga ou desliga o modo preguiçoso. Nele, alterar uma expressão apenas marca
+ * as células que dependem dela; cada célula marcada é calculada quando o seu
+ * valor é lido (MATRIX_getValue) ou quando aparece no gráfico. Ao desligar o
+ * modo, todas as células marcadas são calculadas (a não ser no modo manual)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param lazy Se verdadeiro, liga o modo preguiçoso
+ * \param graphic Ponteiro duplo para GraphicCells (usado ao desligar o modo)
+ */
+int MATRIX_setLazy(Matrix** matrix, int lazy, GraphicCells** graphic){
+    if(!matrix || !(*matrix)) return 0;
+
+    (*matrix)->lazy = lazy;
+    if(!lazy && !(*matrix)->manual)
+        MATRIX_flushDirty(&(*matrix), &(*graphic));
+
+    return 1;
+}
+
+/**
+ * Liga ou desliga o modo de cálculo manual. Nele, alterar uma expressão apenas
+ * guarda a expressão e marca as células que dependem dela, que são mostradas
+ * como desatualizadas e mantêm o valor anterior (inclusive em MATRIX_getValue)
+ * até MATRIX_recalculateAll. Ao desligar o modo, as células marcadas são
+ * calculadas (no modo preguiçoso, apenas as que aparecem no gráfico)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param manual Se verdadeiro, liga o modo manual
+ * \param graphic Ponteiro duplo para GraphicCells (usado ao desligar o modo)
+ */
+int MATRIX_setManual(Matrix** matrix, int manual, GraphicCells** graphic){
+    if(!matrix || !(*matrix)) return 0;
+
+    (*matrix)->manual = manual;
+    if(manual) return 1;
+
+    if(!(*matrix)->lazy)
+        MATRIX_flushDirty(&(*matrix), &(*graphic));
+    else if(graphic && (*graphic))
+        MATRIX_drawVisible(&(*matrix), &(*graphic));
+
+    return 1;
+}
+
+/**
+ * Verifica se o modo de cálculo manual está ligado
+ * \return 1 em caso positivo, 0 em caso negativo (ou em caso de erro)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_isManual(Matrix** matrix){
+    if(!matrix || !(*matrix)) return 0;
+
+    return (*matrix)->manual;
+}
+
+/**
+ * Obtém a quantidade de células com valor desatualizado (marcadas nos modos
+ * preguiçoso e manual)
+ * \return Quantidade de células, ou 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_getStaleCells(Matrix** matrix){
+    if(!matrix || !(*matrix)) return 0;
+
+    return (*matrix)->dirtyCells;
+}
+
+/**
+ * Calcula de uma só vez todas as células com valor desatualizado, em ordem
+ * topológica e cada uma uma única vez (recálculos grandes são divididos entre
+ * as threads da matriz)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_recalculateAll(Matrix** matrix, GraphicCells** graphic){
+    if(!matrix || !(*matrix)) return 0;
+
+    MATRIX_flushDirty(&(*matrix), &(*graphic));
+
+    return 1;
+}
+
+/**
+ * Obtém expressão de uma célula específica da matriz, sem copiá-la. O texto
+ * deixa de ser válido quando a expressão da célula é alterada
+ * \return Expressão da célula. Se a célula não estiver alocada ou não houver
+ * expressão, retorna uma string vazia ("")
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param row Linha da célula
  * \param column  Coluna da célula
- * \param expression String a ser preenchida com a expressão da célula.
- * Se a célula não estiver alocada ou não houver expressão, essa variável
- * é preenchida com uma string vazia ("")
  */
-void MATRIX_getExpression(Matrix** matrix, int row, int column, char *expression){
-    if(!matrix || !(*matrix)){
-        strcpy(expression,"");
-        return;
-    }
+const char* MATRIX_getExpression(Matrix** matrix, int row, int column){
+    if(!matrix || !(*matrix) || !MATRIX_validCell(&(*matrix), row, column))
+        return "";
 
-    int cellIndex = MATRIX_evalCellIndex(row, column, (*matrix)->columns);
+    Cell* cell = MATRIX_getCell(&(*matrix),
+            MATRIX_evalCellIndex(row, column, (*matrix)->columns));
 
-    if((*matrix)->graph.cells[cellIndex])
-        strcpy(expression, (*matrix)->graph.cells[cellIndex]->expression);
-    else
-        strcpy(expression, "");
+    if(!cell)
+        return "";
+
+    return STRINGPOOL_get(&(*matrix)->strings, cell->expression);
+}
+
+/**
+ * Obtém o conjunto de textos das expressões da matriz, usado para criar a fila
+ * de desfazer/refazer
+ * \return Ponteiro para o conjunto de textos
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+StringPool* MATRIX_getStrings(Matrix** matrix){
+    if(!matrix || !(*matrix)) return NULL;
+
+    return (*matrix)->strings;
 }
 
 /**
@@ -1237,14 +2600,41 @@ void MATRIX_getExpression(Matrix** matrix, int row, int column, char *expression
  * \param column Coluna da célula
  */
 double MATRIX_getValue(Matrix** matrix, int row, int column){
-    if(!matrix || !(*matrix)) return 0;
+    if(!matrix || !(*matrix) || !MATRIX_validCell(&(*matrix), row, column)) return 0;
 
     int cellIndex = MATRIX_evalCellIndex(row, column, (*matrix)->columns);
 
-    if((*matrix)->graph.cells[cellIndex])
-        return (*matrix)->graph.cells[cellIndex]->value;
-    else
-        return 0;
+    // no modo preguiçoso, calcula a célula (e os precedentes necessários) se
+    // marcada; no modo manual, mantém o valor anterior
+    if((*matrix)->dirtyCells && !(*matrix)->manual)
+        MATRIX_pullValue(&(*matrix), cellIndex);
+
+    return MATRIX_readValue(*matrix, cellIndex);
+}
+
+/**
+ * Avança para a próxima célula alocada da matriz, na ordem das linhas e colunas.
+ * Percorre apenas os blocos de células alocados
+ * \return 1 se encontrou uma célula, 0 se não houver mais células
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param row Linha da célula atual (informe 0 para começar do início). É
+ * preenchida com a linha da próxima célula
+ * \param column Coluna da célula atual (informe 0 para começar do início). É
+ * preenchida com a coluna da próxima célula
+ */
+int MATRIX_nextCell(Matrix** matrix, int* row, int* column){
+    if(!matrix || !(*matrix)) return 0;
+
+    int cellIndex = -1;
+    if((*row) >= 1)
+        cellIndex = MATRIX_evalCellIndex((*row), (*column), (*matrix)->columns);
+
+    cellIndex = MATRIX_nextCellIndex(&(*matrix), cellIndex);
+    if(cellIndex == -1) return 0;
+
+    (*row) = MATRIX_getRow(cellIndex, (*matrix)->columns);
+    (*column) = MATRIX_getColumn(cellIndex, (*matrix)->columns);
+    return 1;
 }
 
 /**
@@ -1260,72 +2650,82 @@ double MATRIX_getValue(Matrix** matrix, int row, int column){
  */
 int MATRIX_setExpression(Matrix** matrix, int row, int column, const char* expression,
         UndoRedoCells** undoRedo, GraphicCells** graphic){
-    if(!matrix || !(*matrix)) return 0;
-
-    int cellIndex = MATRIX_evalCellIndex(row, column, (*matrix)->columns);
-
-    // ponteiro para a célula de interesse
-    Cell* cell;
-    if((*matrix)->graph.cells[cellIndex])
-        cell = (*matrix)->graph.cells[cellIndex];
-    else{
-        cell = malloc(sizeof(Cell));
-        if(!cell) return 0;
+    if(!matrix || !(*matrix) || !MATRIX_validCell(&(*matrix), row, column)) return 0;
 
-        cell->first = NULL;
-        strcpy(cell->expression, "");
+    // a alteração e os valores que ela mudar ficam juntos na fila
+    MATRIX_beginCapture(&(*matrix), &(*undoRedo));
 
-        (*matrix)->graph.cells[cellIndex] = cell;
+    if(!MATRIX_installExpression(&(*matrix), row, column, expression, &(*undoRedo),
+            &(*graphic))){
+        MATRIX_endCapture(&(*matrix), &(*undoRedo));
+        return 0;
     }
 
-    char oldExpression[60];
+    int cellIndex = MATRIX_evalCellIndex(row, column, (*matrix)->columns);
 
-    // guarda expressão atual (que será anterior) da célula
-    strcpy(oldExpression, cell->expression);
+    // nos modos preguiçoso e manual, apenas marca as células que dependem desta
+    // computa o valor da célula e de todas as células que dependem dela
+    // necessário mesmo quando célula não contém expressão, pois o valor precisa,
+    // neste caso, ser atualizado para 0
+    if((*matrix)->lazy || (*matrix)->manual)
+        MATRIX_invalidate(&(*matrix), cellIndex, &(*graphic));
+    else
+        MATRIX_recalculate(&(*matrix), cellIndex, &(*graphic));
 
-    // retira dependências em relação à célula atual, com base na antiga expressão
-    MATRIX_modDependencies(&(*matrix), cellIndex, oldExpression, true);
+    MATRIX_endCapture(&(*matrix), &(*undoRedo));
 
-    // adiciona dependências em relação à célula atual, com base na nova expressão
-    MATRIX_modDependencies(&(*matrix), cellIndex, expression, false);
+    return 1;
+}
 
-    // se undoRedo não nulo, adiciona na fila de desfazer/refazer
-    if(undoRedo && (*undoRedo)){
-        UNDOREDOCELLS_newItem(&(*undoRedo), oldExpression, expression, cellIndex);
-    }
+/**
+ * Define as expressões de várias células de uma só vez, como ao carregar um
+ * espaço de trabalho ou colar um bloco de células. Todas as expressões são
+ * colocadas antes de qualquer cálculo, e as células alteradas e as que dependem
+ * delas são calculadas uma única vez cada, em uma só passagem em ordem
+ * topológica (nos modos preguiçoso e manual, apenas marcadas)
+ * \return Quantidade de expressões definidas (células inválidas e falhas de
+ * alocação são ignoradas)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param size Quantidade de expressões
+ * \param rows Linha de cada célula
+ * \param columns Coluna de cada célula
+ * \param expressions Expressão de cada célula
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer, na qual as
+ * alterações são guardadas como um único grupo. Informe NULL caso não queira
+ * guardar a informação na fila de desfazer/refazer
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_setExpressions(Matrix** matrix, int size, const int* rows, const int* columns,
+        const char* const* expressions, UndoRedoCells** undoRedo, GraphicCells** graphic){
+    if(!matrix || !(*matrix) || size < 0 || (size && (!rows || !columns || !expressions)))
+        return 0;
 
-    // guarda nova expressão
-    strcpy((*matrix)->graph.cells[cellIndex]->expression, expression);
+    StackInt** batch = &(*matrix)->batch;
+    int count, amount = 0;
 
-    // se a célula possui expressão vazia e nenhuma outra depende dela,
-    // desaloca e sai
-    if(strcmp((*matrix)->graph.cells[cellIndex]->expression, "")==0
-            && !(*matrix)->graph.cells[cellIndex]->first){
-        free((*matrix)->graph.cells[cellIndex]);
-        (*matrix)->graph.cells[cellIndex] = NULL;
-        if(graphic)
-            GRAPHICSCELLS_updateCell(&(*graphic), row, column, 0, KEEP_MARK, true);
-        return 1;
-    }
+    STACKINT_clear(&(*batch));
+    MATRIX_beginCapture(&(*matrix), &(*undoRedo));
 
-    // computa o valor da célula
-    // necessário mesmo quando célula não contém expressão, pois o valor precisa,
-    // neste caso, ser atualizado para 0
-    MATRIX_evalCellValue(&(*matrix), cellIndex, &(*graphic));
+    for(count=0; count < size; count++){
+        if(!MATRIX_validCell(&(*matrix), rows[count], columns[count])) continue;
+
+        if(MATRIX_installExpression(&(*matrix), rows[count], columns[count],
+                expressions[count], &(*undoRedo), &(*graphic)))
+            amount++;
 
-    // se a célula não contém expressão, então é célula vazia
-    if(strcmp((*matrix)->graph.cells[cellIndex]->expression, "")==0
-            && graphic)
-        GRAPHICSCELLS_updateCell(&(*graphic), row, column, 0, KEEP_MARK, true);
+        STACKINT_push(&(*batch), MATRIX_evalCellIndex(rows[count], columns[count],
+                (*matrix)->columns));
+    }
 
-    // percorre todas as dependências para atualizar todas as células que dependem desta
-    MATRIX_evalCellDepsValue(&(*matrix), cellIndex, cellIndex, &(*graphic));
+    MATRIX_recalculateCells(&(*matrix), &(*batch), &(*graphic));
+    MATRIX_endCapture(&(*matrix), &(*undoRedo));
 
-    return 1;
+    return amount;
 }
 
 /**
- * Tenta realizar operação de desfazer na matriz de células
+ * Tenta realizar operação de desfazer na matriz de células. Um grupo de
+ * alterações (como as de MATRIX_setExpressions) é desfeito de uma só vez
  * \return 1 se obtiver sucesso e 0 em caso contrário
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param undoRedo Ponteiro duplo para fila de desfazer/refazer
@@ -1336,25 +2736,12 @@ int MATRIX_undo(Matrix** matrix, UndoRedoCells** undoRedo, GraphicCells** graphi
 
     if(!UNDOREDOCELLS_canUndo(&(*undoRedo))) return 0;
 
-    // variáveis a serem obtidas da fila undoRedo
-    char expression[60];
-    int cellIndex;
-
-    if(!UNDOREDOCELLS_undo(&(*undoRedo), expression, &cellIndex)) return 0;
-
-    // obtém linha e coluna correspondentes
-    int row = MATRIX_getRow(cellIndex, (*matrix)->columns);
-    int column = MATRIX_getColumn(cellIndex, (*matrix)->columns);
-
-    // preenche expressão da célula correta, sem colocar na pilha novamente
-    if(!MATRIX_setExpression(&(*matrix), row, column, expression, NULL, &(*graphic)))
-        return 0;
-
-    return 1;
+    return MATRIX_replay(&(*matrix), &(*undoRedo), false, &(*graphic));
 }
 
 /**
- * Tenta realizar operação de refazer na matriz de células
+ * Tenta realizar operação de refazer na matriz de células. Um grupo de
+ * alterações (como as de MATRIX_setExpressions) é refeito de uma só vez
  * \return 1 se obtiver sucesso e 0 em caso contrário
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param undoRedo Ponteiro duplo para fila de desfazer/refazer
@@ -1365,20 +2752,7 @@ int MATRIX_redo(Matrix** matrix, UndoRedoCells** undoRedo, GraphicCells** graphi
 
     if(!UNDOREDOCELLS_canRedo(&(*undoRedo))) return 0;
 
-    // variáveis a serem obtidas da fila undoRedo
-    char expression[60];
-    int cellIndex;
-
-    if(!UNDOREDOCELLS_redo(&(*undoRedo), expression, &cellIndex)) return 0;
-
-    // obtém linha e coluna correspondentes
-    int row = MATRIX_getRow(cellIndex, (*matrix)->columns);
-    int column = MATRIX_getColumn(cellIndex, (*matrix)->columns);
-
-    // preenche expressão da célula correta, sem colocar na pilha novamente
-    if(!MATRIX_setExpression(&(*matrix), row, column, expression, NULL, &(*graphic))) return 0;
-
-    return 1;
+    return MATRIX_replay(&(*matrix), &(*undoRedo), true, &(*graphic));
 }
 
 /**
@@ -1402,13 +2776,8 @@ int MATRIX_validateExpression(GraphicInstructions** graphic, int rows, int colum
     // guarda mensagem de erro a ser informada para o usuário
     char message[100];
 
-    // maior caractere maiúsculo e minúsculo possível para a coluna
-    int charLimitCap, charLimit;
-    charLimitCap = columns + MIN_ASCII_CAP_LETTER - 1;
-    charLimit = columns + MIN_ASCII_LETTER - 1;
-
-    // maior número para a linha
-    int intLimit = rows + MIN_ASCII_NUMBER;
+    // linha e coluna de uma referência
+    int row, column;
 
     // guarda a quantidade de elementos da pilha (cada número, referência
     // ou função aumenta a pilha em um; cada operação pega dois elementos
@@ -1425,14 +2794,14 @@ int MATRIX_validateExpression(GraphicInstructions** graphic, int rows, int colum
         }
 
         // operador
-        if(MATRIX_charIsOperator(expression[count])){
+        if(REFERENCE_charIsOperator(expression[count])){
             // a pilha diminui em um
             stack--;
             count++;
         }
 
         // número
-        else if(MATRIX_charIsNumber(expression[count])){
+        else if(REFERENCE_charIsNumber(expression[count])){
             // a pilha aumenta em um
             stack++;
 
@@ -1442,27 +2811,26 @@ int MATRIX_validateExpression(GraphicInstructions** graphic, int rows, int colum
         }
 
         // referência de célula
-        else if(MATRIX_charIsAlpha(expression[count]) && expression[count+1]!=0
-                && MATRIX_charIsNumber(expression[count+1])){
+        else if(REFERENCE_read(expression + count, &row, &column)){
 
             // a pilha aumenta em um
             stack++;
 
             // checa referência
-            if(!MATRIX_VAL_checkReference(expression, &count, charLimitCap, charLimit,
-                    intLimit, &(*graphic))) return 0;
+            if(!MATRIX_VAL_checkReference(expression, &count, rows, columns,
+                    &(*graphic))) return 0;
         }
 
         // função
-        else if(MATRIX_charIsAlpha(expression[count]) && expression[count+1]!=0
-                && MATRIX_charIsAlpha(expression[count+1])){
+        else if(REFERENCE_charIsAlpha(expression[count]) && expression[count+1]!=0
+                && REFERENCE_charIsAlpha(expression[count+1])){
 
             // a pilha aumenta em um
             stack++;
 
             // verifica se a função é válida
-            if(!MATRIX_VAL_checkFunction(expression,&count, charLimitCap,charLimit,
-                    intLimit, &(*graphic))) return 0;
+            if(!MATRIX_VAL_checkFunction(expression,&count, rows, columns,
+                    &(*graphic))) return 0;
         }
 
         // caractere inválido
@@ -1509,122 +2877,16 @@ int MATRIX_checkCyclicDependency(int row, int column, const char* expression, Ma
     // calcula o índice da célula atual
     int cellIndex = MATRIX_evalCellIndex(row,column, (*matrix)->columns);
 
-    // Ponteiro usado para realizar iterações nas dependências da célula
-    Dependency* cellDependency = NULL;
-
-    // variáveis para computar intervalos
-    // primeira célula e última célula
-    int firstCell, lastCell;
-    // guarda primeira e última linha, primeira e última coluna
-    int firstRow, lastRow, firstColumn, lastColumn;
-    // percorre linha e coluna
-    int countRow, countColumn;
-    // flag que indica qual a célula já computada anteriormente
-    int computeFirstCell;
-
-    int count=0, cellDestiny;
-    // percorre a expressão
-    while(expression[count]!=0){
-
-        // se encontrou dois pontos, então computa intervalo
-        if(expression[count]==':'){
-            // pula os dois pontos
-            count++;
-            // pula espaços em branco
-            while(expression[count]==' ')
-                count++;
-
-            // pega segunda referência
-            cellDestiny = MATRIX_getCellIndex_fromReference(expression, &count,
-                    (*matrix)->columns);
-
-            // verifica qual a referência maior e configura lastCell e firstCell de acordo
-            if(firstCell > cellDestiny){
-                lastCell = firstCell;
-                firstCell = cellDestiny;
-                computeFirstCell = true;
-            }else{
-                lastCell = cellDestiny;
-                computeFirstCell=false;
-            }
-
-            // configura variáveis de intervalo
-            firstRow = MATRIX_getRow(firstCell,(*matrix)->columns);
-            lastRow = MATRIX_getRow(lastCell,(*matrix)->columns);
-            firstColumn = MATRIX_getColumn(firstCell, (*matrix)->columns);
-            lastColumn = MATRIX_getColumn(lastCell, (*matrix)->columns);
-
-            // percorre intervalo de células
-            for(countRow = firstRow; countRow<=lastRow; countRow++){
-                for(countColumn = firstColumn; countColumn <= lastColumn; countColumn++){
-                    // não computa primeira ou última célula
-                    if((!computeFirstCell && (countColumn!=firstColumn || countRow!=firstRow))
-                        || (computeFirstCell
-                            && ( countColumn!=lastColumn || countRow!=lastRow ))){
-                        // pega índice da célula
-                        cellDestiny = MATRIX_evalCellIndex(countRow, countColumn,
-                                (*matrix)->columns);
-
-                        // se a célula destino for a própria célula, erro
-                        if(cellIndex == cellDestiny)
-                            return 1;
-
-                        // percorre dependências da célula
-                        if((*matrix)->graph.cells[cellIndex]){
-                            cellDependency = (*matrix)->graph.cells[cellIndex]->first;
-                            while(cellDependency){
-                                // se a dependência atual bate com o índice da célula atual, erro
-                                if(cellDependency->value == cellDestiny)
-                                    return 1;
-
-                                // chama função recursiva para checar na célula dependente
-                                if(MATRIX_checkCyclicDependencyRecursive(cellDependency->value,
-                                        cellDestiny, &(*matrix))) return 1;
-
-                                cellDependency = cellDependency->next;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // faz comparações com base na table ascii
-        // um caractere não-número seguido de um número?
-        else if(MATRIX_charIsAlpha(expression[count])
-                && expression[count+1]!=0 && MATRIX_charIsNumber(expression[count+1])){
-
-            // pega índice da célula no grafo
-            cellDestiny = MATRIX_getCellIndex_fromReference(expression, &count,
-                    (*matrix)->columns);
+    // um número não possui dependências
+    double literal;
+    if(PROGRAM_readLiteral(expression, &literal)) return 0;
 
-            // se a célula destino for a própria célula, erro
-            if(cellIndex == cellDestiny)
-                return 1;
+    // compila a expressão para obter suas dependências
+    Program* program = PROGRAM_compile(expression, (*matrix)->columns);
+    if(!program) return 0;
 
-            // percorre dependências da célula
-            if((*matrix)->graph.cells[cellIndex]){
-                cellDependency = (*matrix)->graph.cells[cellIndex]->first;
-                while(cellDependency){
-                    // se a dependência atual bate com o índice da célula atual, erro
-                    if(cellDependency->value == cellDestiny)
-                        return 1;
+    int result = MATRIX_findCycle(&(*matrix), cellIndex, &program);
 
-                    // chama função recursiva para checar na célula dependente
-                    if(MATRIX_checkCyclicDependencyRecursive(cellDependency->value,
-                            cellDestiny, &(*matrix))) return 1;
-
-                    cellDependency = cellDependency->next;
-                }
-            }
-
-            // presume que essa referência é a primeira de um intervalo
-            firstCell = cellDestiny;
-        }
-        // pula um caractere
-        count++;
-    }
-
-    // tudo ok
-    return 0;
+    program = PROGRAM_free(program);
+    return result;
 }
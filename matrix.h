@@ -10,10 +10,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "binary_expression_tree.h"
 #include "stack_binExpTree.h"
 #include "functions.h"
+#include "program.h"
+#include "stack_int.h"
+#include "range_index.h"
+#include "column_index.h"
+#include "thread_pool.h"
+#include "dependents.h"
+#include "pool.h"
+#include "string_pool.h"
 #include "undo_redo_cells.h"
 #include "graphics_cells.h"
 #include "graphics_instructions.h"
@@ -28,21 +39,34 @@
  */
 #define COLUMNS 13
 
+/**
+ * Define a quantidade máxima de linhas de uma matriz
+ */
+#define MATRIX_MAX_ROWS 1048576
+
+/**
+ * Define a quantidade máxima de colunas de uma matriz
+ */
+#define MATRIX_MAX_COLUMNS 1024
+
 /**
  * Estrutura da matriz de células da planilha
  */
 typedef struct matrix Matrix;
 
 /**
- * Cria uma matriz com a quantidade de linhas e colunas especificadas
- * \return Ponteiro para a matriz criada
+ * Cria uma matriz com a quantidade de linhas e colunas especificadas. As células
+ * só ocupam memória quando recebem uma expressão ou são referenciadas
+ * \return Ponteiro para a matriz criada, ou NULL se as dimensões forem inválidas
+ * (limitadas por MATRIX_MAX_ROWS e MATRIX_MAX_COLUMNS) ou em caso de falha de alocação
  * \param rows Quantidade de linhas da matriz
  * \param columns Quantidade de colunas da matriz
  */
 Matrix* MATRIX_create(int rows, int columns);
 
 /**
- * Libera memória alocada na matriz
+ * Libera memória alocada na matriz. Filas de desfazer/refazer criadas com o
+ * conjunto de textos da matriz (MATRIX_getStrings) devem ser liberadas antes
  * \return NULL
  * \param matrix Ponteiro para matriz Matrix
  */
@@ -63,18 +87,98 @@ int MATRIX_getRows(Matrix** matrix);
 int MATRIX_getColumns(Matrix** matrix);
 
 /**
- * Obtém expressão de uma célula específica da matriz
+ * Define a quantidade de threads usadas para recalcular as células. Com mais de
+ * uma thread, recálculos grandes são divididos entre elas, com os mesmos
+ * resultados do recálculo sequencial. A matriz é criada sem threads, e a
+ * planilha não as usa enquanto make bench (bench_recalc) não mostrar ganho em
+ * um processador com vários núcleos
+ * \return 1 em caso de sucesso, 0 em caso de erro ou de falha ao criar as threads
+ * (a matriz continua com as threads anteriores)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param threads Quantidade de threads (1 para recalcular sem threads, ou 0
+ * para uma thread por processador disponível)
+ */
+int MATRIX_setThreads(Matrix** matrix, int threads);
+
+/**
+ * Obtém a quantidade de threads usadas para recalcular as células
+ * \return Quantidade de threads, ou -1 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_getThreads(Matrix** matrix);
+
+/**
+ * Liga ou desliga o modo preguiçoso. Nele, alterar uma expressão apenas marca
+ * as células que dependem dela; cada célula marcada é calculada quando o seu
+ * valor é lido (MATRIX_getValue) ou quando aparece no gráfico. Ao desligar o
+ * modo, todas as células marcadas são calculadas (a não ser no modo manual)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param lazy Se verdadeiro, liga o modo preguiçoso
+ * \param graphic Ponteiro duplo para GraphicCells (usado ao desligar o modo)
+ */
+int MATRIX_setLazy(Matrix** matrix, int lazy, GraphicCells** graphic);
+
+/**
+ * Liga ou desliga o modo de cálculo manual. Nele, alterar uma expressão apenas
+ * guarda a expressão e marca as células que dependem dela, que são mostradas
+ * como desatualizadas e mantêm o valor anterior (inclusive em MATRIX_getValue)
+ * até MATRIX_recalculateAll. Ao desligar o modo, as células marcadas são
+ * calculadas (no modo preguiçoso, apenas as que aparecem no gráfico)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param manual Se verdadeiro, liga o modo manual
+ * \param graphic Ponteiro duplo para GraphicCells (usado ao desligar o modo)
+ */
+int MATRIX_setManual(Matrix** matrix, int manual, GraphicCells** graphic);
+
+/**
+ * Verifica se o modo de cálculo manual está ligado
+ * \return 1 em caso positivo, 0 em caso negativo (ou em caso de erro)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_isManual(Matrix** matrix);
+
+/**
+ * Obtém a quantidade de células com valor desatualizado (marcadas nos modos
+ * preguiçoso e manual)
+ * \return Quantidade de células, ou 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+int MATRIX_getStaleCells(Matrix** matrix);
+
+/**
+ * Calcula de uma só vez todas as células com valor desatualizado, em ordem
+ * topológica e cada uma uma única vez (recálculos grandes são divididos entre
+ * as threads da matriz)
+ * \return 1 em caso de sucesso, 0 em caso de erro
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_recalculateAll(Matrix** matrix, GraphicCells** graphic);
+
+/**
+ * Obtém expressão de uma célula específica da matriz, sem copiá-la. O texto
+ * deixa de ser válido quando a expressão da célula é alterada
+ * \return Expressão da célula. Se a célula não estiver alocada ou não houver
+ * expressão, retorna uma string vazia ("")
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param row Linha da célula
  * \param column  Coluna da célula
- * \param expression String a ser preenchida com a expressão da célula.
- * Se a célula não estiver alocada ou não houver expressão, essa variável
- * é preenchida com uma string vazia ("")
  */
-void MATRIX_getExpression(Matrix** matrix, int row, int column, char *expression);
+const char* MATRIX_getExpression(Matrix** matrix, int row, int column);
+
+/**
+ * Obtém o conjunto de textos das expressões da matriz, usado para criar a fila
+ * de desfazer/refazer
+ * \return Ponteiro para o conjunto de textos
+ * \param matrix Ponteiro duplo para matriz Matrix
+ */
+StringPool* MATRIX_getStrings(Matrix** matrix);
 
 /**
- * Obtém valor da célula
+ * Obtém valor da célula. No modo preguiçoso, calcula antes a célula se ela
+ * estiver marcada (no modo manual, retorna o valor anterior)
  * \return Valor da célula
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param row Linha da célula
@@ -82,6 +186,18 @@ void MATRIX_getExpression(Matrix** matrix, int row, int column, char *expression
  */
 double MATRIX_getValue(Matrix** matrix, int row, int column);
 
+/**
+ * Avança para a próxima célula alocada da matriz, na ordem das linhas e colunas.
+ * Percorre apenas os blocos de células alocados
+ * \return 1 se encontrou uma célula, 0 se não houver mais células
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param row Linha da célula atual (informe 0 para começar do início). É
+ * preenchida com a linha da próxima célula
+ * \param column Coluna da célula atual (informe 0 para começar do início). É
+ * preenchida com a coluna da próxima célula
+ */
+int MATRIX_nextCell(Matrix** matrix, int* row, int* column);
+
 /**
  * Define uma expressão para uma célula específica, calculando o seu valor no processo
  * \return 1 se obtiver sucesso, e 0 caso contrário
@@ -97,7 +213,31 @@ int MATRIX_setExpression(Matrix** matrix, int row, int column, const char* expre
         UndoRedoCells** undoRedo, GraphicCells** graphic);
 
 /**
- * Tenta realizar operação de desfazer na matriz de células
+ * Define as expressões de várias células de uma só vez, como ao carregar um
+ * espaço de trabalho ou colar um bloco de células. Todas as expressões são
+ * colocadas antes de qualquer cálculo, e as células alteradas e as que dependem
+ * delas são calculadas uma única vez cada, em uma só passagem em ordem
+ * topológica (nos modos preguiçoso e manual, apenas marcadas)
+ * \return Quantidade de expressões definidas (células inválidas e falhas de
+ * alocação são ignoradas)
+ * \param matrix Ponteiro duplo para matriz Matrix
+ * \param size Quantidade de expressões
+ * \param rows Linha de cada célula
+ * \param columns Coluna de cada célula
+ * \param expressions Expressão de cada célula
+ * \param undoRedo Ponteiro duplo para fila de desfazer/refazer, na qual as
+ * alterações são guardadas como um único grupo. Informe NULL caso não queira
+ * guardar a informação na fila de desfazer/refazer
+ * \param graphic Ponteiro duplo para GraphicCells
+ */
+int MATRIX_setExpressions(Matrix** matrix, int size, const int* rows, const int* columns,
+        const char* const* expressions, UndoRedoCells** undoRedo, GraphicCells** graphic);
+
+/**
+ * Tenta realizar operação de desfazer na matriz de células. Um grupo de
+ * alterações (como as de MATRIX_setExpressions) é desfeito de uma só vez
+ * e, se os valores das células alteradas foram guardados junto a ele, eles
+ * são colocados de volta sem calcular nenhuma célula
  * \return 1 se obtiver sucesso e 0 em caso contrário
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param undoRedo Ponteiro duplo para fila de desfazer/refazer
@@ -106,7 +246,10 @@ int MATRIX_setExpression(Matrix** matrix, int row, int column, const char* expre
 int MATRIX_undo(Matrix** matrix, UndoRedoCells** undoRedo, GraphicCells** graphic);
 
 /**
- * Tenta realizar operação de refazer na matriz de células
+ * Tenta realizar operação de refazer na matriz de células. Um grupo de
+ * alterações (como as de MATRIX_setExpressions) é refeito de uma só vez
+ * e, se os valores das células alteradas foram guardados junto a ele, eles
+ * são colocados de volta sem calcular nenhuma célula
  * \return 1 se obtiver sucesso e 0 em caso contrário
  * \param matrix Ponteiro duplo para matriz Matrix
  * \param undoRedo Ponteiro duplo para fila de desfazer/refazer
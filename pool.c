@@ -0,0 +1,246 @@
+/**
+ * \file pool.c
+ * Implementação do arquivo pool.h
+ */
+
+#include "pool.h"
+
+// alinhamento da memória entregue pela arena
+#define ALIGNMENT 16
+
+// tamanho da linha de cache (alinhamento dos blocos e dos objetos grandes do pool)
+#define CACHE_LINE 64
+
+// arredonda um tamanho para o próximo múltiplo de um alinhamento (potência de 2)
+#define ALIGN_TO(size, alignment) (((size) + (alignment)-1) & ~((size_t) (alignment)-1))
+
+// arredonda um tamanho para o próximo múltiplo do alinhamento
+#define ALIGN(size) ALIGN_TO(size, ALIGNMENT)
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura de um bloco pedido ao sistema pela arena
+ */
+typedef struct block Block;
+struct block{
+    Block* next; ///< bloco anterior (a arena guarda os blocos em pilha)
+    size_t size; ///< tamanho útil do bloco
+    size_t used; ///< bytes já entregues
+};
+
+/**
+ * Estrutura da arena
+ */
+struct arena{
+    Block* first; ///< bloco atual
+    size_t blockSize;
+};
+
+/**
+ * Estrutura de um objeto livre no pool (ocupa o espaço do próprio objeto)
+ */
+typedef struct freeObject FreeObject;
+struct freeObject{
+    FreeObject* next;
+};
+
+/**
+ * Estrutura do pool de objetos de tamanho fixo
+ */
+struct pool{
+    Arena* arena;
+    size_t objectSize;
+    int objectsPerSlab;
+
+    FreeObject* free; ///< objetos devolvidos
+    char* slab; ///< próximo objeto ainda não entregue do grupo atual
+    int remaining; ///< objetos ainda não entregues do grupo atual
+};
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Obtém o início da área útil de um bloco
+ * \return Ponteiro para o primeiro byte útil (alinhado à linha de cache)
+ * \param block Ponteiro para o bloco
+ */
+char* ARENA_getData(Block* block){
+    return (char*) block + ALIGN_TO(sizeof(Block), CACHE_LINE);
+}
+
+/**
+ * Reserva memória na arena com o alinhamento informado
+ * \return Ponteiro para a memória reservada, ou NULL em caso de falha de alocação
+ * \param arena Ponteiro duplo para Arena
+ * \param size Tamanho, em bytes, da memória
+ * \param alignment Alinhamento da memória (potência de 2, no máximo CACHE_LINE)
+ */
+void* ARENA_allocAligned(Arena** arena, size_t size, size_t alignment){
+    if(!arena || !(*arena)) return NULL;
+
+    size = ALIGN(size);
+    Block* block = (*arena)->first;
+    size_t start = block ? ALIGN_TO(block->used, alignment) : 0;
+
+    // pede um novo bloco se o atual não tiver espaço
+    if(!block || start > block->size || block->size - start < size){
+        size_t blockSize = size > (*arena)->blockSize ? size : (*arena)->blockSize;
+
+        // blocos alinhados à linha de cache (aligned_alloc exige tamanho múltiplo)
+        block = aligned_alloc(CACHE_LINE,
+                ALIGN_TO(ALIGN_TO(sizeof(Block), CACHE_LINE) + blockSize, CACHE_LINE));
+        if(!block) return NULL;
+
+        block->size = blockSize;
+        block->used = 0;
+        block->next = (*arena)->first;
+        (*arena)->first = block;
+        start = 0;
+    }
+
+    block->used = start + size;
+
+    return ARENA_getData(block) + start;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Aloca arena vazia
+ * \return Ponteiro para Arena, ou NULL em caso de falha de alocação
+ * \param blockSize Tamanho, em bytes, de cada bloco pedido ao sistema
+ */
+Arena* ARENA_create(size_t blockSize){
+    Arena* arena = malloc(sizeof(Arena));
+    if(!arena) return NULL;
+
+    arena->first = NULL;
+    arena->blockSize = ALIGN(blockSize);
+
+    return arena;
+}
+
+/**
+ * Libera a arena e toda a memória entregue por ela
+ * \return NULL
+ * \param arena Ponteiro para Arena
+ */
+Arena* ARENA_free(Arena* arena){
+    if(!arena) return NULL;
+
+    Block* next;
+    while(arena->first){
+        next = arena->first->next;
+        free(arena->first);
+        arena->first = next;
+    }
+
+    free(arena);
+    return NULL;
+}
+
+/**
+ * Reserva memória na arena. A memória só é liberada junto com a arena
+ * \return Ponteiro para a memória reservada (alinhada para qualquer tipo), ou
+ * NULL em caso de falha de alocação
+ * \param arena Ponteiro duplo para Arena
+ * \param size Tamanho, em bytes, da memória
+ */
+void* ARENA_alloc(Arena** arena, size_t size){
+    return ARENA_allocAligned(&(*arena), size, ALIGNMENT);
+}
+
+/**
+ * Aloca pool de objetos de tamanho fixo. Os objetos são reservados na arena
+ * informada, em grupos de objectsPerSlab objetos. Objetos com ao menos 64 bytes
+ * são alinhados à linha de cache
+ * \return Ponteiro para Pool, ou NULL em caso de falha de alocação
+ * \param arena Ponteiro duplo para a Arena que fornece a memória (deve ser
+ * liberada depois do pool)
+ * \param objectSize Tamanho, em bytes, de cada objeto
+ * \param objectsPerSlab Quantidade de objetos reservados de cada vez
+ */
+Pool* POOL_create(Arena** arena, size_t objectSize, int objectsPerSlab){
+    if(!arena || !(*arena) || objectsPerSlab < 1) return NULL;
+
+    Pool* pool = malloc(sizeof(Pool));
+    if(!pool) return NULL;
+
+    // o objeto livre é guardado no espaço do próprio objeto
+    if(objectSize < sizeof(FreeObject))
+        objectSize = sizeof(FreeObject);
+
+    pool->arena = (*arena);
+    // objetos grandes ocupam linhas de cache inteiras
+    pool->objectSize = objectSize >= CACHE_LINE ? ALIGN_TO(objectSize, CACHE_LINE)
+            : ALIGN(objectSize);
+    pool->objectsPerSlab = objectsPerSlab;
+    pool->free = NULL;
+    pool->slab = NULL;
+    pool->remaining = 0;
+
+    return pool;
+}
+
+/**
+ * Libera o pool. A memória dos objetos pertence à arena e é liberada com ela
+ * \return NULL
+ * \param pool Ponteiro para Pool
+ */
+Pool* POOL_free(Pool* pool){
+    free(pool);
+    return NULL;
+}
+
+/**
+ * Obtém um objeto do pool, reaproveitando um objeto devolvido se houver
+ * \return Ponteiro para o objeto, ou NULL em caso de falha de alocação
+ * \param pool Ponteiro duplo para Pool
+ */
+void* POOL_alloc(Pool** pool){
+    if(!pool || !(*pool)) return NULL;
+
+    void* object;
+
+    // reaproveita objeto devolvido
+    if((*pool)->free){
+        object = (*pool)->free;
+        (*pool)->free = (*pool)->free->next;
+        return object;
+    }
+
+    // reserva um novo grupo de objetos na arena
+    if(!(*pool)->remaining){
+        (*pool)->slab = ARENA_allocAligned(&(*pool)->arena,
+                (*pool)->objectSize*(*pool)->objectsPerSlab,
+                (*pool)->objectSize >= CACHE_LINE ? CACHE_LINE : ALIGNMENT);
+        if(!(*pool)->slab) return NULL;
+        (*pool)->remaining = (*pool)->objectsPerSlab;
+    }
+
+    object = (*pool)->slab;
+    (*pool)->slab += (*pool)->objectSize;
+    (*pool)->remaining--;
+
+    return object;
+}
+
+/**
+ * Devolve um objeto para o pool
+ * \param pool Ponteiro duplo para Pool
+ * \param object Ponteiro para o objeto (obtido de POOL_alloc do mesmo pool)
+ */
+void POOL_release(Pool** pool, void* object){
+    if(!pool || !(*pool) || !object) return;
+
+    FreeObject* freeObject = object;
+    freeObject->next = (*pool)->free;
+    (*pool)->free = freeObject;
+}
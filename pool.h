@@ -0,0 +1,80 @@
+/**
+ * \file pool.h
+ * Alocadores de memória em bloco. Arena entrega pedaços de blocos grandes e só
+ * libera tudo de uma vez; Pool entrega objetos de tamanho fixo tirados de uma
+ * arena e reaproveita os objetos devolvidos através de uma lista livre
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Estrutura da arena
+ */
+typedef struct arena Arena;
+
+/**
+ * Estrutura do pool de objetos de tamanho fixo
+ */
+typedef struct pool Pool;
+
+/**
+ * Aloca arena vazia
+ * \return Ponteiro para Arena, ou NULL em caso de falha de alocação
+ * \param blockSize Tamanho, em bytes, de cada bloco pedido ao sistema
+ */
+Arena* ARENA_create(size_t blockSize);
+
+/**
+ * Libera a arena e toda a memória entregue por ela
+ * \return NULL
+ * \param arena Ponteiro para Arena
+ */
+Arena* ARENA_free(Arena* arena);
+
+/**
+ * Reserva memória na arena. A memória só é liberada junto com a arena
+ * \return Ponteiro para a memória reservada (alinhada para qualquer tipo), ou
+ * NULL em caso de falha de alocação
+ * \param arena Ponteiro duplo para Arena
+ * \param size Tamanho, em bytes, da memória
+ */
+void* ARENA_alloc(Arena** arena, size_t size);
+
+/**
+ * Aloca pool de objetos de tamanho fixo. Os objetos são reservados na arena
+ * informada, em grupos de objectsPerSlab objetos. Objetos com ao menos 64 bytes
+ * são alinhados à linha de cache
+ * \return Ponteiro para Pool, ou NULL em caso de falha de alocação
+ * \param arena Ponteiro duplo para a Arena que fornece a memória (deve ser
+ * liberada depois do pool)
+ * \param objectSize Tamanho, em bytes, de cada objeto
+ * \param objectsPerSlab Quantidade de objetos reservados de cada vez
+ */
+Pool* POOL_create(Arena** arena, size_t objectSize, int objectsPerSlab);
+
+/**
+ * Libera o pool. A memória dos objetos pertence à arena e é liberada com ela
+ * \return NULL
+ * \param pool Ponteiro para Pool
+ */
+Pool* POOL_free(Pool* pool);
+
+/**
+ * Obtém um objeto do pool, reaproveitando um objeto devolvido se houver
+ * \return Ponteiro para o objeto, ou NULL em caso de falha de alocação
+ * \param pool Ponteiro duplo para Pool
+ */
+void* POOL_alloc(Pool** pool);
+
+/**
+ * Devolve um objeto para o pool
+ * \param pool Ponteiro duplo para Pool
+ * \param object Ponteiro para o objeto (obtido de POOL_alloc do mesmo pool)
+ */
+void POOL_release(Pool** pool, void* object);
+
+#endif /* POOL_H_ */
@@ -0,0 +1,769 @@
+/**
+ * \file program.c
+ * Implementação do arquivo program.h
+ */
+
+#include "program.h"
+
+// tamanho da cópia local da representação textual de um número (números mais
+// longos são copiados para memória alocada)
+#define NUMBER_SIZE 64
+
+// capacidade da pilha de valores local usada na execução do programa (programas
+// mais profundos têm uma pilha própria, alocada na compilação)
+#define STACK_SIZE 64
+
+// quantidade de argumentos simples (números e referências) juntados antes de
+// serem passados para o acumulador da função
+#define INLINE_VALUES 16
+
+/****************************************************************************
+ * Estruturas
+ ****************************************************************************/
+
+/**
+ * Estrutura de uma instrução do programa
+ */
+typedef struct instruction Instruction;
+struct instruction{
+    char type; ///< 'n' número, 'r' referência, 'o' operador, 'f' função
+    char symbol; ///< símbolo do operador
+    int first; ///< índice da célula (referência) ou do primeiro argumento (função)
+    int amount; ///< quantidade de argumentos (função)
+    int ranges; ///< quantidade de argumentos que são intervalos (função)
+    int function; ///< índice do nome da função
+    int id; ///< identificador da função no módulo de funções
+    double value; ///< valor numérico
+};
+
+/**
+ * Estrutura de um argumento de função
+ */
+typedef struct argument Argument;
+struct argument{
+    char type; ///< 'n' número, 'r' referência, 'i' intervalo
+    int firstCell; ///< célula da referência, ou canto superior esquerdo do intervalo
+    int lastCell; ///< canto inferior direito do intervalo
+    double value; ///< valor numérico
+};
+
+/**
+ * Estrutura do resultado parcial de uma função guardado entre execuções: o
+ * acumulador com os valores dos intervalos da função, mantido pelas mudanças
+ * informadas em PROGRAM_notifyChange
+ */
+typedef struct functionCache FunctionCache;
+struct functionCache{
+    FunctionAccumulator accumulator;
+    int valid; ///< falso se os intervalos precisam ser percorridos de novo
+};
+
+/**
+ * Estrutura de uma dependência do programa
+ */
+typedef struct precedent Precedent;
+struct precedent{
+    int firstCell;
+    int lastCell;
+};
+
+/**
+ * Estrutura do programa compilado de uma expressão
+ */
+struct program{
+    int columns;
+    int valid; ///< falso se a expressão desbalanceia a pilha de valores
+    int depth; ///< maior quantidade de valores na pilha durante a execução
+    double* stack; ///< pilha de valores se depth passar de STACK_SIZE (ou NULL)
+
+    int size;
+    Instruction* instructions;
+
+    int argumentsSize;
+    Argument* arguments;
+
+    int functionsSize;
+    char (*functions)[FUNCTIONS_NAME_SIZE];
+    FunctionCache* caches; ///< resultado parcial de cada função (na ordem de functions)
+
+    int precedentsSize;
+    Precedent* precedents;
+};
+
+/****************************************************************************
+ * Funções privadas
+ ****************************************************************************/
+
+/**
+ * Lê uma referência ('A2' ou 'AB1048576', por exemplo) e calcula o índice da
+ * célula no grafo
+ * \return 1 se havia uma referência na posição atual, 0 em caso contrário
+ * \param expression Expressão que contém a referência
+ * \param count Contador que percorre a expressão (termina no primeiro caractere
+ * após a referência; não é alterado se não houver referência)
+ * \param columns Quantidade de colunas da matriz
+ * \param cellIndex Variável a ser preenchida com o índice da célula no grafo
+ */
+int PROGRAM_readReference(const char* expression, int* count, int columns, int* cellIndex){
+    int row, column;
+    int length = REFERENCE_read(expression + (*count), &row, &column);
+    if(!length) return 0;
+
+    (*count) += length;
+    (*cellIndex) = (column-1)+(row-1)*columns;
+    return 1;
+}
+
+/**
+ * Lê um número da expressão
+ * \return Valor do número
+ * \param expression Expressão que contém o número
+ * \param count Contador que percorre a expressão (termina no primeiro
+ * caractere após o número)
+ * \param inFunction Se verdadeiro, o número termina apenas em uma vírgula ou
+ * fecha parênteses (como em um argumento de função)
+ */
+double PROGRAM_readNumber(const char* expression, int* count, int inFunction){
+    int start = (*count);
+
+    while(expression[*count]!=0
+            && ((inFunction && expression[*count]!=',' && expression[*count]!=')')
+            || (!inFunction && (REFERENCE_charIsNumber(expression[*count])
+                    || expression[*count]=='.'))))
+        (*count)++;
+
+    // o número é copiado para terminar onde termina na expressão (o texto
+    // seguinte, como 'E5' em '1E5', não faz parte dele)
+    int size = (*count) - start;
+    char local[NUMBER_SIZE];
+    char* number = local;
+    if(size >= NUMBER_SIZE && !(number = malloc(size+1)))
+        return strtod(expression + start, NULL);
+
+    memcpy(number, expression + start, size);
+    number[size] = 0;
+
+    double value = atof(number);
+    if(number != local) free(number);
+
+    return value;
+}
+
+/**
+ * Adiciona uma dependência no programa
+ * \param program Ponteiro duplo para Program
+ * \param firstCell Primeira célula da dependência
+ * \param lastCell Última célula da dependência
+ */
+void PROGRAM_addPrecedent(Program** program, int firstCell, int lastCell){
+    (*program)->precedents[(*program)->precedentsSize].firstCell = firstCell;
+    (*program)->precedents[(*program)->precedentsSize].lastCell = lastCell;
+    (*program)->precedentsSize++;
+}
+
+/**
+ * Transforma o último argumento (uma referência) em um intervalo
+ * \param program Ponteiro duplo para Program
+ * \param cellIndex Índice da célula que fecha o intervalo
+ */
+void PROGRAM_makeInterval(Program** program, int cellIndex){
+    if(!(*program)->argumentsSize) return;
+
+    Argument* argument = &((*program)->arguments[(*program)->argumentsSize-1]);
+    if(argument->type!='r') return;
+
+    int columns = (*program)->columns;
+
+    // calcula linhas e colunas das duas pontas do intervalo
+    int firstRow = argument->firstCell/columns, firstColumn = argument->firstCell%columns;
+    int lastRow = cellIndex/columns, lastColumn = cellIndex%columns;
+
+    // normaliza intervalo (canto superior esquerdo e inferior direito)
+    int temp;
+    if(firstRow > lastRow){
+        temp = firstRow;
+        firstRow = lastRow;
+        lastRow = temp;
+    }
+    if(firstColumn > lastColumn){
+        temp = firstColumn;
+        firstColumn = lastColumn;
+        lastColumn = temp;
+    }
+
+    // intervalo de uma única célula continua sendo uma referência simples
+    if(firstColumn + firstRow*columns == lastColumn + lastRow*columns) return;
+
+    argument->type = 'i';
+    argument->firstCell = firstColumn + firstRow*columns;
+    argument->lastCell = lastColumn + lastRow*columns;
+
+    // a referência já foi registrada como dependência. substitui pelo intervalo
+    (*program)->precedents[(*program)->precedentsSize-1].firstCell = argument->firstCell;
+    (*program)->precedents[(*program)->precedentsSize-1].lastCell = argument->lastCell;
+}
+
+/**
+ * Compila uma função e seus argumentos
+ * \param program Ponteiro duplo para Program
+ * \param expression Expressão que contém a função
+ * \param count Contador que percorre a expressão (termina após o fecha parênteses)
+ */
+void PROGRAM_compileFunction(Program** program, const char* expression, int* count){
+    Instruction* instruction = &((*program)->instructions[(*program)->size]);
+    Argument* argument;
+    int size = 0, cellIndex;
+
+    instruction->type = 'f';
+    instruction->function = (*program)->functionsSize;
+    instruction->first = (*program)->argumentsSize;
+    instruction->amount = 0;
+    instruction->ranges = 0;
+    (*program)->caches[instruction->function].valid = false;
+
+    // lê o nome da função
+    while(expression[*count]!=0 && expression[*count]!='('){
+        if(size < FUNCTIONS_NAME_SIZE-1)
+            (*program)->functions[(*program)->functionsSize][size++] = expression[*count];
+        (*count)++;
+    }
+    (*program)->functions[(*program)->functionsSize][size] = 0;
+    instruction->id = FUNCTIONS_getFunction((*program)->functions[(*program)->functionsSize]);
+    (*program)->functionsSize++;
+    (*program)->size++;
+
+    if(expression[*count]==0) return;
+    // pula o abre parênteses
+    (*count)++;
+
+    // enquanto não encontrar o fecha parênteses...
+    while(expression[*count]!=0 && expression[*count]!=')'){
+
+        // pula espaços e vírgulas
+        if(expression[*count]==' ' || expression[*count]==','){
+            (*count)++;
+        }
+
+        // dois pontos: o último argumento se torna um intervalo
+        else if(expression[*count]==':'){
+            (*count)++;
+            while(expression[*count]==' ')
+                (*count)++;
+            if(PROGRAM_readReference(expression, &(*count), (*program)->columns, &cellIndex))
+                PROGRAM_makeInterval(&(*program), cellIndex);
+        }
+
+        // referência
+        else if(PROGRAM_readReference(expression, &(*count), (*program)->columns,
+                &cellIndex)){
+            argument = &((*program)->arguments[(*program)->argumentsSize++]);
+            argument->type = 'r';
+            argument->firstCell = cellIndex;
+            argument->lastCell = argument->firstCell;
+            PROGRAM_addPrecedent(&(*program), argument->firstCell, argument->lastCell);
+            instruction->amount++;
+        }
+
+        // número
+        else{
+            argument = &((*program)->arguments[(*program)->argumentsSize++]);
+            argument->type = 'n';
+            argument->value = PROGRAM_readNumber(expression, &(*count), true);
+            instruction->amount++;
+        }
+    }
+
+    // pula o fecha parênteses
+    if(expression[*count]==')')
+        (*count)++;
+
+    for(size = instruction->first; size < instruction->first + instruction->amount; size++)
+        if((*program)->arguments[size].type=='i')
+            instruction->ranges++;
+}
+
+/**
+ * Passa os valores de um intervalo para o acumulador. Se a função aceita um
+ * resumo dos valores, cada coluna do intervalo é pedida de uma vez a
+ * summaryReader; as colunas que ele não resume, e os intervalos das demais
+ * funções, são lidos linha a linha em blocos de células consecutivas
+ * \param program Ponteiro duplo para Program
+ * \param argument Argumento do intervalo
+ * \param spanReader Função que obtém os valores de células consecutivas
+ * \param summaryReader Função que obtém o resumo de um intervalo de uma coluna
+ * (pode ser NULL)
+ * \param source Origem dos valores
+ * \param accumulator Ponteiro para o acumulador
+ */
+void PROGRAM_accumulateRange(Program** program, Argument* argument,
+        ProgramSpanReader spanReader, ProgramSummaryReader summaryReader, void* source,
+        FunctionAccumulator* accumulator){
+
+    const FunctionDefinition* definition = FUNCTIONS_getDefinition(accumulator->function);
+    const double* span;
+    double value, compensation;
+    int row, column, cellIndex, remaining, length, columns = (*program)->columns;
+    int firstRow = argument->firstCell/columns, lastRow = argument->lastCell/columns;
+    int firstColumn = argument->firstCell%columns, lastColumn = argument->lastCell%columns;
+
+    // colunas resumidas, da esquerda para a direita, até a primeira que não for
+    column = firstColumn;
+    if(summaryReader && definition && definition->summary != FUNCTIONS_SUMMARY_NONE){
+        for(; column <= lastColumn; column++){
+            if(!summaryReader(source, definition->summary, column + firstRow*columns,
+                    column + lastRow*columns, &value, &compensation))
+                break;
+            FUNCTIONS_accumulateSummary(accumulator, value, compensation,
+                    lastRow - firstRow + 1);
+        }
+    }
+
+    // as colunas restantes são lidas linha a linha
+    for(row = firstRow; row <= lastRow && column <= lastColumn; row++){
+        cellIndex = column + row*columns;
+        remaining = lastColumn - column + 1;
+
+        while(remaining > 0){
+            length = spanReader(source, cellIndex, remaining, &span);
+            FUNCTIONS_accumulate(accumulator, span, length);
+            cellIndex += length;
+            remaining -= length;
+        }
+    }
+}
+
+/**
+ * Calcula uma função passando seus argumentos direto para o acumulador da
+ * função. Os intervalos são percorridos apenas quando o resultado parcial
+ * guardado da função não é válido; números e referências são lidos a cada
+ * execução, juntados em um pequeno vetor local
+ * \return Resultado da função
+ * \param program Ponteiro duplo para Program
+ * \param instruction Instrução da função
+ * \param reader Função que obtém o valor das células
+ * \param spanReader Função que obtém os valores de células consecutivas
+ * \param summaryReader Função que obtém o resumo de um intervalo de uma coluna
+ * (pode ser NULL)
+ * \param source Origem dos valores
+ */
+double PROGRAM_runFunction(Program** program, Instruction* instruction,
+        ProgramReader reader, ProgramSpanReader spanReader,
+        ProgramSummaryReader summaryReader, void* source){
+
+    FunctionCache* cache = &((*program)->caches[instruction->function]);
+    FunctionAccumulator accumulator;
+    double values[INLINE_VALUES];
+    Argument* argument;
+    int count, size = 0;
+
+    // os intervalos entram primeiro, a partir do resultado parcial guardado
+    if(instruction->ranges){
+        if(!cache->valid){
+            FUNCTIONS_begin(&cache->accumulator, instruction->id);
+            for(count = instruction->first;
+                    count < instruction->first + instruction->amount; count++)
+                if((*program)->arguments[count].type=='i')
+                    PROGRAM_accumulateRange(&(*program), &((*program)->arguments[count]),
+                            spanReader, summaryReader, source, &cache->accumulator);
+            cache->valid = true;
+        }
+        accumulator = cache->accumulator;
+    }
+    else
+        FUNCTIONS_begin(&accumulator, instruction->id);
+
+    for(count = instruction->first; count < instruction->first + instruction->amount;
+            count++){
+        argument = &((*program)->arguments[count]);
+        if(argument->type=='i') continue;
+
+        if(size == INLINE_VALUES){
+            FUNCTIONS_accumulate(&accumulator, values, size);
+            size = 0;
+        }
+        values[size++] = (argument->type=='n') ? argument->value
+                : reader(source, argument->firstCell);
+    }
+
+    FUNCTIONS_accumulate(&accumulator, values, size);
+
+    return FUNCTIONS_end(&accumulator);
+}
+
+/**
+ * Preenche lista de valores com os argumentos de uma função (usada apenas pela
+ * implementação de referência)
+ * \return Lista de valores
+ * \param program Ponteiro duplo para Program
+ * \param instruction Instrução da função
+ * \param reader Função que obtém o valor das células
+ * \param source Origem dos valores
+ */
+ListDouble* PROGRAM_extractList(Program** program, Instruction* instruction,
+        ProgramReader reader, void* source){
+
+    ListDouble* list = FUNCTIONS_createList();
+    ListDouble* last = NULL;
+    Argument* argument;
+    int count, row, column, columns = (*program)->columns;
+
+    for(count = instruction->first; count < instruction->first + instruction->amount;
+            count++){
+        argument = &((*program)->arguments[count]);
+
+        if(argument->type=='n')
+            list = FUNCTIONS_appendValue(list, &last, argument->value);
+        else if(argument->type=='r')
+            list = FUNCTIONS_appendValue(list, &last,
+                    reader(source, argument->firstCell));
+        else{
+            // percorre o intervalo linha a linha
+            for(row = argument->firstCell/columns; row <= argument->lastCell/columns; row++)
+                for(column = argument->firstCell%columns;
+                        column <= argument->lastCell%columns; column++)
+                    list = FUNCTIONS_appendValue(list, &last,
+                            reader(source, column + row*columns));
+        }
+    }
+
+    return list;
+}
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Compila uma expressão pós-fixa (já validada) em um programa
+ * \return Ponteiro para Program, ou NULL se a expressão for vazia ou em caso
+ * de falha de alocação
+ * \param expression Expressão a ser compilada
+ * \param columns Quantidade de colunas da matriz (usada para calcular o índice
+ * das referências)
+ */
+Program* PROGRAM_compile(const char* expression, int columns){
+    if(!expression || strcmp(expression, "")==0) return NULL;
+
+    // cada elemento da expressão ocupa ao menos um caractere
+    int capacity = strlen(expression);
+
+    // o programa e seus vetores ocupam um único bloco de memória (os vetores
+    // com double vêm primeiro, mantendo o alinhamento)
+    Program* program = malloc(sizeof(Program) + (sizeof(Instruction) + sizeof(Argument)
+            + sizeof(Precedent) + sizeof(FunctionCache)
+            + sizeof(char[FUNCTIONS_NAME_SIZE]))*capacity);
+    if(!program) return NULL;
+
+    program->columns = columns;
+    program->valid = true;
+    program->depth = 0;
+    program->stack = NULL;
+    program->size = 0;
+    program->argumentsSize = 0;
+    program->functionsSize = 0;
+    program->precedentsSize = 0;
+    program->instructions = (Instruction*) (program + 1);
+    program->arguments = (Argument*) (program->instructions + capacity);
+    program->caches = (FunctionCache*) (program->arguments + capacity);
+    program->precedents = (Precedent*) (program->caches + capacity);
+    program->functions = (char (*)[FUNCTIONS_NAME_SIZE]) (program->precedents + capacity);
+
+    Instruction* instruction;
+
+    // quantidade de valores na pilha durante a execução
+    int depth = 0;
+
+    // percorre a expressão
+    int count=0;
+    while(expression[count] != 0){
+        instruction = &(program->instructions[program->size]);
+
+        // pula espaços em branco
+        if(expression[count]==' '){
+            count++;
+        }
+
+        // operador
+        else if(REFERENCE_charIsOperator(expression[count])){
+            instruction->type = 'o';
+            instruction->symbol = expression[count];
+            program->size++;
+            count++;
+
+            // retira dois valores e coloca o resultado
+            if(depth < 2) program->valid = false;
+            depth--;
+        }
+
+        // número
+        else if(REFERENCE_charIsNumber(expression[count])){
+            instruction->type = 'n';
+            instruction->value = PROGRAM_readNumber(expression, &count, false);
+            program->size++;
+            depth++;
+        }
+
+        // referência para uma célula
+        else if(PROGRAM_readReference(expression, &count, columns, &instruction->first)){
+            instruction->type = 'r';
+            PROGRAM_addPrecedent(&program, instruction->first, instruction->first);
+            program->size++;
+            depth++;
+        }
+
+        // função
+        else{
+            PROGRAM_compileFunction(&program, expression, &count);
+            depth++;
+        }
+
+        if(depth > program->depth) program->depth = depth;
+    }
+
+    // ao final deve restar exatamente um valor na pilha
+    if(depth != 1) program->valid = false;
+
+    // a pilha local de PROGRAM_run não comporta o programa
+    if(program->valid && program->depth > STACK_SIZE){
+        program->stack = malloc(sizeof(double)*program->depth);
+        if(!program->stack){
+            free(program);
+            return NULL;
+        }
+    }
+
+    return program;
+}
+
+/**
+ * Verifica se a expressão é apenas um número (como '42.5'), lendo o seu valor
+ * sem compilá-la. O valor é o mesmo calculado pelo programa da expressão
+ * \return 1 se a expressão for um número, 0 em caso contrário
+ * \param expression Expressão (já validada)
+ * \param value Variável a ser preenchida com o valor do número
+ */
+int PROGRAM_readLiteral(const char* expression, double* value){
+    if(!expression) return 0;
+
+    int count = 0;
+    while(expression[count]==' ') count++;
+
+    int start = count;
+    while(REFERENCE_charIsNumber(expression[count]) || expression[count]=='.')
+        count++;
+
+    if(count == start) return 0;
+
+    int end = count;
+    while(expression[count]==' ') count++;
+    if(expression[count]!=0) return 0;
+
+    count = start;
+    (*value) = PROGRAM_readNumber(expression, &count, false);
+    return (count == end);
+}
+
+/**
+ * Libera memória alocada no programa
+ * \return NULL
+ * \param program Ponteiro para Program
+ */
+Program* PROGRAM_free(Program* program){
+    if(!program) return NULL;
+
+    free(program->stack);
+    free(program);
+
+    return NULL;
+}
+
+/**
+ * Executa o programa, calculando o valor da expressão. Usa uma pilha de
+ * valores local, de capacidade fixa, ou a pilha alocada na compilação quando a
+ * expressão for mais profunda, sem alocação de memória; os argumentos das
+ * funções são passados direto para o acumulador da função, com os intervalos
+ * lidos em blocos de células consecutivas. O resultado parcial dos intervalos
+ * de cada função é guardado e, enquanto as mudanças forem informadas com
+ * PROGRAM_notifyChange, não é preciso percorrê-los de novo. Quando possível, o
+ * intervalo de cada coluna é lido de uma vez como um resumo (summaryReader)
+ * \return Valor da expressão (0 se o programa for inválido)
+ * \param program Ponteiro duplo para Program
+ * \param reader Função que obtém o valor das células referenciadas
+ * \param spanReader Função que obtém os valores de células consecutivas
+ * \param summaryReader Função que obtém o resumo de um intervalo de uma coluna
+ * (pode ser NULL)
+ * \param source Origem dos valores, repassada para as funções de leitura
+ */
+double PROGRAM_run(Program** program, ProgramReader reader, ProgramSpanReader spanReader,
+        ProgramSummaryReader summaryReader, void* source){
+    if(!program || !(*program) || !(*program)->valid) return 0;
+
+    // pilha de valores e seu topo
+    double local[STACK_SIZE];
+    double* stack = (*program)->stack ? (*program)->stack : local;
+    int top = -1;
+
+    Instruction* instruction = (*program)->instructions;
+    Instruction* end = instruction + (*program)->size;
+
+    for(; instruction < end; instruction++){
+        switch(instruction->type){
+        case 'n':
+            stack[++top] = instruction->value;
+            break;
+        case 'r':
+            stack[++top] = reader(source, instruction->first);
+            break;
+        case 'o':
+            top--;
+            switch(instruction->symbol){
+            case '+':
+                stack[top] += stack[top+1];
+                break;
+            case '-':
+                stack[top] -= stack[top+1];
+                break;
+            case '*':
+                stack[top] *= stack[top+1];
+                break;
+            case '/':
+                if(stack[top+1]!=0)
+                    stack[top] /= stack[top+1];
+                break;
+            }
+            break;
+        default:
+            stack[++top] = PROGRAM_runFunction(&(*program), instruction, reader,
+                    spanReader, summaryReader, source);
+        }
+    }
+
+    return stack[0];
+}
+
+/**
+ * Executa o programa usando a pilha de árvores de expressão binária e listas
+ * de argumentos. É a implementação de referência, usada para comparar
+ * resultados com PROGRAM_run (recebe os mesmos parâmetros, mas lê as células
+ * uma a uma)
+ * \return Valor da expressão
+ * \param program Ponteiro duplo para Program
+ * \param reader Função que obtém o valor das células referenciadas
+ * \param spanReader Não é usado
+ * \param summaryReader Não é usado
+ * \param source Origem dos valores, repassada para reader
+ */
+double PROGRAM_runReference(Program** program, ProgramReader reader,
+        ProgramSpanReader spanReader, ProgramSummaryReader summaryReader, void* source){
+    if(!program || !(*program)) return 0;
+
+    // Pilha de árvore de expressão binária
+    StackBinExpTree* stackBin = STACKBINEXPTREE_create();
+
+    Instruction* instruction;
+    ListDouble* list;
+
+    int count;
+    for(count=0; count < (*program)->size; count++){
+        instruction = &((*program)->instructions[count]);
+
+        switch(instruction->type){
+        case 'n':
+            STACKBINEXPTREE_pushValue(&stackBin, instruction->value);
+            break;
+        case 'r':
+            STACKBINEXPTREE_pushValue(&stackBin, reader(source, instruction->first));
+            break;
+        case 'o':
+            STACKBINEXPTREE_pushSymbol(&stackBin, instruction->symbol);
+            break;
+        default:
+            list = PROGRAM_extractList(&(*program), instruction, reader, source);
+            STACKBINEXPTREE_pushValue(&stackBin, FUNCTIONS_evalFunction(
+                    (*program)->functions[instruction->function], &list));
+            list = FUNCTIONS_free(list);
+        }
+    }
+
+    double value = STACKBINEXPTREE_pop(&stackBin);
+    stackBin = STACKBINEXPTREE_free(stackBin);
+
+    return value;
+}
+
+/**
+ * Obtém a quantidade de células ou intervalos dos quais o programa depende
+ * \return Quantidade de dependências do programa
+ * \param program Ponteiro duplo para Program
+ */
+int PROGRAM_getPrecedentsSize(Program** program){
+    if(!program || !(*program)) return 0;
+
+    return (*program)->precedentsSize;
+}
+
+/**
+ * Obtém uma dependência do programa. Referências simples possuem firstCell
+ * igual a lastCell; intervalos são informados pelo canto superior esquerdo
+ * e pelo canto inferior direito
+ * \return 1 em caso de sucesso, 0 se o índice for inválido
+ * \param program Ponteiro duplo para Program
+ * \param index Índice da dependência (de 0 até PROGRAM_getPrecedentsSize - 1)
+ * \param firstCell Variável a ser preenchida com o índice da primeira célula
+ * \param lastCell Variável a ser preenchida com o índice da última célula
+ */
+int PROGRAM_getPrecedent(Program** program, int index, int* firstCell, int* lastCell){
+    if(!program || !(*program) || index < 0 || index >= (*program)->precedentsSize)
+        return 0;
+
+    *firstCell = (*program)->precedents[index].firstCell;
+    *lastCell = (*program)->precedents[index].lastCell;
+
+    return 1;
+}
+
+/**
+ * Informa ao programa que o valor de uma célula mudou, atualizando o resultado
+ * parcial guardado das funções cujos intervalos contêm a célula (ou
+ * descartando-o quando a função não permite a atualização, como na soma)
+ * \param program Ponteiro duplo para Program
+ * \param cellIndex Índice da célula no grafo
+ * \param oldValue Valor anterior da célula
+ * \param newValue Novo valor da célula
+ */
+void PROGRAM_notifyChange(Program** program, int cellIndex, double oldValue,
+        double newValue){
+    if(!program || !(*program)) return;
+
+    int columns = (*program)->columns;
+    int row = cellIndex/columns, column = cellIndex%columns;
+    Instruction* instruction;
+    FunctionCache* cache;
+    Argument* argument;
+    int count, position;
+
+    for(count=0; count < (*program)->size; count++){
+        instruction = &((*program)->instructions[count]);
+        if(instruction->type!='f' || !instruction->ranges) continue;
+
+        cache = &((*program)->caches[instruction->function]);
+        if(!cache->valid) continue;
+
+        // a célula pode estar em mais de um intervalo da mesma função
+        for(position = instruction->first;
+                position < instruction->first + instruction->amount; position++){
+            argument = &((*program)->arguments[position]);
+            if(argument->type!='i'
+                    || row < argument->firstCell/columns || row > argument->lastCell/columns
+                    || column < argument->firstCell%columns
+                    || column > argument->lastCell%columns)
+                continue;
+
+            if(!FUNCTIONS_update(&cache->accumulator, oldValue, newValue)){
+                cache->valid = false;
+                break;
+            }
+        }
+    }
+}
+
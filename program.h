@@ -0,0 +1,152 @@
+/**
+ * \file program.h
+ * Arquivo que descreve o programa compilado de uma expressão pós-fixa
+ */
+
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "reference.h"
+#include "stack_binExpTree.h"
+#include "functions.h"
+
+/**
+ * Estrutura do programa compilado de uma expressão
+ */
+typedef struct program Program;
+
+/**
+ * Função usada pelo programa para obter o valor de uma célula
+ * \return Valor da célula
+ * \param source Origem dos valores (informada em PROGRAM_run)
+ * \param cellIndex Índice da célula no grafo
+ */
+typedef double (*ProgramReader)(void* source, int cellIndex);
+
+/**
+ * Função usada pelo programa para obter os valores de células consecutivas
+ * (na ordem do índice no grafo) de uma vez
+ * \return Quantidade de células consecutivas disponíveis a partir de cellIndex
+ * (entre 1 e size)
+ * \param source Origem dos valores (informada em PROGRAM_run)
+ * \param cellIndex Índice da primeira célula no grafo
+ * \param size Quantidade máxima de células desejadas
+ * \param values Variável a ser preenchida com o vetor de valores das células, ou
+ * com NULL se todas valerem 0
+ */
+typedef int (*ProgramSpanReader)(void* source, int cellIndex, int size, const double** values);
+
+/**
+ * Função usada pelo programa para obter o resumo (soma, máximo ou mínimo) das
+ * células de um intervalo de uma única coluna sem ler célula a célula
+ * \return 1 se o resumo foi obtido, 0 se as células devem ser lidas uma a uma
+ * \param source Origem dos valores (informada em PROGRAM_run)
+ * \param summary Tipo do resumo (FUNCTIONS_SUMMARY_SUM, _MAX ou _MIN)
+ * \param firstCell Índice da primeira célula (linha de cima)
+ * \param lastCell Índice da última célula (linha de baixo, mesma coluna)
+ * \param value Variável a ser preenchida com o resumo
+ * \param compensation Variável a ser preenchida com o erro de arredondamento do
+ * resumo (apenas na soma; 0 nos demais)
+ */
+typedef int (*ProgramSummaryReader)(void* source, int summary, int firstCell, int lastCell,
+        double* value, double* compensation);
+
+/**
+ * Compila uma expressão pós-fixa (já validada) em um programa
+ * \return Ponteiro para Program, ou NULL se a expressão for vazia ou em caso
+ * de falha de alocação
+ * \param expression Expressão a ser compilada
+ * \param columns Quantidade de colunas da matriz (usada para calcular o índice
+ * das referências)
+ */
+Program* PROGRAM_compile(const char* expression, int columns);
+
+/**
+ * Verifica se a expressão é apenas um número (como '42.5'), lendo o seu valor
+ * sem compilá-la. O valor é o mesmo calculado pelo programa da expressão
+ * \return 1 se a expressão for um número, 0 em caso contrário
+ * \param expression Expressão (já validada)
+ * \param value Variável a ser preenchida com o valor do número
+ */
+int PROGRAM_readLiteral(const char* expression, double* value);
+
+/**
+ * Libera memória alocada no programa
+ * \return NULL
+ * \param program Ponteiro para Program
+ */
+Program* PROGRAM_free(Program* program);
+
+/**
+ * Executa o programa, calculando o valor da expressão. Usa uma pilha de
+ * valores local, de capacidade fixa, ou a pilha alocada na compilação quando a
+ * expressão for mais profunda, sem alocação de memória; os argumentos das
+ * funções são passados direto para o acumulador da função, com os intervalos
+ * lidos em blocos de células consecutivas. O resultado parcial dos intervalos
+ * de cada função é guardado e, enquanto as mudanças forem informadas com
+ * PROGRAM_notifyChange, não é preciso percorrê-los de novo. Quando possível, o
+ * intervalo de cada coluna é lido de uma vez como um resumo (summaryReader)
+ * \return Valor da expressão (0 se o programa for inválido)
+ * \param program Ponteiro duplo para Program
+ * \param reader Função que obtém o valor das células referenciadas
+ * \param spanReader Função que obtém os valores de células consecutivas
+ * \param summaryReader Função que obtém o resumo de um intervalo de uma coluna
+ * (pode ser NULL)
+ * \param source Origem dos valores, repassada para as funções de leitura
+ */
+double PROGRAM_run(Program** program, ProgramReader reader, ProgramSpanReader spanReader,
+        ProgramSummaryReader summaryReader, void* source);
+
+/**
+ * Executa o programa usando a pilha de árvores de expressão binária e listas
+ * de argumentos. É a implementação de referência, usada para comparar
+ * resultados com PROGRAM_run (recebe os mesmos parâmetros, mas lê as células
+ * uma a uma)
+ * \return Valor da expressão
+ * \param program Ponteiro duplo para Program
+ * \param reader Função que obtém o valor das células referenciadas
+ * \param spanReader Não é usado
+ * \param summaryReader Não é usado
+ * \param source Origem dos valores, repassada para reader
+ */
+double PROGRAM_runReference(Program** program, ProgramReader reader,
+        ProgramSpanReader spanReader, ProgramSummaryReader summaryReader, void* source);
+
+/**
+ * Obtém a quantidade de células ou intervalos dos quais o programa depende
+ * \return Quantidade de dependências do programa
+ * \param program Ponteiro duplo para Program
+ */
+int PROGRAM_getPrecedentsSize(Program** program);
+
+/**
+ * Obtém uma dependência do programa. Referências simples possuem firstCell
+ * igual a lastCell; intervalos são informados pelo canto superior esquerdo
+ * e pelo canto inferior direito
+ * \return 1 em caso de sucesso, 0 se o índice for inválido
+ * \param program Ponteiro duplo para Program
+ * \param index Índice da dependência (de 0 até PROGRAM_getPrecedentsSize - 1)
+ * \param firstCell Variável a ser preenchida com o índice da primeira célula
+ * \param lastCell Variável a ser preenchida com o índice da última célula
+ */
+int PROGRAM_getPrecedent(Program** program, int index, int* firstCell, int* lastCell);
+
+/**
+ * Informa ao programa que o valor de uma célula mudou, atualizando o resultado
+ * parcial guardado das funções cujos intervalos contêm a célula (ou
+ * descartando-o quando a função não permite a atualização, como na soma)
+ * \param program Ponteiro duplo para Program
+ * \param cellIndex Índice da célula no grafo
+ * \param oldValue Valor anterior da célula
+ * \param newValue Novo valor da célula
+ */
+void PROGRAM_notifyChange(Program** program, int cellIndex, double oldValue,
+        double newValue);
+
+
+#endif /* PROGRAM_H_ */
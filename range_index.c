@@ -0,0 +1,614 @@
+/**
+ * \file range_index.c
+ * Implementação do arquivo range_index.h
+ *
+ * Os intervalos são distribuídos em níveis: no nível L o plano é dividido em
+ * blocos quadrados de lado 2^L, e cada intervalo fica no menor nível cujo lado
+ * cobre sua altura e sua largura. Assim um intervalo ocupa no máximo 4 blocos
+ * (2 em cada direção), e uma célula pertence a exatamente um bloco por nível.
+ * Os blocos não vazios ficam em uma tabela hash
+ */
+
+#include "range_index.h"
+
+// quantidade de níveis (o maior bloco tem lado 2^(LEVELS-1))
+#define LEVELS 25
+
+// capacidade inicial da tabela de blocos (potência de 2)
+#define INITIAL_BUCKETS 64
+
+// capacidade inicial do vetor de intervalos
+#define INITIAL_RANGES 16
+
+// capacidade inicial da lista de intervalos de um bloco
+#define INITIAL_ITEMS 4
+
+// deslocamentos usados para montar a chave de um bloco
+#define KEY_LEVEL_SHIFT 48
+#define KEY_ROW_SHIFT 24
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura de um intervalo
+ */
+typedef struct range Range;
+struct range{
+    int firstRow;
+    int firstColumn;
+    int lastRow;
+    int lastColumn;
+    int value; ///< valor associado ao intervalo
+    int level; ///< nível em que o intervalo está (-1 se a posição estiver livre)
+    int bound; ///< limite do intervalo (nunca menor que o das células que ele contém)
+    int count; ///< contagem do intervalo, mantida a partir das células que ele contém
+};
+
+/**
+ * Estrutura de um bloco da tabela hash, com os intervalos que o cruzam
+ */
+typedef struct bucket Bucket;
+struct bucket{
+    unsigned long long key; ///< nível, linha e coluna do bloco
+    int* items; ///< posições dos intervalos no vetor de intervalos
+    int size;
+    int capacity;
+    Bucket* next; ///< próximo bloco com o mesmo hash
+};
+
+/**
+ * Estrutura do índice de intervalos
+ */
+struct rangeIndex{
+    Range* ranges;
+    int rangesSize;
+    int rangesCapacity;
+    StackInt* freeRanges; ///< posições livres no vetor de intervalos
+
+    Bucket** buckets;
+    int bucketsSize;
+    int bucketsCapacity;
+
+    int levels[LEVELS]; ///< quantidade de intervalos em cada nível
+    int size; ///< quantidade de intervalos no índice
+};
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Calcula o nível de um intervalo
+ * \return Menor nível cujo lado do bloco cobre a altura e a largura do intervalo
+ * \param height Altura do intervalo
+ * \param width Largura do intervalo
+ */
+int RANGEINDEX_getLevel(int height, int width){
+    int size = height > width ? height : width;
+    int level = 0;
+
+    while(level < LEVELS-1 && (1 << level) < size)
+        level++;
+
+    return level;
+}
+
+/**
+ * Calcula a chave de um bloco
+ * \return Chave do bloco
+ * \param level Nível do bloco
+ * \param row Linha do bloco (linha da célula deslocada pelo nível)
+ * \param column Coluna do bloco (coluna da célula deslocada pelo nível)
+ */
+unsigned long long RANGEINDEX_getKey(int level, int row, int column){
+    return ((unsigned long long) level << KEY_LEVEL_SHIFT)
+            | ((unsigned long long) row << KEY_ROW_SHIFT) | (unsigned long long) column;
+}
+
+/**
+ * Calcula a posição de uma chave na tabela hash
+ * \return Posição na tabela
+ * \param key Chave do bloco
+ * \param capacity Capacidade da tabela (potência de 2)
+ */
+int RANGEINDEX_hash(unsigned long long key, int capacity){
+    return (int) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity-1);
+}
+
+/**
+ * Dobra a capacidade da tabela hash, redistribuindo os blocos
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ */
+int RANGEINDEX_growBuckets(RangeIndex** rangeIndex){
+    int capacity = (*rangeIndex)->bucketsCapacity*2;
+    Bucket** buckets = calloc(capacity, sizeof(Bucket*));
+    if(!buckets) return 0;
+
+    Bucket *bucket, *next;
+    int count, position;
+    for(count=0; count < (*rangeIndex)->bucketsCapacity; count++){
+        for(bucket = (*rangeIndex)->buckets[count]; bucket; bucket = next){
+            next = bucket->next;
+            position = RANGEINDEX_hash(bucket->key, capacity);
+            bucket->next = buckets[position];
+            buckets[position] = bucket;
+        }
+    }
+
+    free((*rangeIndex)->buckets);
+    (*rangeIndex)->buckets = buckets;
+    (*rangeIndex)->bucketsCapacity = capacity;
+    return 1;
+}
+
+/**
+ * Procura um bloco na tabela hash
+ * \return Ponteiro para o bloco, ou NULL se não existir
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param key Chave do bloco
+ */
+Bucket* RANGEINDEX_findBucket(RangeIndex** rangeIndex, unsigned long long key){
+    Bucket* bucket = (*rangeIndex)->buckets[RANGEINDEX_hash(key,
+            (*rangeIndex)->bucketsCapacity)];
+
+    while(bucket && bucket->key != key)
+        bucket = bucket->next;
+
+    return bucket;
+}
+
+/**
+ * Adiciona um intervalo na lista de um bloco, criando o bloco se necessário
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param key Chave do bloco
+ * \param item Posição do intervalo no vetor de intervalos
+ */
+int RANGEINDEX_addItem(RangeIndex** rangeIndex, unsigned long long key, int item){
+    Bucket* bucket = RANGEINDEX_findBucket(&(*rangeIndex), key);
+
+    if(!bucket){
+        if((*rangeIndex)->bucketsSize >= (*rangeIndex)->bucketsCapacity
+                && !RANGEINDEX_growBuckets(&(*rangeIndex)))
+            return 0;
+
+        bucket = malloc(sizeof(Bucket));
+        if(!bucket) return 0;
+
+        bucket->items = malloc(sizeof(int)*INITIAL_ITEMS);
+        if(!bucket->items){
+            free(bucket);
+            return 0;
+        }
+
+        int position = RANGEINDEX_hash(key, (*rangeIndex)->bucketsCapacity);
+        bucket->key = key;
+        bucket->size = 0;
+        bucket->capacity = INITIAL_ITEMS;
+        bucket->next = (*rangeIndex)->buckets[position];
+        (*rangeIndex)->buckets[position] = bucket;
+        (*rangeIndex)->bucketsSize++;
+    }
+
+    // dobra a capacidade da lista se estiver cheia
+    if(bucket->size == bucket->capacity){
+        int* items = realloc(bucket->items, sizeof(int)*bucket->capacity*2);
+        if(!items) return 0;
+
+        bucket->items = items;
+        bucket->capacity *= 2;
+    }
+
+    bucket->items[bucket->size++] = item;
+    return 1;
+}
+
+/**
+ * Retira um intervalo da lista de um bloco, liberando o bloco se ficar vazio
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param key Chave do bloco
+ * \param item Posição do intervalo no vetor de intervalos
+ */
+void RANGEINDEX_removeItem(RangeIndex** rangeIndex, unsigned long long key, int item){
+    Bucket** bucket = &(*rangeIndex)->buckets[RANGEINDEX_hash(key,
+            (*rangeIndex)->bucketsCapacity)];
+
+    while(*bucket && (*bucket)->key != key)
+        bucket = &(*bucket)->next;
+    if(!(*bucket)) return;
+
+    // troca o item pelo último da lista
+    int count;
+    for(count=0; count < (*bucket)->size; count++){
+        if((*bucket)->items[count] == item){
+            (*bucket)->items[count] = (*bucket)->items[--(*bucket)->size];
+            break;
+        }
+    }
+
+    if((*bucket)->size) return;
+
+    Bucket* remove = (*bucket);
+    (*bucket) = remove->next;
+    free(remove->items);
+    free(remove);
+    (*rangeIndex)->bucketsSize--;
+}
+
+/**
+ * Adiciona ou retira um intervalo de todos os blocos que ele cruza
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param item Posição do intervalo no vetor de intervalos
+ * \param isRemove Se true, retira o intervalo. Caso contrário, adiciona
+ */
+int RANGEINDEX_modBuckets(RangeIndex** rangeIndex, int item, int isRemove){
+    Range* range = &(*rangeIndex)->ranges[item];
+    int level = range->level, row, column;
+
+    for(row = range->firstRow >> level; row <= range->lastRow >> level; row++){
+        for(column = range->firstColumn >> level; column <= range->lastColumn >> level;
+                column++){
+            if(isRemove)
+                RANGEINDEX_removeItem(&(*rangeIndex), RANGEINDEX_getKey(level, row, column),
+                        item);
+            else if(!RANGEINDEX_addItem(&(*rangeIndex), RANGEINDEX_getKey(level, row, column),
+                    item))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Procura um intervalo adicionado com as mesmas linhas e colunas
+ * \return Posição do intervalo no vetor de intervalos, ou -1 se não existir
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo, ou -1 para qualquer valor
+ */
+int RANGEINDEX_find(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value){
+    int level = RANGEINDEX_getLevel(lastRow-firstRow+1, lastColumn-firstColumn+1);
+
+    // o intervalo está no bloco do seu canto superior esquerdo
+    Bucket* bucket = RANGEINDEX_findBucket(&(*rangeIndex),
+            RANGEINDEX_getKey(level, firstRow >> level, firstColumn >> level));
+    if(!bucket) return -1;
+
+    Range* range;
+    int count;
+    for(count=0; count < bucket->size; count++){
+        range = &(*rangeIndex)->ranges[bucket->items[count]];
+
+        if((value == -1 || range->value == value) && range->firstRow == firstRow
+                && range->firstColumn == firstColumn && range->lastRow == lastRow
+                && range->lastColumn == lastColumn)
+            return bucket->items[count];
+    }
+
+    return -1;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Aloca índice de intervalos vazio
+ * \return Ponteiro para RangeIndex, ou NULL em caso de falha de alocação
+ */
+RangeIndex* RANGEINDEX_create(){
+    RangeIndex* rangeIndex = malloc(sizeof(RangeIndex));
+    if(!rangeIndex) return NULL;
+
+    rangeIndex->ranges = malloc(sizeof(Range)*INITIAL_RANGES);
+    rangeIndex->freeRanges = STACKINT_create();
+    rangeIndex->buckets = calloc(INITIAL_BUCKETS, sizeof(Bucket*));
+    rangeIndex->rangesSize = 0;
+    rangeIndex->rangesCapacity = INITIAL_RANGES;
+    rangeIndex->bucketsSize = 0;
+    rangeIndex->bucketsCapacity = INITIAL_BUCKETS;
+    rangeIndex->size = 0;
+
+    int count;
+    for(count=0; count < LEVELS; count++)
+        rangeIndex->levels[count] = 0;
+
+    if(!rangeIndex->ranges || !rangeIndex->freeRanges || !rangeIndex->buckets)
+        return RANGEINDEX_free(rangeIndex);
+
+    return rangeIndex;
+}
+
+/**
+ * Desaloca índice de intervalos
+ * \return NULL
+ * \param rangeIndex Ponteiro para RangeIndex
+ */
+RangeIndex* RANGEINDEX_free(RangeIndex* rangeIndex){
+    if(!rangeIndex) return NULL;
+
+    Bucket *bucket, *next;
+    int count;
+    if(rangeIndex->buckets){
+        for(count=0; count < rangeIndex->bucketsCapacity; count++){
+            for(bucket = rangeIndex->buckets[count]; bucket; bucket = next){
+                next = bucket->next;
+                free(bucket->items);
+                free(bucket);
+            }
+        }
+    }
+
+    free(rangeIndex->buckets);
+    free(rangeIndex->ranges);
+    rangeIndex->freeRanges = STACKINT_free(rangeIndex->freeRanges);
+    free(rangeIndex);
+    return NULL;
+}
+
+/**
+ * Adiciona um intervalo no índice. Linhas e colunas devem ser não negativas e
+ * menores que 2^24, com a primeira linha e coluna menores ou iguais às últimas
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo
+ * \param bound Limite inicial do intervalo (veja RANGEINDEX_raiseBounds)
+ * \param count Contagem inicial do intervalo (veja RANGEINDEX_addCounts)
+ */
+int RANGEINDEX_add(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int bound, int count){
+    if(!rangeIndex || !(*rangeIndex)) return 0;
+
+    int item;
+
+    // reaproveita uma posição livre ou usa o final do vetor
+    if(!STACKINT_isEmpty(&(*rangeIndex)->freeRanges))
+        item = STACKINT_pop(&(*rangeIndex)->freeRanges);
+    else{
+        if((*rangeIndex)->rangesSize == (*rangeIndex)->rangesCapacity){
+            Range* ranges = realloc((*rangeIndex)->ranges,
+                    sizeof(Range)*(*rangeIndex)->rangesCapacity*2);
+            if(!ranges) return 0;
+
+            (*rangeIndex)->ranges = ranges;
+            (*rangeIndex)->rangesCapacity *= 2;
+        }
+        item = (*rangeIndex)->rangesSize++;
+    }
+
+    Range* range = &(*rangeIndex)->ranges[item];
+    range->firstRow = firstRow;
+    range->firstColumn = firstColumn;
+    range->lastRow = lastRow;
+    range->lastColumn = lastColumn;
+    range->value = value;
+    range->bound = bound;
+    range->count = count;
+    range->level = RANGEINDEX_getLevel(lastRow-firstRow+1, lastColumn-firstColumn+1);
+
+    if(!RANGEINDEX_modBuckets(&(*rangeIndex), item, false)){
+        RANGEINDEX_modBuckets(&(*rangeIndex), item, true);
+        range->level = -1;
+        STACKINT_push(&(*rangeIndex)->freeRanges, item);
+        return 0;
+    }
+
+    (*rangeIndex)->levels[range->level]++;
+    (*rangeIndex)->size++;
+    return 1;
+}
+
+/**
+ * Remove do índice um intervalo adicionado com as mesmas linhas, colunas e valor
+ * \return 1 se o intervalo foi encontrado e removido, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo
+ */
+int RANGEINDEX_remove(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value){
+    if(!rangeIndex || !(*rangeIndex)) return 0;
+
+    int item = RANGEINDEX_find(&(*rangeIndex), firstRow, firstColumn, lastRow, lastColumn,
+            value);
+    if(item == -1) return 0;
+
+    Range* range = &(*rangeIndex)->ranges[item];
+    RANGEINDEX_modBuckets(&(*rangeIndex), item, true);
+    (*rangeIndex)->levels[range->level]--;
+    (*rangeIndex)->size--;
+    range->level = -1;
+    STACKINT_push(&(*rangeIndex)->freeRanges, item);
+    return 1;
+}
+
+/**
+ * Procura os intervalos que contêm uma célula, colocando o valor de cada um na
+ * pilha informada (um valor para cada intervalo encontrado)
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param values Ponteiro duplo para a pilha que receberá os valores
+ */
+void RANGEINDEX_query(RangeIndex** rangeIndex, int row, int column, StackInt** values){
+    if(!rangeIndex || !(*rangeIndex) || !(*rangeIndex)->size) return;
+
+    Bucket* bucket;
+    Range* range;
+    int level, count;
+
+    // a célula pertence a um único bloco em cada nível
+    for(level=0; level < LEVELS; level++){
+        if(!(*rangeIndex)->levels[level]) continue;
+
+        bucket = RANGEINDEX_findBucket(&(*rangeIndex),
+                RANGEINDEX_getKey(level, row >> level, column >> level));
+        if(!bucket) continue;
+
+        for(count=0; count < bucket->size; count++){
+            range = &(*rangeIndex)->ranges[bucket->items[count]];
+            if(range->firstRow <= row && row <= range->lastRow
+                    && range->firstColumn <= column && column <= range->lastColumn)
+                STACKINT_push(&(*values), range->value);
+        }
+    }
+}
+
+/**
+ * Obtém o limite de um intervalo adicionado com as mesmas linhas e colunas
+ * \return 1 se o intervalo foi encontrado, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo, ou -1 para qualquer valor
+ * \param bound Variável a ser preenchida com o limite do intervalo
+ */
+int RANGEINDEX_getBound(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int* bound){
+    if(!rangeIndex || !(*rangeIndex)) return 0;
+
+    int item = RANGEINDEX_find(&(*rangeIndex), firstRow, firstColumn, lastRow, lastColumn,
+            value);
+    if(item == -1) return 0;
+
+    (*bound) = (*rangeIndex)->ranges[item].bound;
+    return 1;
+}
+
+/**
+ * Aumenta até bound o limite de todos os intervalos que contêm uma célula
+ * (intervalos com limite maior não mudam)
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param bound Novo limite
+ */
+void RANGEINDEX_raiseBounds(RangeIndex** rangeIndex, int row, int column, int bound){
+    if(!rangeIndex || !(*rangeIndex) || !(*rangeIndex)->size) return;
+
+    Bucket* bucket;
+    Range* range;
+    int level, count;
+
+    for(level=0; level < LEVELS; level++){
+        if(!(*rangeIndex)->levels[level]) continue;
+
+        bucket = RANGEINDEX_findBucket(&(*rangeIndex),
+                RANGEINDEX_getKey(level, row >> level, column >> level));
+        if(!bucket) continue;
+
+        for(count=0; count < bucket->size; count++){
+            range = &(*rangeIndex)->ranges[bucket->items[count]];
+            if(range->bound < bound && range->firstRow <= row && row <= range->lastRow
+                    && range->firstColumn <= column && column <= range->lastColumn)
+                range->bound = bound;
+        }
+    }
+}
+
+/**
+ * Altera o limite de todos os intervalos do índice
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param bound Novo limite
+ */
+void RANGEINDEX_resetBounds(RangeIndex** rangeIndex, int bound){
+    if(!rangeIndex || !(*rangeIndex)) return;
+
+    int count;
+    for(count=0; count < (*rangeIndex)->rangesSize; count++)
+        (*rangeIndex)->ranges[count].bound = bound;
+}
+
+/**
+ * Obtém a contagem de um intervalo adicionado com as mesmas linhas e colunas
+ * \return 1 se o intervalo foi encontrado, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo, ou -1 para qualquer valor
+ * \param count Variável a ser preenchida com a contagem do intervalo
+ */
+int RANGEINDEX_getCount(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int* count){
+    if(!rangeIndex || !(*rangeIndex)) return 0;
+
+    int item = RANGEINDEX_find(&(*rangeIndex), firstRow, firstColumn, lastRow, lastColumn,
+            value);
+    if(item == -1) return 0;
+
+    (*count) = (*rangeIndex)->ranges[item].count;
+    return 1;
+}
+
+/**
+ * Soma uma quantidade à contagem de todos os intervalos que contêm uma célula
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param amount Quantidade somada (negativa para subtrair)
+ */
+void RANGEINDEX_addCounts(RangeIndex** rangeIndex, int row, int column, int amount){
+    if(!rangeIndex || !(*rangeIndex) || !(*rangeIndex)->size) return;
+
+    Bucket* bucket;
+    Range* range;
+    int level, count;
+
+    for(level=0; level < LEVELS; level++){
+        if(!(*rangeIndex)->levels[level]) continue;
+
+        bucket = RANGEINDEX_findBucket(&(*rangeIndex),
+                RANGEINDEX_getKey(level, row >> level, column >> level));
+        if(!bucket) continue;
+
+        for(count=0; count < bucket->size; count++){
+            range = &(*rangeIndex)->ranges[bucket->items[count]];
+            if(range->firstRow <= row && row <= range->lastRow
+                    && range->firstColumn <= column && column <= range->lastColumn)
+                range->count += amount;
+        }
+    }
+}
+
+/**
+ * Zera a contagem de todos os intervalos do índice
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ */
+void RANGEINDEX_resetCounts(RangeIndex** rangeIndex){
+    if(!rangeIndex || !(*rangeIndex)) return;
+
+    int count;
+    for(count=0; count < (*rangeIndex)->rangesSize; count++)
+        (*rangeIndex)->ranges[count].count = 0;
+}
+
+/**
+ * Obtém a quantidade de intervalos no índice
+ * \return Quantidade de intervalos
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ */
+int RANGEINDEX_getSize(RangeIndex** rangeIndex){
+    if(!rangeIndex || !(*rangeIndex)) return 0;
+
+    return (*rangeIndex)->size;
+}
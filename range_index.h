@@ -0,0 +1,144 @@
+/**
+ * \file range_index.h
+ * Índice de intervalos retangulares de células. Cada intervalo guarda um valor
+ * (a célula que depende dele) e pode ser encontrado a partir de qualquer célula
+ * que ele contém, sem percorrer todas as células do intervalo. Cada intervalo
+ * guarda também um limite, que só aumenta a partir das células que ele contém
+ * (como a maior posição delas em uma ordem) e uma contagem, atualizada a partir
+ * das células que ele contém (como a quantidade delas em algum estado)
+ */
+
+#ifndef RANGE_INDEX_H_
+#define RANGE_INDEX_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "stack_int.h"
+
+/**
+ * Estrutura do índice de intervalos
+ */
+typedef struct rangeIndex RangeIndex;
+
+/**
+ * Aloca índice de intervalos vazio
+ * \return Ponteiro para RangeIndex, ou NULL em caso de falha de alocação
+ */
+RangeIndex* RANGEINDEX_create();
+
+/**
+ * Desaloca índice de intervalos
+ * \return NULL
+ * \param rangeIndex Ponteiro para RangeIndex
+ */
+RangeIndex* RANGEINDEX_free(RangeIndex* rangeIndex);
+
+/**
+ * Adiciona um intervalo no índice. Linhas e colunas devem ser não negativas e
+ * menores que 2^24, com a primeira linha e coluna menores ou iguais às últimas
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo
+ * \param bound Limite inicial do intervalo (veja RANGEINDEX_raiseBounds)
+ * \param count Contagem inicial do intervalo (veja RANGEINDEX_addCounts)
+ */
+int RANGEINDEX_add(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int bound, int count);
+
+/**
+ * Remove do índice um intervalo adicionado com as mesmas linhas, colunas e valor
+ * \return 1 se o intervalo foi encontrado e removido, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo
+ */
+int RANGEINDEX_remove(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value);
+
+/**
+ * Procura os intervalos que contêm uma célula, colocando o valor de cada um na
+ * pilha informada (um valor para cada intervalo encontrado)
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param values Ponteiro duplo para a pilha que receberá os valores
+ */
+void RANGEINDEX_query(RangeIndex** rangeIndex, int row, int column, StackInt** values);
+
+/**
+ * Obtém o limite de um intervalo adicionado com as mesmas linhas e colunas
+ * \return 1 se o intervalo foi encontrado, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo, ou -1 para qualquer valor
+ * \param bound Variável a ser preenchida com o limite do intervalo
+ */
+int RANGEINDEX_getBound(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int* bound);
+
+/**
+ * Aumenta até bound o limite de todos os intervalos que contêm uma célula
+ * (intervalos com limite maior não mudam)
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param bound Novo limite
+ */
+void RANGEINDEX_raiseBounds(RangeIndex** rangeIndex, int row, int column, int bound);
+
+/**
+ * Altera o limite de todos os intervalos do índice
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param bound Novo limite
+ */
+void RANGEINDEX_resetBounds(RangeIndex** rangeIndex, int bound);
+
+/**
+ * Obtém a contagem de um intervalo adicionado com as mesmas linhas e colunas
+ * \return 1 se o intervalo foi encontrado, 0 em caso contrário
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param firstRow Primeira linha do intervalo
+ * \param firstColumn Primeira coluna do intervalo
+ * \param lastRow Última linha do intervalo
+ * \param lastColumn Última coluna do intervalo
+ * \param value Valor associado ao intervalo, ou -1 para qualquer valor
+ * \param count Variável a ser preenchida com a contagem do intervalo
+ */
+int RANGEINDEX_getCount(RangeIndex** rangeIndex, int firstRow, int firstColumn, int lastRow,
+        int lastColumn, int value, int* count);
+
+/**
+ * Soma uma quantidade à contagem de todos os intervalos que contêm uma célula
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ * \param row Linha da célula
+ * \param column Coluna da célula
+ * \param amount Quantidade somada (negativa para subtrair)
+ */
+void RANGEINDEX_addCounts(RangeIndex** rangeIndex, int row, int column, int amount);
+
+/**
+ * Zera a contagem de todos os intervalos do índice
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ */
+void RANGEINDEX_resetCounts(RangeIndex** rangeIndex);
+
+/**
+ * Obtém a quantidade de intervalos no índice
+ * \return Quantidade de intervalos
+ * \param rangeIndex Ponteiro duplo para RangeIndex
+ */
+int RANGEINDEX_getSize(RangeIndex** rangeIndex);
+
+#endif /* RANGE_INDEX_H_ */
@@ -0,0 +1,402 @@
+/**
+ * \file reduction.c
+ * Implementação do arquivo reduction.h
+ */
+
+#include "reduction.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define REDUCTION_SIMD
+#include <immintrin.h>
+#endif
+
+/********************************************************************************
+ * Estruturas
+ ********************************************************************************/
+
+/**
+ * Conjunto de funções de redução de um conjunto de instruções
+ */
+typedef struct kernels Kernels;
+struct kernels{
+    const char* name;
+    void (*sum)(const double*, int, double*, double*);
+    double (*max)(const double*, int, double);
+    double (*min)(const double*, int, double);
+};
+
+/********************************************************************************
+ * Funções privadas
+ ********************************************************************************/
+
+/**
+ * Valor absoluto (sem depender da libm)
+ * \return Valor absoluto de value
+ * \param value Valor
+ */
+static inline double REDUCTION_abs(double value){
+    return (value < 0 ? -value : value);
+}
+
+/**
+ * Soma compensada sem instruções vetoriais
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param sum Soma parcial
+ * \param compensation Compensação da soma parcial
+ */
+void REDUCTION_sumScalar(const double* values, int size, double* sum, double* compensation){
+    int count;
+    for(count=0; count < size; count++)
+        REDUCTION_add(values[count], &(*sum), &(*compensation));
+}
+
+/**
+ * Maior valor sem instruções vetoriais
+ * \return O maior entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+double REDUCTION_maxScalar(const double* values, int size, double initial){
+    int count;
+    for(count=0; count < size; count++)
+        if(values[count] > initial)
+            initial = values[count];
+
+    return initial;
+}
+
+/**
+ * Menor valor sem instruções vetoriais
+ * \return O menor entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+double REDUCTION_minScalar(const double* values, int size, double initial){
+    int count;
+    for(count=0; count < size; count++)
+        if(values[count] < initial)
+            initial = values[count];
+
+    return initial;
+}
+
+#ifdef REDUCTION_SIMD
+
+/**
+ * Soma compensada com SSE2: cada uma das 2 posições do registrador guarda sua
+ * própria soma e compensação, juntadas no final
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param sum Soma parcial
+ * \param compensation Compensação da soma parcial
+ */
+void REDUCTION_sumSSE2(const double* values, int size, double* sum, double* compensation){
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d lanes = _mm_setzero_pd();
+    __m128d lanesCompensation = _mm_setzero_pd();
+    __m128d value, total, bigger, error;
+
+    int count;
+    for(count=0; count+2 <= size; count+=2){
+        value = _mm_loadu_pd(&values[count]);
+        total = _mm_add_pd(lanes, value);
+
+        // |lanes| >= |value| escolhe (lanes - total) + value, senão (value - total) + lanes
+        bigger = _mm_cmpge_pd(_mm_andnot_pd(signMask, lanes), _mm_andnot_pd(signMask, value));
+        error = _mm_or_pd(
+                _mm_and_pd(bigger, _mm_add_pd(_mm_sub_pd(lanes, total), value)),
+                _mm_andnot_pd(bigger, _mm_add_pd(_mm_sub_pd(value, total), lanes)));
+
+        lanesCompensation = _mm_add_pd(lanesCompensation, error);
+        lanes = total;
+    }
+
+    double partial[2], partialCompensation[2];
+    _mm_storeu_pd(partial, lanes);
+    _mm_storeu_pd(partialCompensation, lanesCompensation);
+
+    int lane;
+    for(lane=0; lane < 2; lane++){
+        REDUCTION_add(partial[lane], &(*sum), &(*compensation));
+        (*compensation) += partialCompensation[lane];
+    }
+
+    REDUCTION_sumScalar(&values[count], size-count, &(*sum), &(*compensation));
+}
+
+/**
+ * Maior valor com SSE2
+ * \return O maior entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+double REDUCTION_maxSSE2(const double* values, int size, double initial){
+    __m128d lanes = _mm_set1_pd(initial);
+
+    int count;
+    // maxpd devolve o segundo operando quando a comparação falha, como o laço escalar
+    for(count=0; count+2 <= size; count+=2)
+        lanes = _mm_max_pd(_mm_loadu_pd(&values[count]), lanes);
+
+    double partial[2];
+    _mm_storeu_pd(partial, lanes);
+
+    initial = REDUCTION_maxScalar(partial, 2, initial);
+    return REDUCTION_maxScalar(&values[count], size-count, initial);
+}
+
+/**
+ * Menor valor com SSE2
+ * \return O menor entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+double REDUCTION_minSSE2(const double* values, int size, double initial){
+    __m128d lanes = _mm_set1_pd(initial);
+
+    int count;
+    for(count=0; count+2 <= size; count+=2)
+        lanes = _mm_min_pd(_mm_loadu_pd(&values[count]), lanes);
+
+    double partial[2];
+    _mm_storeu_pd(partial, lanes);
+
+    initial = REDUCTION_minScalar(partial, 2, initial);
+    return REDUCTION_minScalar(&values[count], size-count, initial);
+}
+
+/**
+ * Soma compensada com AVX2 (4 posições por registrador)
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param sum Soma parcial
+ * \param compensation Compensação da soma parcial
+ */
+__attribute__((target("avx2")))
+void REDUCTION_sumAVX2(const double* values, int size, double* sum, double* compensation){
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d lanes = _mm256_setzero_pd();
+    __m256d lanesCompensation = _mm256_setzero_pd();
+    __m256d value, total, bigger, error;
+
+    int count;
+    for(count=0; count+4 <= size; count+=4){
+        value = _mm256_loadu_pd(&values[count]);
+        total = _mm256_add_pd(lanes, value);
+
+        bigger = _mm256_cmp_pd(_mm256_andnot_pd(signMask, lanes),
+                _mm256_andnot_pd(signMask, value), _CMP_GE_OQ);
+        error = _mm256_blendv_pd(
+                _mm256_add_pd(_mm256_sub_pd(value, total), lanes),
+                _mm256_add_pd(_mm256_sub_pd(lanes, total), value), bigger);
+
+        lanesCompensation = _mm256_add_pd(lanesCompensation, error);
+        lanes = total;
+    }
+
+    double partial[4], partialCompensation[4];
+    _mm256_storeu_pd(partial, lanes);
+    _mm256_storeu_pd(partialCompensation, lanesCompensation);
+
+    int lane;
+    for(lane=0; lane < 4; lane++){
+        REDUCTION_add(partial[lane], &(*sum), &(*compensation));
+        (*compensation) += partialCompensation[lane];
+    }
+
+    REDUCTION_sumScalar(&values[count], size-count, &(*sum), &(*compensation));
+}
+
+/**
+ * Maior valor com AVX2
+ * \return O maior entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+__attribute__((target("avx2")))
+double REDUCTION_maxAVX2(const double* values, int size, double initial){
+    __m256d lanes = _mm256_set1_pd(initial);
+
+    int count;
+    for(count=0; count+4 <= size; count+=4)
+        lanes = _mm256_max_pd(_mm256_loadu_pd(&values[count]), lanes);
+
+    double partial[4];
+    _mm256_storeu_pd(partial, lanes);
+
+    initial = REDUCTION_maxScalar(partial, 4, initial);
+    return REDUCTION_maxScalar(&values[count], size-count, initial);
+}
+
+/**
+ * Menor valor com AVX2
+ * \return O menor entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial
+ */
+__attribute__((target("avx2")))
+double REDUCTION_minAVX2(const double* values, int size, double initial){
+    __m256d lanes = _mm256_set1_pd(initial);
+
+    int count;
+    for(count=0; count+4 <= size; count+=4)
+        lanes = _mm256_min_pd(_mm256_loadu_pd(&values[count]), lanes);
+
+    double partial[4];
+    _mm256_storeu_pd(partial, lanes);
+
+    initial = REDUCTION_minScalar(partial, 4, initial);
+    return REDUCTION_minScalar(&values[count], size-count, initial);
+}
+
+#endif /* REDUCTION_SIMD */
+
+/**
+ * Conjuntos de funções de redução, do mais lento para o mais rápido
+ */
+static const Kernels kernelSets[] = {
+    {"scalar", REDUCTION_sumScalar, REDUCTION_maxScalar, REDUCTION_minScalar},
+#ifdef REDUCTION_SIMD
+    {"sse2", REDUCTION_sumSSE2, REDUCTION_maxSSE2, REDUCTION_minSSE2},
+    {"avx2", REDUCTION_sumAVX2, REDUCTION_maxAVX2, REDUCTION_minAVX2},
+#endif
+};
+
+/**
+ * Conjunto de funções em uso (NULL até a primeira redução)
+ */
+static const Kernels* kernels = NULL;
+
+/**
+ * Verifica se o processador executa um conjunto de funções de redução
+ * \return 1 em caso positivo, 0 em caso contrário
+ * \param set Conjunto de funções
+ */
+int REDUCTION_isSupported(const Kernels* set){
+#ifdef REDUCTION_SIMD
+    __builtin_cpu_init();
+    if(strcmp(set->name, "sse2")==0) return __builtin_cpu_supports("sse2");
+    if(strcmp(set->name, "avx2")==0) return __builtin_cpu_supports("avx2");
+#endif
+    return 1;
+}
+
+/**
+ * Escolhe as funções de redução do melhor conjunto de instruções disponível
+ * no processador (feito uma única vez)
+ * \return Ponteiro para as funções escolhidas
+ */
+const Kernels* REDUCTION_getKernels(){
+    if(kernels) return kernels;
+
+    // a escolha é publicada de uma só vez: threads que chegarem aqui juntas
+    // nunca veem um conjunto intermediário
+    const Kernels* chosen = &kernelSets[0];
+    int count;
+    for(count=1; count < (int) (sizeof(kernelSets)/sizeof(kernelSets[0])); count++)
+        if(REDUCTION_isSupported(&kernelSets[count]))
+            chosen = &kernelSets[count];
+
+    kernels = chosen;
+    return kernels;
+}
+
+/********************************************************************************
+ * Funções públicas
+ ********************************************************************************/
+
+/**
+ * Adiciona um valor à soma compensada (um passo de Neumaier)
+ * \param value Valor a ser somado
+ * \param sum Soma parcial
+ * \param compensation Compensação da soma parcial
+ */
+void REDUCTION_add(double value, double* sum, double* compensation){
+    double total = (*sum) + value;
+
+    if(REDUCTION_abs(*sum) >= REDUCTION_abs(value))
+        (*compensation) += ((*sum) - total) + value;
+    else
+        (*compensation) += (value - total) + (*sum);
+
+    (*sum) = total;
+}
+
+/**
+ * Soma os valores do vetor a uma soma parcial, com compensação de Neumaier (o
+ * erro de arredondamento de cada adição fica guardado em compensation)
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param sum Soma parcial, atualizada com os valores
+ * \param compensation Compensação da soma parcial, atualizada com os valores (o
+ * resultado final é sum + compensation)
+ */
+void REDUCTION_sum(const double* values, int size, double* sum, double* compensation){
+    if(!values || size <= 0) return;
+
+    REDUCTION_getKernels()->sum(values, size, &(*sum), &(*compensation));
+}
+
+/**
+ * Procura o maior valor do vetor
+ * \return O maior entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial (o maior valor já encontrado)
+ */
+double REDUCTION_max(const double* values, int size, double initial){
+    if(!values || size <= 0) return initial;
+
+    return REDUCTION_getKernels()->max(values, size, initial);
+}
+
+/**
+ * Procura o menor valor do vetor
+ * \return O menor entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial (o menor valor já encontrado)
+ */
+double REDUCTION_min(const double* values, int size, double initial){
+    if(!values || size <= 0) return initial;
+
+    return REDUCTION_getKernels()->min(values, size, initial);
+}
+
+/**
+ * Obtém o nome do conjunto de instruções usado pelas reduções
+ * \return "avx2", "sse2" ou "scalar"
+ */
+const char* REDUCTION_getInstructionSet(){
+    return REDUCTION_getKernels()->name;
+}
+
+/**
+ * Troca o conjunto de instruções usado pelas reduções (para comparar os
+ * conjuntos em bench_reduction.c). Não deve ser chamada durante um recálculo
+ * em várias threads
+ * \return 1 em caso de sucesso, 0 se o conjunto não existir ou o processador
+ * não o executar
+ * \param name "avx2", "sse2" ou "scalar"
+ */
+int REDUCTION_setInstructionSet(const char* name){
+    if(!name) return 0;
+
+    int count;
+    for(count=0; count < (int) (sizeof(kernelSets)/sizeof(kernelSets[0])); count++){
+        if(strcmp(kernelSets[count].name, name)==0
+                && REDUCTION_isSupported(&kernelSets[count])){
+            kernels = &kernelSets[count];
+            return 1;
+        }
+    }
+
+    return 0;
+}
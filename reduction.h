@@ -0,0 +1,68 @@
+/**
+ * \file reduction.h
+ * Reduções sobre vetores contíguos de doubles (soma compensada, máximo e mínimo).
+ * Usa instruções SSE2 e, quando o processador permite, AVX2, escolhidas na
+ * primeira chamada
+ */
+
+#ifndef REDUCTION_H_
+#define REDUCTION_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Adiciona um valor à soma compensada (um passo de Neumaier)
+ * \param value Valor a ser somado
+ * \param sum Soma parcial
+ * \param compensation Compensação da soma parcial
+ */
+void REDUCTION_add(double value, double* sum, double* compensation);
+
+/**
+ * Soma os valores do vetor a uma soma parcial, com compensação de Neumaier (o
+ * erro de arredondamento de cada adição fica guardado em compensation)
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param sum Soma parcial, atualizada com os valores
+ * \param compensation Compensação da soma parcial, atualizada com os valores (o
+ * resultado final é sum + compensation)
+ */
+void REDUCTION_sum(const double* values, int size, double* sum, double* compensation);
+
+/**
+ * Procura o maior valor do vetor
+ * \return O maior entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial (o maior valor já encontrado)
+ */
+double REDUCTION_max(const double* values, int size, double initial);
+
+/**
+ * Procura o menor valor do vetor
+ * \return O menor entre initial e os valores do vetor
+ * \param values Vetor de valores
+ * \param size Quantidade de valores
+ * \param initial Valor inicial (o menor valor já encontrado)
+ */
+double REDUCTION_min(const double* values, int size, double initial);
+
+/**
+ * Obtém o nome do conjunto de instruções usado pelas reduções
+ * \return "avx2", "sse2" ou "scalar"
+ */
+const char* REDUCTION_getInstructionSet();
+
+/**
+ * Troca o conjunto de instruções usado pelas reduções (para comparar os
+ * conjuntos em bench_reduction.c). Não deve ser chamada durante um recálculo
+ * em várias threads
+ * \return 1 em caso de sucesso, 0 se o conjunto não existir ou o processador
+ * não o executar
+ * \param name "avx2", "sse2" ou "scalar"
+ */
+int REDUCTION_setInstructionSet(const char* name);
+
+#endif /* REDUCTION_H_ */
@@ -0,0 +1,148 @@
+/**
+ * \file reference.c
+ * Implementação do arquivo reference.h
+ */
+
+#include "reference.h"
+
+// classes de caractere
+#define CLASS_NUMBER 1
+#define CLASS_CAP_LETTER 2
+#define CLASS_LETTER 4
+#define CLASS_OPERATOR 8
+
+// quantidade de letras do alfabeto (base das colunas)
+#define ALPHABET_SIZE 26
+
+/****************************************************************************
+ * Tabelas
+ ****************************************************************************/
+
+// classe de cada caractere (combinação de CLASS_*)
+static const unsigned char CLASSES[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  8,  8,  0,  8,  0,  8,
+     1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,  0,  0,
+     0,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+     2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  0,  0,  0,  0,  0,
+     0,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,
+     4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+// valor de cada letra na coluna (0 se não for letra)
+static const unsigned char LETTERS[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,  0,  0,  0,  0,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+// valor de cada dígito mais um (0 se não for dígito)
+static const unsigned char DIGITS[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     1,  2,  3,  4,  5,  6,  7,  8,  9, 10,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+/****************************************************************************
+ * Funções públicas
+ ****************************************************************************/
+
+/**
+ * Verifica se um caractere é número
+ * \return Um valor diferente de 0 se for número, 0 em caso contrário
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsNumber(char value){
+    return CLASSES[(unsigned char) value] & CLASS_NUMBER;
+}
+
+/**
+ * Verifica se um caractere é letra do alfabeto
+ * \return 0 se não for letra de alfabeto, 1 se for letra maiúscula e
+ * 2 se for letra minúscula
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsAlpha(char value){
+    return (CLASSES[(unsigned char) value] & (CLASS_CAP_LETTER | CLASS_LETTER)) >> 1;
+}
+
+/**
+ * Verifica se um caractere é um operador (+, -, * ou /)
+ * \return Um valor diferente de 0 se for um operador, 0 em caso contrário
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsOperator(char value){
+    return CLASSES[(unsigned char) value] & CLASS_OPERATOR;
+}
+
+/**
+ * Lê uma referência no início do texto: uma ou mais letras (a coluna, em que
+ * A é 1, Z é 26 e AA é 27, sem diferenciar maiúsculas e minúsculas) seguidas
+ * de um ou mais dígitos (a linha)
+ * \return Quantidade de caracteres da referência, ou 0 se o texto não começar
+ * com uma referência
+ * \param text Texto que contém a referência
+ * \param row Variável a ser preenchida com a linha da referência
+ * \param column Variável a ser preenchida com a coluna da referência
+ */
+int REFERENCE_read(const char* text, int* row, int* column){
+    const unsigned char* current = (const unsigned char*) text;
+    long long value = 0;
+    int letter, digit, letters;
+
+    // converte as letras em coluna (base 26 sem zero)
+    while((letter = LETTERS[*current])){
+        value = value*ALPHABET_SIZE + letter;
+        if(value > REFERENCE_MAX) value = REFERENCE_MAX;
+        current++;
+    }
+    letters = current - (const unsigned char*) text;
+    if(!letters || !DIGITS[*current]) return 0;
+    (*column) = value;
+
+    // converte os dígitos em linha
+    value = 0;
+    while((digit = DIGITS[*current])){
+        value = value*10 + digit - 1;
+        if(value > REFERENCE_MAX) value = REFERENCE_MAX;
+        current++;
+    }
+    (*row) = value;
+
+    return current - (const unsigned char*) text;
+}
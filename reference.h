@@ -0,0 +1,54 @@
+/**
+ * \file reference.h
+ * Decodificação das referências de células ('A2', 'AB1048576') e classificação
+ * dos caracteres das expressões, compartilhadas pela validação e pela
+ * compilação das expressões
+ */
+
+#ifndef REFERENCE_H_
+#define REFERENCE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Maior linha ou coluna que uma referência pode representar. Valores maiores
+ * são saturados nesse limite
+ */
+#define REFERENCE_MAX 1073741824
+
+/**
+ * Verifica se um caractere é número
+ * \return Um valor diferente de 0 se for número, 0 em caso contrário
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsNumber(char value);
+
+/**
+ * Verifica se um caractere é letra do alfabeto
+ * \return 0 se não for letra de alfabeto, 1 se for letra maiúscula e
+ * 2 se for letra minúscula
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsAlpha(char value);
+
+/**
+ * Verifica se um caractere é um operador (+, -, * ou /)
+ * \return Um valor diferente de 0 se for um operador, 0 em caso contrário
+ * \param value Caractere a ser testado
+ */
+int REFERENCE_charIsOperator(char value);
+
+/**
+ * Lê uma referência no início do texto: uma ou mais letras (a coluna, em que
+ * A é 1, Z é 26 e AA é 27, sem diferenciar maiúsculas e minúsculas) seguidas
+ * de um ou mais dígitos (a linha)
+ * \return Quantidade de caracteres da referência, ou 0 se o texto não começar
+ * com uma referência
+ * \param text Texto que contém a referência
+ * \param row Variável a ser preenchida com a linha da referência
+ * \param column Variável a ser preenchida com a coluna da referência
+ */
+int REFERENCE_read(const char* text, int* row, int* column);
+
+#endif /* REFERENCE_H_ */
@@ -114,27 +114,22 @@ void SAVE_save(SaveFile** save, Matrix** matrix){
     // guarda string de data no nó
     mxmlElementSetAttr(node,"date", dateString);
 
-    // pega quantidade de linhas e colunas de células
-    int rows = MATRIX_getRows(&(*matrix)), columns = MATRIX_getColumns(&(*matrix));
-
-    // guarda expressão
-    char expression[70];
+    // guarda expressão (texto da própria matriz, sem cópia)
+    const char* expression;
 
     // guarda filho do nó relativo ao espaço de trabalho
     mxml_node_t* child;
 
-    // percorre matriz e guarda expressões nas células alocadas
-    int countRow, countColumn;
-    for(countRow=1; countRow <= rows; countRow++){
-        for(countColumn=1; countColumn<= columns; countColumn++){
-            MATRIX_getExpression(&(*matrix), countRow, countColumn, expression);
-            // se a expressão é não vazia, cria novo filho no nó
-            if(strcmp(expression,"")!=0){
-                child = mxmlNewElement(node, "cell");
-                mxmlElementSetAttrf(child, "row", "%d",countRow);
-                mxmlElementSetAttrf(child, "column", "%d",countColumn);
-                mxmlElementSetAttr(child, "expression", expression);
-            }
+    // percorre as células alocadas da matriz e guarda suas expressões
+    int countRow = 0, countColumn = 0;
+    while(MATRIX_nextCell(&(*matrix), &countRow, &countColumn)){
+        expression = MATRIX_getExpression(&(*matrix), countRow, countColumn);
+        // se a expressão é não vazia, cria novo filho no nó
+        if(strcmp(expression,"")!=0){
+            child = mxmlNewElement(node, "cell");
+            mxmlElementSetAttrf(child, "row", "%d",countRow);
+            mxmlElementSetAttrf(child, "column", "%d",countColumn);
+            mxmlElementSetAttr(child, "expression", expression);
         }
     }
 
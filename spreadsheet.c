@@ -49,6 +49,9 @@
 #define OPTION_INSERT_EXPRESSION "Inserir expressao"
 #define OPTION_UNDO "Desfazer ultima operacao"
 #define OPTION_REDO "Refazer ultima operacao"
+#define OPTION_RECALC "Recalcular planilha"
+#define OPTION_MANUAL "Usar calculo manual"
+#define OPTION_AUTOMATIC "Usar calculo automatico"
 #define OPTION_SAVE "Salvar espaco de trabalho"
 #define OPTION_EXIT "Sair"
 
@@ -60,6 +63,16 @@
 #define ROW 1
 #define COLUMN 1
 
+// se verdadeiro, as alterações apenas marcam as células dependentes, que são
+// calculadas quando aparecem no gráfico
+#define LAZY_RECALC false
+
+// limites do histórico de desfazer/refazer (itens e memória em bytes)
+#define UNDO_MAX_ENTRIES 1000
+#define UNDO_MAX_BYTES (256*1024)
+// quantidade máxima de células cujos valores são guardados por alteração
+#define UNDO_SNAPSHOT_CELLS 2048
+
 /*******************************************************************************
  * Funções privadas
  *******************************************************************************/
@@ -73,25 +86,21 @@ void SPREADSHEET_updateGraphicCells(Matrix** matrix, GraphicCells** graphic){
 
     if(!matrix || !(*matrix) || !graphic || !(*graphic)) return;
 
-    // guarda linha e coluna
-    int row, column;
+    // guarda linha e coluna (começa antes da primeira célula)
+    int row = 0, column = 0;
     // guarda valor da célula
     double value;
     // guarda expressão da célula
-    char expression[70];
-
-    // total de linhas e colunas
-    int rows = MATRIX_getRows(&(*matrix)), columns = MATRIX_getColumns(&(*matrix));
-
-    for(row=1 ; row <= rows ; row++){
-        for(column=1 ; column <= columns ; column++){
-            // pega expressão da célula
-            MATRIX_getExpression(&(*matrix), row, column, expression);
-            // se expressão não vazia, atualiza gráfico
-            if(strcmp(expression,"")!=0){
-                value = MATRIX_getValue(&(*matrix), row, column);
-                GRAPHICSCELLS_updateCell(&(*graphic), row, column, value, KEEP_MARK, false);
-            }
+    const char* expression;
+
+    // percorre apenas as células alocadas
+    while(MATRIX_nextCell(&(*matrix), &row, &column)){
+        // pega expressão da célula
+        expression = MATRIX_getExpression(&(*matrix), row, column);
+        // se expressão não vazia, atualiza gráfico
+        if(strcmp(expression,"")!=0){
+            value = MATRIX_getValue(&(*matrix), row, column);
+            GRAPHICSCELLS_updateCell(&(*graphic), row, column, value, KEEP_MARK, false);
         }
     }
 }
@@ -117,22 +126,16 @@ void SPREADSHEET_changeExpression(Matrix** matrix, int currentRow, int currentCo
             || !(*graphic_select) || !graphic_user || !(*graphic_user)
             || !undoRedo || !(*undoRedo)) return;
 
-    // guarda a entrada do usuário
-    char userText[70];
+    // guarda a entrada do usuário (de qualquer tamanho)
+    char* userText;
     // guarda a opção escolhida
     char option[30];
 
-    // guarda expressão atual
-    char expression[70];
-
     // controla loop principal da função
     int mainLoop = true;
 
     while(mainLoop){
 
-        // pega expressão atual
-        MATRIX_getExpression(&(*matrix), currentRow, currentColumn, expression);
-
         // pede para o usuário digitar uma expressão ou digitar 00 para cancelar
         GRAPHICINST_clear(&(*graphic_instructions));
         GRAPHICINST_write(&(*graphic_instructions),
@@ -161,7 +164,8 @@ void SPREADSHEET_changeExpression(Matrix** matrix, int currentRow, int currentCo
 
         // Abre entrada do usuário
         GRAPHICUSER_clear(&(*graphic_user));
-        GRAPHICUSER_get(&(*graphic_user), userText, COLUMN*1, ROW*1);
+        userText = GRAPHICUSER_getLine(&(*graphic_user), COLUMN*1, ROW*1);
+        if(!userText) return;
 
         // escolheu 00?
         if(strcmp(userText, "00")==0){
@@ -212,6 +216,10 @@ void SPREADSHEET_changeExpression(Matrix** matrix, int currentRow, int currentCo
                     GRAPHICINST_clear(&(*graphic_instructions));
                     GRAPHICINST_write(&(*graphic_instructions), "Expressao definida com sucesso",
                             COLUMN*1, ROW*1);
+                    if(MATRIX_isManual(&(*matrix)) && MATRIX_getStaleCells(&(*matrix)))
+                        GRAPHICINST_write(&(*graphic_instructions),
+                                "  Celulas marcadas com ~ aguardam o recalculo da planilha",
+                                COLUMN*1, ROW*2);
 
                     // espera 1 segundo
                     sleep(1);
@@ -223,6 +231,8 @@ void SPREADSHEET_changeExpression(Matrix** matrix, int currentRow, int currentCo
             else
                 sleep(2);
         }
+
+        free(userText);
     }
 
     // limpa janelas
@@ -252,7 +262,7 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
     char option[30];
 
     // guarda expressão da célula atual
-    char expression[70];
+    const char* expression;
 
     // controla loop principal
     int mainLoop = true;
@@ -329,8 +339,13 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
         SPREADSHEET_updateGraphicCells(&newMatrix,&graphic_cells);
     }
 
+    MATRIX_setLazy(&newMatrix, LAZY_RECALC, &graphic_cells);
+
     // Ponteiro para undo_redo_cells
-    UndoRedoCells* undoRedo = UNDOREDOCELLS_create();
+    // (usa o conjunto de textos da matriz, sem copiar as expressões)
+    UndoRedoCells* undoRedo = UNDOREDOCELLS_create(MATRIX_getStrings(&newMatrix));
+    UNDOREDOCELLS_setLimits(&undoRedo, UNDO_MAX_ENTRIES, UNDO_MAX_BYTES);
+    UNDOREDOCELLS_setSnapshotLimit(&undoRedo, UNDO_SNAPSHOT_CELLS);
 
     // loop principal
     while(mainLoop){
@@ -345,6 +360,13 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
             GRAPHICSSELECT_addOption(&graphic_select, OPTION_UNDO);
         if(UNDOREDOCELLS_canRedo(&undoRedo))
             GRAPHICSSELECT_addOption(&graphic_select, OPTION_REDO);
+        if(MATRIX_isManual(&newMatrix)){
+            if(MATRIX_getStaleCells(&newMatrix))
+                GRAPHICSSELECT_addOption(&graphic_select, OPTION_RECALC);
+            GRAPHICSSELECT_addOption(&graphic_select, OPTION_AUTOMATIC);
+        }
+        else
+            GRAPHICSSELECT_addOption(&graphic_select, OPTION_MANUAL);
         GRAPHICSSELECT_addOption(&graphic_select, OPTION_SAVE);
         GRAPHICSSELECT_addOption(&graphic_select, OPTION_EXIT);
 
@@ -355,7 +377,7 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
         GRAPHICINST_writeKeyboard(&graphic_instructions,COLUMN*1, ROW*2, false);
 
         // pega expressão da célula
-        MATRIX_getExpression(&newMatrix,currentRow,currentColumn,expression);
+        expression = MATRIX_getExpression(&newMatrix,currentRow,currentColumn);
         // coloca na tela de expressão
         GRAPHICINST_clear(&graphic_expression);
         GRAPHICINST_write(&graphic_expression, "Expression:",1,1);
@@ -381,7 +403,7 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
                 GRAPHICSCELL_selectCell(&graphic_cells, &currentRow, &currentColumn);
 
                 // pega expressão da célula
-                MATRIX_getExpression(&newMatrix,currentRow,currentColumn,expression);
+                expression = MATRIX_getExpression(&newMatrix,currentRow,currentColumn);
                 // coloca na tela de expressão
                 GRAPHICINST_clear(&graphic_expression);
                 GRAPHICINST_write(&graphic_expression, "Expression:",1,1);
@@ -409,7 +431,7 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
                             &graphic_user, &undoRedo);
 
                     // pega expressão da célula
-                    MATRIX_getExpression(&newMatrix,currentRow,currentColumn,expression);
+                    expression = MATRIX_getExpression(&newMatrix,currentRow,currentColumn);
                     // coloca na tela de expressão
                     GRAPHICINST_clear(&graphic_expression);
                     GRAPHICINST_write(&graphic_expression, "Expression:",1,1);
@@ -457,6 +479,21 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
             MATRIX_redo(&newMatrix, &undoRedo, &graphic_cells);
         }
 
+        // se for recalcular as células desatualizadas
+        else if(strcmp(option, OPTION_RECALC)==0){
+            MATRIX_recalculateAll(&newMatrix, &graphic_cells);
+        }
+
+        // se for passar para o cálculo manual (alterações só marcam as células)
+        else if(strcmp(option, OPTION_MANUAL)==0){
+            MATRIX_setManual(&newMatrix, true, &graphic_cells);
+        }
+
+        // se for voltar ao cálculo automático (recalcula as células marcadas)
+        else if(strcmp(option, OPTION_AUTOMATIC)==0){
+            MATRIX_setManual(&newMatrix, false, &graphic_cells);
+        }
+
         // se for salvar espaço de trabalho
         else if(strcmp(option, OPTION_SAVE)==0){
             SAVE_init(&save,&graphic_instructions, &graphic_select, &newMatrix);
@@ -494,15 +531,15 @@ void SPREADSHEET_run(Matrix** matrix, const char* workspaceName){
     GRAPHICSSELECT_clearOptions(&graphic_select);
     GRAPHICUSER_clear(&graphic_user);
 
+    // libera memória do undoRedo (antes da matriz, dona dos textos das expressões)
+    undoRedo = UNDOREDOCELLS_free(undoRedo);
+
     // libera memória da matriz de célula
     newMatrix = MATRIX_free(newMatrix);
 
     // libera memória do save
     save = SAVE_free(save);
 
-    // libera memória do undoRedo
-    undoRedo = UNDOREDOCELLS_free(undoRedo);
-
     // libera memória de todos os objetos gráficos
     graphic_instructions = GRAPHICINST_free(graphic_instructions);
     graphic_cells = GRAPHICSCELLS_free(graphic_cells);
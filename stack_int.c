@@ -0,0 +1,160 @@
+/*
+ * \file stack_int.c
+ * Implementação do arquivo stack_int.h
+ */
+
+#include "stack_int.h"
+
+// capacidade inicial do vetor
+#define INITIAL_CAPACITY 16
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura da pilha de inteiros
+ */
+struct stackInt{
+    int* items;
+    int size;
+    int capacity;
+};
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Aloca pilha
+ * \return Retorna ponteiro para a memória alocada, ou NULL em caso de falha
+ */
+StackInt* STACKINT_create(){
+    StackInt* stackInt = malloc(sizeof(StackInt));
+    if(!stackInt) return NULL;
+
+    stackInt->items = malloc(sizeof(int)*INITIAL_CAPACITY);
+    if(!stackInt->items){
+        free(stackInt);
+        return NULL;
+    }
+
+    stackInt->size = 0;
+    stackInt->capacity = INITIAL_CAPACITY;
+
+    return stackInt;
+}
+
+/**
+ * Desaloca pilha
+ * \return Retorna NULL
+ * \param stackInt Ponteiro para StackInt
+ */
+StackInt* STACKINT_free(StackInt* stackInt){
+    if(!stackInt) return NULL;
+
+    free(stackInt->items);
+    free(stackInt);
+    return NULL;
+}
+
+/**
+ * Adiciona valor inteiro no topo da pilha. O vetor cresce quando necessário
+ * \return Retorna 1 em caso de sucesso ou 0 em caso de falha de alocação
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param value Valor a ser adicionado na pilha
+ */
+int STACKINT_push(StackInt** stackInt, int value){
+    if(!stackInt || !(*stackInt)) return 0;
+
+    // dobra a capacidade do vetor se estiver cheio
+    if((*stackInt)->size == (*stackInt)->capacity){
+        int* items = realloc((*stackInt)->items, sizeof(int)*(*stackInt)->capacity*2);
+        if(!items) return 0;
+
+        (*stackInt)->items = items;
+        (*stackInt)->capacity *= 2;
+    }
+
+    (*stackInt)->items[(*stackInt)->size++] = value;
+    return 1;
+}
+
+/**
+ * Retira elemento do topo e retorna valor desse elemento
+ * \return Valor do elemento removido do topo da pilha (-1 se vazia)
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_pop(StackInt** stackInt){
+    if(!stackInt || !(*stackInt) || !(*stackInt)->size) return -1;
+
+    return (*stackInt)->items[--(*stackInt)->size];
+}
+
+/**
+ * Obtém o elemento de uma posição da pilha (0 é a base)
+ * \return Valor do elemento (-1 se a posição for inválida)
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param index Posição do elemento
+ */
+int STACKINT_get(StackInt** stackInt, int index){
+    if(!stackInt || !(*stackInt) || index < 0 || index >= (*stackInt)->size) return -1;
+
+    return (*stackInt)->items[index];
+}
+
+/**
+ * Substitui o elemento de uma posição da pilha (0 é a base)
+ * \return 1 em caso de sucesso, 0 se a posição for inválida
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param index Posição do elemento
+ * \param value Novo valor do elemento
+ */
+int STACKINT_set(StackInt** stackInt, int index, int value){
+    if(!stackInt || !(*stackInt) || index < 0 || index >= (*stackInt)->size) return 0;
+
+    (*stackInt)->items[index] = value;
+    return 1;
+}
+
+/**
+ * Obtém o vetor com os elementos da pilha, da base ao topo. O vetor deixa de
+ * ser válido quando a pilha é alterada
+ * \return Ponteiro para o vetor (NULL em caso de erro)
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+const int* STACKINT_getItems(StackInt** stackInt){
+    if(!stackInt || !(*stackInt)) return NULL;
+
+    return (*stackInt)->items;
+}
+
+/**
+ * Obtém a quantidade de elementos da pilha
+ * \return Quantidade de elementos
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_getSize(StackInt** stackInt){
+    if(!stackInt || !(*stackInt)) return 0;
+
+    return (*stackInt)->size;
+}
+
+/**
+ * Verifica se a pilha se encontra vazia
+ * \return Um valor diferente de 0 se estiver vazia, ou 0 caso não esteja vazia
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_isEmpty(StackInt** stackInt){
+    return (!stackInt || !(*stackInt) || (*stackInt)->size == 0);
+}
+
+/**
+ * Esvazia a pilha, mantendo a memória alocada para reuso
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+void STACKINT_clear(StackInt** stackInt){
+    if(!stackInt || !(*stackInt)) return;
+
+    (*stackInt)->size = 0;
+}
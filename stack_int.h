@@ -0,0 +1,91 @@
+/**
+ * \file stack_int.h
+ * Pilha de inteiros armazenada em um vetor contíguo. Os elementos também
+ * podem ser acessados por índice, o que permite usá-la como lista ou fila
+ */
+
+#ifndef STACK_INT_H_
+#define STACK_INT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Estrutura da pilha de inteiros
+ */
+typedef struct stackInt StackInt;
+
+/**
+ * Aloca pilha
+ * \return Retorna ponteiro para a memória alocada, ou NULL em caso de falha
+ */
+StackInt* STACKINT_create();
+
+/**
+ * Desaloca pilha
+ * \return Retorna NULL
+ * \param stackInt Ponteiro para StackInt
+ */
+StackInt* STACKINT_free(StackInt* stackInt);
+
+/**
+ * Adiciona valor inteiro no topo da pilha. O vetor cresce quando necessário
+ * \return Retorna 1 em caso de sucesso ou 0 em caso de falha de alocação
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param value Valor a ser adicionado na pilha
+ */
+int STACKINT_push(StackInt** stackInt, int value);
+
+/**
+ * Retira elemento do topo e retorna valor desse elemento
+ * \return Valor do elemento removido do topo da pilha (-1 se vazia)
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_pop(StackInt** stackInt);
+
+/**
+ * Obtém o elemento de uma posição da pilha (0 é a base)
+ * \return Valor do elemento (-1 se a posição for inválida)
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param index Posição do elemento
+ */
+int STACKINT_get(StackInt** stackInt, int index);
+
+/**
+ * Substitui o elemento de uma posição da pilha (0 é a base)
+ * \return 1 em caso de sucesso, 0 se a posição for inválida
+ * \param stackInt Ponteiro duplo para StackInt
+ * \param index Posição do elemento
+ * \param value Novo valor do elemento
+ */
+int STACKINT_set(StackInt** stackInt, int index, int value);
+
+/**
+ * Obtém o vetor com os elementos da pilha, da base ao topo. O vetor deixa de
+ * ser válido quando a pilha é alterada
+ * \return Ponteiro para o vetor (NULL em caso de erro)
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+const int* STACKINT_getItems(StackInt** stackInt);
+
+/**
+ * Obtém a quantidade de elementos da pilha
+ * \return Quantidade de elementos
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_getSize(StackInt** stackInt);
+
+/**
+ * Verifica se a pilha se encontra vazia
+ * \return Um valor diferente de 0 se estiver vazia, ou 0 caso não esteja vazia
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+int STACKINT_isEmpty(StackInt** stackInt);
+
+/**
+ * Esvazia a pilha, mantendo a memória alocada para reuso
+ * \param stackInt Ponteiro duplo para StackInt
+ */
+void STACKINT_clear(StackInt** stackInt);
+
+#endif /* STACK_INT_H_ */
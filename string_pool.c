@@ -0,0 +1,282 @@
+/**
+ * \file string_pool.c
+ * Implementação do arquivo string_pool.h
+ */
+
+#include "string_pool.h"
+
+// capacidade inicial do vetor de textos e da tabela hash (potência de 2)
+#define INITIAL_CAPACITY 64
+
+// fim de uma lista encadeada de textos
+#define NONE -1
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura de um texto guardado no conjunto
+ */
+typedef struct entry Entry;
+struct entry{
+    char* text; ///< texto (NULL se a posição estiver livre)
+    unsigned int hash;
+    int references;
+    int next; ///< próximo texto da mesma posição da tabela, ou próxima posição livre
+};
+
+/**
+ * Estrutura do conjunto de textos
+ */
+struct stringPool{
+    Entry* entries;
+    int capacity; ///< capacidade do vetor de textos
+    int size; ///< posições do vetor já usadas (livres ou não)
+    int amount; ///< quantidade de textos guardados
+    int free; ///< primeira posição livre do vetor
+
+    int* buckets; ///< primeiro texto de cada posição da tabela hash
+    int bucketsSize; ///< tamanho da tabela hash (potência de 2)
+};
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Calcula o hash de um texto (FNV-1a)
+ * \return Hash do texto
+ * \param text Texto
+ */
+unsigned int STRINGPOOL_hash(const char* text){
+    unsigned int hash = 2166136261u;
+
+    while(*text){
+        hash ^= (unsigned char) *text++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Dobra o tamanho da tabela hash, redistribuindo os textos
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param stringPool Ponteiro duplo para StringPool
+ */
+int STRINGPOOL_growBuckets(StringPool** stringPool){
+    int size = (*stringPool)->bucketsSize*2;
+    int* buckets = malloc(sizeof(int)*size);
+    if(!buckets) return 0;
+
+    int count, bucket;
+    for(count=0; count < size; count++)
+        buckets[count] = NONE;
+
+    Entry* entry;
+    for(count=1; count < (*stringPool)->size; count++){
+        entry = &(*stringPool)->entries[count];
+        if(!entry->text) continue;
+
+        bucket = entry->hash & (size-1);
+        entry->next = buckets[bucket];
+        buckets[bucket] = count;
+    }
+
+    free((*stringPool)->buckets);
+    (*stringPool)->buckets = buckets;
+    (*stringPool)->bucketsSize = size;
+
+    return 1;
+}
+
+/**
+ * Obtém uma posição livre no vetor de textos, aumentando-o se necessário
+ * \return Posição livre, ou NONE em caso de falha de alocação
+ * \param stringPool Ponteiro duplo para StringPool
+ */
+int STRINGPOOL_newEntry(StringPool** stringPool){
+    int position;
+
+    if((*stringPool)->free != NONE){
+        position = (*stringPool)->free;
+        (*stringPool)->free = (*stringPool)->entries[position].next;
+        return position;
+    }
+
+    if((*stringPool)->size == (*stringPool)->capacity){
+        Entry* entries = realloc((*stringPool)->entries,
+                sizeof(Entry)*(*stringPool)->capacity*2);
+        if(!entries) return NONE;
+
+        (*stringPool)->entries = entries;
+        (*stringPool)->capacity *= 2;
+    }
+
+    return (*stringPool)->size++;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Aloca conjunto de textos vazio
+ * \return Ponteiro para StringPool, ou NULL em caso de falha de alocação
+ */
+StringPool* STRINGPOOL_create(){
+    StringPool* stringPool = malloc(sizeof(StringPool));
+    if(!stringPool) return NULL;
+
+    stringPool->entries = malloc(sizeof(Entry)*INITIAL_CAPACITY);
+    stringPool->buckets = malloc(sizeof(int)*INITIAL_CAPACITY);
+    if(!stringPool->entries || !stringPool->buckets){
+        free(stringPool->entries);
+        free(stringPool->buckets);
+        free(stringPool);
+        return NULL;
+    }
+
+    stringPool->capacity = INITIAL_CAPACITY;
+    stringPool->bucketsSize = INITIAL_CAPACITY;
+    stringPool->amount = 0;
+    stringPool->free = NONE;
+
+    int count;
+    for(count=0; count < INITIAL_CAPACITY; count++)
+        stringPool->buckets[count] = NONE;
+
+    // a primeira posição é reservada para o texto vazio
+    stringPool->entries[STRINGPOOL_EMPTY].text = NULL;
+    stringPool->entries[STRINGPOOL_EMPTY].next = NONE;
+    stringPool->size = 1;
+
+    return stringPool;
+}
+
+/**
+ * Libera o conjunto de textos e todos os textos guardados
+ * \return NULL
+ * \param stringPool Ponteiro para StringPool
+ */
+StringPool* STRINGPOOL_free(StringPool* stringPool){
+    if(!stringPool) return NULL;
+
+    int count;
+    for(count=1; count < stringPool->size; count++)
+        free(stringPool->entries[count].text);
+
+    free(stringPool->entries);
+    free(stringPool->buckets);
+    free(stringPool);
+
+    return NULL;
+}
+
+/**
+ * Obtém o handle de um texto, guardando-o se ainda não estiver no conjunto, e
+ * adiciona uma referência a ele
+ * \return Handle do texto, ou -1 em caso de falha de alocação
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param text Texto a ser internalizado
+ */
+int STRINGPOOL_intern(StringPool** stringPool, const char* text){
+    if(!stringPool || !(*stringPool) || !text) return -1;
+
+    if(text[0]==0) return STRINGPOOL_EMPTY;
+
+    unsigned int hash = STRINGPOOL_hash(text);
+    Entry* entry;
+
+    // texto já guardado
+    int position = (*stringPool)->buckets[hash & ((*stringPool)->bucketsSize-1)];
+    while(position != NONE){
+        entry = &(*stringPool)->entries[position];
+        if(entry->hash == hash && strcmp(entry->text, text)==0){
+            entry->references++;
+            return position;
+        }
+        position = entry->next;
+    }
+
+    if((*stringPool)->amount >= (*stringPool)->bucketsSize)
+        STRINGPOOL_growBuckets(&(*stringPool));
+
+    position = STRINGPOOL_newEntry(&(*stringPool));
+    if(position == NONE) return -1;
+
+    entry = &(*stringPool)->entries[position];
+    entry->text = malloc(strlen(text)+1);
+    if(!entry->text){
+        entry->next = (*stringPool)->free;
+        (*stringPool)->free = position;
+        return -1;
+    }
+
+    strcpy(entry->text, text);
+    entry->hash = hash;
+    entry->references = 1;
+
+    int bucket = hash & ((*stringPool)->bucketsSize-1);
+    entry->next = (*stringPool)->buckets[bucket];
+    (*stringPool)->buckets[bucket] = position;
+    (*stringPool)->amount++;
+
+    return position;
+}
+
+/**
+ * Adiciona uma referência a um texto do conjunto
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+void STRINGPOOL_retain(StringPool** stringPool, int handle){
+    if(!stringPool || !(*stringPool) || handle <= STRINGPOOL_EMPTY
+            || handle >= (*stringPool)->size || !(*stringPool)->entries[handle].text)
+        return;
+
+    (*stringPool)->entries[handle].references++;
+}
+
+/**
+ * Retira uma referência de um texto do conjunto. O texto é liberado quando
+ * não restam referências
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+void STRINGPOOL_release(StringPool** stringPool, int handle){
+    if(!stringPool || !(*stringPool) || handle <= STRINGPOOL_EMPTY
+            || handle >= (*stringPool)->size || !(*stringPool)->entries[handle].text)
+        return;
+
+    Entry* entry = &(*stringPool)->entries[handle];
+    if(--entry->references > 0) return;
+
+    // retira o texto da lista da sua posição na tabela hash
+    int* link = &(*stringPool)->buckets[entry->hash & ((*stringPool)->bucketsSize-1)];
+    while(*link != handle)
+        link = &(*stringPool)->entries[*link].next;
+    (*link) = entry->next;
+
+    free(entry->text);
+    entry->text = NULL;
+    entry->next = (*stringPool)->free;
+    (*stringPool)->free = handle;
+    (*stringPool)->amount--;
+}
+
+/**
+ * Obtém o texto de um handle. O texto continua válido enquanto houver
+ * referências a ele
+ * \return Texto do handle ("" para STRINGPOOL_EMPTY ou handle inválido)
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+const char* STRINGPOOL_get(StringPool** stringPool, int handle){
+    if(!stringPool || !(*stringPool) || handle <= STRINGPOOL_EMPTY
+            || handle >= (*stringPool)->size || !(*stringPool)->entries[handle].text)
+        return "";
+
+    return (*stringPool)->entries[handle].text;
+}
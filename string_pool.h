@@ -0,0 +1,70 @@
+/**
+ * \file string_pool.h
+ * Conjunto de textos internalizados. Cada texto distinto é guardado uma única
+ * vez, com contagem de referências, e é identificado por um handle inteiro
+ */
+
+#ifndef STRING_POOL_H_
+#define STRING_POOL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Handle do texto vazio. Está sempre disponível e não possui contagem de referências
+ */
+#define STRINGPOOL_EMPTY 0
+
+/**
+ * Estrutura do conjunto de textos
+ */
+typedef struct stringPool StringPool;
+
+/**
+ * Aloca conjunto de textos vazio
+ * \return Ponteiro para StringPool, ou NULL em caso de falha de alocação
+ */
+StringPool* STRINGPOOL_create();
+
+/**
+ * Libera o conjunto de textos e todos os textos guardados
+ * \return NULL
+ * \param stringPool Ponteiro para StringPool
+ */
+StringPool* STRINGPOOL_free(StringPool* stringPool);
+
+/**
+ * Obtém o handle de um texto, guardando-o se ainda não estiver no conjunto, e
+ * adiciona uma referência a ele
+ * \return Handle do texto, ou -1 em caso de falha de alocação
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param text Texto a ser internalizado
+ */
+int STRINGPOOL_intern(StringPool** stringPool, const char* text);
+
+/**
+ * Adiciona uma referência a um texto do conjunto
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+void STRINGPOOL_retain(StringPool** stringPool, int handle);
+
+/**
+ * Retira uma referência de um texto do conjunto. O texto é liberado quando
+ * não restam referências
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+void STRINGPOOL_release(StringPool** stringPool, int handle);
+
+/**
+ * Obtém o texto de um handle. O texto continua válido enquanto houver
+ * referências a ele
+ * \return Texto do handle ("" para STRINGPOOL_EMPTY ou handle inválido)
+ * \param stringPool Ponteiro duplo para StringPool
+ * \param handle Handle do texto
+ */
+const char* STRINGPOOL_get(StringPool** stringPool, int handle);
+
+#endif /* STRING_POOL_H_ */
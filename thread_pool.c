@@ -0,0 +1,410 @@
+/**
+ * \file thread_pool.c
+ * Implementação do arquivo thread_pool.h
+ *
+ * Cada fila dupla é um vetor com a capacidade da execução inteira (cada tarefa
+ * entra em uma única fila uma única vez), protegido por um mutex. O contador de
+ * tarefas pendentes é incrementado antes de uma tarefa entrar na fila e
+ * decrementado quando ela termina, de modo que só chega a 0 quando não há mais
+ * nada a executar
+ *
+ * Um trabalhador sem tarefas para roubar espera parado em idleCondition até que
+ * uma tarefa entre em alguma fila ou a execução termine. Para que nenhum aviso
+ * se perca sem que o mutex seja usado a cada tarefa, o trabalhador conta-se em
+ * idle antes de conferir queued, e THREADPOOL_push soma queued antes de conferir
+ * idle: ao menos um dos dois vê a alteração do outro
+ */
+
+#include "thread_pool.h"
+
+/************************************************************
+ * Estruturas
+ ************************************************************/
+
+/**
+ * Estrutura da fila dupla de tarefas de um trabalhador
+ */
+typedef struct deque Deque;
+struct deque{
+    pthread_mutex_t lock;
+    int* tasks;
+    int top; ///< posição da próxima tarefa a ser roubada
+    int bottom; ///< posição após a última tarefa
+};
+
+/**
+ * Estrutura de um trabalhador que roda em uma thread própria
+ */
+typedef struct worker Worker;
+struct worker{
+    ThreadPool* threadPool;
+    int id;
+    pthread_t thread;
+};
+
+/**
+ * Estrutura do grupo de trabalhadores
+ */
+struct threadPool{
+    int threads; ///< quantidade de trabalhadores (incluindo a thread de THREADPOOL_run)
+    Worker* workers; ///< trabalhadores com thread própria (de 1 até threads - 1)
+    Deque* deques; ///< fila de cada trabalhador
+    int capacity; ///< capacidade das filas
+
+    pthread_mutex_t lock;
+    pthread_cond_t start; ///< avisa as threads de uma nova execução ou do encerramento
+    pthread_cond_t finish; ///< avisa que todas as threads terminaram a execução
+    int generation; ///< número da execução atual
+    int running; ///< threads ainda na execução atual
+    int closing; ///< se as threads devem ser encerradas
+
+    ThreadPoolTask function;
+    void* context;
+    int outstanding; ///< tarefas criadas e ainda não terminadas (acesso atômico)
+    int queued; ///< tarefas nas filas, ainda não retiradas (acesso atômico)
+
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCondition; ///< avisa de uma nova tarefa ou do fim da execução
+    int idle; ///< trabalhadores parados ou prestes a parar (acesso atômico)
+};
+
+/************************************************************
+ * Funções privadas
+ ************************************************************/
+
+/**
+ * Retira a última tarefa da fila do próprio trabalhador
+ * \return 1 se havia tarefa, 0 em caso contrário
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param deque Fila do trabalhador
+ * \param task Variável a ser preenchida com a tarefa
+ */
+int THREADPOOL_pop(ThreadPool** threadPool, Deque* deque, int* task){
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if(deque->bottom > deque->top){
+        (*task) = deque->tasks[--deque->bottom];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    if(found)
+        __atomic_sub_fetch(&(*threadPool)->queued, 1, __ATOMIC_SEQ_CST);
+    return found;
+}
+
+/**
+ * Rouba a primeira tarefa da fila de outro trabalhador
+ * \return 1 se havia tarefa, 0 em caso contrário
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param deque Fila do outro trabalhador
+ * \param task Variável a ser preenchida com a tarefa
+ */
+int THREADPOOL_steal(ThreadPool** threadPool, Deque* deque, int* task){
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if(deque->bottom > deque->top){
+        (*task) = deque->tasks[deque->top++];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    if(found)
+        __atomic_sub_fetch(&(*threadPool)->queued, 1, __ATOMIC_SEQ_CST);
+    return found;
+}
+
+/**
+ * Espera parado até que alguma tarefa entre em uma fila ou que a execução
+ * termine
+ * \param threadPool Ponteiro duplo para ThreadPool
+ */
+void THREADPOOL_park(ThreadPool** threadPool){
+    pthread_mutex_lock(&(*threadPool)->idleLock);
+    __atomic_add_fetch(&(*threadPool)->idle, 1, __ATOMIC_SEQ_CST);
+
+    while(__atomic_load_n(&(*threadPool)->queued, __ATOMIC_SEQ_CST) <= 0
+            && __atomic_load_n(&(*threadPool)->outstanding, __ATOMIC_SEQ_CST) > 0)
+        pthread_cond_wait(&(*threadPool)->idleCondition, &(*threadPool)->idleLock);
+
+    __atomic_sub_fetch(&(*threadPool)->idle, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&(*threadPool)->idleLock);
+}
+
+/**
+ * Executa tarefas até que não haja mais tarefas pendentes na execução atual
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param id Trabalhador
+ */
+void THREADPOOL_work(ThreadPool** threadPool, int id){
+    int task, found, victim, count;
+
+    while(1){
+        found = THREADPOOL_pop(&(*threadPool), &(*threadPool)->deques[id], &task);
+
+        // sem tarefas próprias, tenta os outros trabalhadores a partir do seguinte
+        for(count=1; !found && count < (*threadPool)->threads; count++){
+            victim = (id + count) % (*threadPool)->threads;
+            found = THREADPOOL_steal(&(*threadPool), &(*threadPool)->deques[victim], &task);
+        }
+
+        if(found){
+            (*threadPool)->function(&(*threadPool), id, task, (*threadPool)->context);
+
+            // a última tarefa acorda os trabalhadores parados, que então terminam
+            if(__atomic_sub_fetch(&(*threadPool)->outstanding, 1, __ATOMIC_SEQ_CST) == 0){
+                pthread_mutex_lock(&(*threadPool)->idleLock);
+                pthread_cond_broadcast(&(*threadPool)->idleCondition);
+                pthread_mutex_unlock(&(*threadPool)->idleLock);
+            }
+            continue;
+        }
+
+        // filas vazias: termina se nenhuma tarefa em andamento pode criar outras
+        if(__atomic_load_n(&(*threadPool)->outstanding, __ATOMIC_SEQ_CST) == 0)
+            return;
+
+        // senão, espera parado por uma nova tarefa
+        THREADPOOL_park(&(*threadPool));
+    }
+}
+
+/**
+ * Rotina das threads dos trabalhadores: espera cada execução, trabalha nela e
+ * avisa quando termina
+ * \return NULL
+ * \param argument Ponteiro para Worker
+ */
+void* THREADPOOL_thread(void* argument){
+    Worker* worker = argument;
+    ThreadPool* threadPool = worker->threadPool;
+    int generation = 0;
+
+    pthread_mutex_lock(&threadPool->lock);
+    while(1){
+        while(!threadPool->closing && threadPool->generation == generation)
+            pthread_cond_wait(&threadPool->start, &threadPool->lock);
+        if(threadPool->closing) break;
+
+        generation = threadPool->generation;
+        pthread_mutex_unlock(&threadPool->lock);
+
+        THREADPOOL_work(&threadPool, worker->id);
+
+        pthread_mutex_lock(&threadPool->lock);
+        if(--threadPool->running == 0)
+            pthread_cond_signal(&threadPool->finish);
+    }
+    pthread_mutex_unlock(&threadPool->lock);
+
+    return NULL;
+}
+
+/**
+ * Garante que as filas comportem a quantidade de tarefas de uma execução
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param capacity Quantidade máxima de tarefas da execução
+ */
+int THREADPOOL_reserve(ThreadPool** threadPool, int capacity){
+    if(capacity <= (*threadPool)->capacity) return 1;
+
+    int* tasks;
+    int count;
+    for(count=0; count < (*threadPool)->threads; count++){
+        tasks = realloc((*threadPool)->deques[count].tasks, sizeof(int)*capacity);
+        if(!tasks) return 0;
+        (*threadPool)->deques[count].tasks = tasks;
+    }
+
+    (*threadPool)->capacity = capacity;
+    return 1;
+}
+
+/************************************************************
+ * Funções públicas
+ ************************************************************/
+
+/**
+ * Cria o grupo de trabalhadores. A thread que chama THREADPOOL_run também
+ * trabalha, então são criadas threads - 1 threads
+ * \return Ponteiro para ThreadPool, ou NULL em caso de falha de alocação
+ * \param threads Quantidade de trabalhadores (ao menos 1). Se alguma thread não
+ * puder ser criada, o grupo fica com menos trabalhadores
+ */
+ThreadPool* THREADPOOL_create(int threads){
+    if(threads < 1) return NULL;
+
+    ThreadPool* threadPool = malloc(sizeof(ThreadPool));
+    if(!threadPool) return NULL;
+
+    threadPool->deques = calloc(threads, sizeof(Deque));
+    threadPool->workers = calloc(threads, sizeof(Worker));
+    if(!threadPool->deques || !threadPool->workers){
+        free(threadPool->deques);
+        free(threadPool->workers);
+        free(threadPool);
+        return NULL;
+    }
+
+    threadPool->capacity = 0;
+    threadPool->generation = 0;
+    threadPool->running = 0;
+    threadPool->closing = 0;
+    threadPool->function = NULL;
+    threadPool->context = NULL;
+    threadPool->outstanding = 0;
+    threadPool->queued = 0;
+    threadPool->idle = 0;
+    pthread_mutex_init(&threadPool->lock, NULL);
+    pthread_cond_init(&threadPool->start, NULL);
+    pthread_cond_init(&threadPool->finish, NULL);
+    pthread_mutex_init(&threadPool->idleLock, NULL);
+    pthread_cond_init(&threadPool->idleCondition, NULL);
+
+    int count;
+    for(count=0; count < threads; count++)
+        pthread_mutex_init(&threadPool->deques[count].lock, NULL);
+
+    // o trabalhador 0 é a thread que chama THREADPOOL_run
+    threadPool->threads = 1;
+    for(count=1; count < threads; count++){
+        threadPool->workers[count].threadPool = threadPool;
+        threadPool->workers[count].id = count;
+        if(pthread_create(&threadPool->workers[count].thread, NULL, THREADPOOL_thread,
+                &threadPool->workers[count]))
+            break;
+        threadPool->threads++;
+    }
+
+    return threadPool;
+}
+
+/**
+ * Encerra as threads e libera memória do grupo
+ * \return NULL
+ * \param threadPool Ponteiro para ThreadPool
+ */
+ThreadPool* THREADPOOL_free(ThreadPool* threadPool){
+    if(!threadPool) return NULL;
+
+    pthread_mutex_lock(&threadPool->lock);
+    threadPool->closing = 1;
+    pthread_cond_broadcast(&threadPool->start);
+    pthread_mutex_unlock(&threadPool->lock);
+
+    int count;
+    for(count=1; count < threadPool->threads; count++)
+        pthread_join(threadPool->workers[count].thread, NULL);
+
+    for(count=0; count < threadPool->threads; count++){
+        pthread_mutex_destroy(&threadPool->deques[count].lock);
+        free(threadPool->deques[count].tasks);
+    }
+
+    pthread_cond_destroy(&threadPool->idleCondition);
+    pthread_mutex_destroy(&threadPool->idleLock);
+    pthread_cond_destroy(&threadPool->finish);
+    pthread_cond_destroy(&threadPool->start);
+    pthread_mutex_destroy(&threadPool->lock);
+    free(threadPool->workers);
+    free(threadPool->deques);
+    free(threadPool);
+
+    return NULL;
+}
+
+/**
+ * Obtém a quantidade de trabalhadores do grupo
+ * \return Quantidade de trabalhadores, ou 0 em caso de erro
+ * \param threadPool Ponteiro duplo para ThreadPool
+ */
+int THREADPOOL_getThreads(ThreadPool** threadPool){
+    if(!threadPool || !(*threadPool)) return 0;
+
+    return (*threadPool)->threads;
+}
+
+/**
+ * Executa as tarefas iniciais e todas as tarefas criadas a partir delas,
+ * retornando apenas quando todas terminarem. Não pode ser chamada de dentro
+ * de uma tarefa
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação (nenhuma tarefa
+ * é executada)
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param tasks Tarefas iniciais, distribuídas entre os trabalhadores
+ * \param size Quantidade de tarefas iniciais
+ * \param capacity Quantidade máxima de tarefas da execução (iniciais e criadas)
+ * \param function Função que executa cada tarefa
+ * \param context Contexto repassado para function
+ */
+int THREADPOOL_run(ThreadPool** threadPool, const int* tasks, int size, int capacity,
+        ThreadPoolTask function, void* context){
+    if(!threadPool || !(*threadPool) || !function || size < 0 || capacity < size)
+        return 0;
+
+    if(!THREADPOOL_reserve(&(*threadPool), capacity)) return 0;
+
+    int count;
+    for(count=0; count < (*threadPool)->threads; count++){
+        (*threadPool)->deques[count].top = 0;
+        (*threadPool)->deques[count].bottom = 0;
+    }
+
+    // tarefas iniciais são distribuídas uma para cada trabalhador, em rodízio
+    Deque* deque;
+    for(count=0; count < size; count++){
+        deque = &(*threadPool)->deques[count % (*threadPool)->threads];
+        deque->tasks[deque->bottom++] = tasks[count];
+    }
+
+    (*threadPool)->function = function;
+    (*threadPool)->context = context;
+    (*threadPool)->outstanding = size;
+    (*threadPool)->queued = size;
+
+    // acorda as threads (o mutex publica as filas e o contador para elas)
+    pthread_mutex_lock(&(*threadPool)->lock);
+    (*threadPool)->running = (*threadPool)->threads - 1;
+    (*threadPool)->generation++;
+    pthread_cond_broadcast(&(*threadPool)->start);
+    pthread_mutex_unlock(&(*threadPool)->lock);
+
+    THREADPOOL_work(&(*threadPool), 0);
+
+    // espera as demais threads saírem da execução antes de reaproveitar as filas
+    pthread_mutex_lock(&(*threadPool)->lock);
+    while((*threadPool)->running > 0)
+        pthread_cond_wait(&(*threadPool)->finish, &(*threadPool)->lock);
+    pthread_mutex_unlock(&(*threadPool)->lock);
+
+    return 1;
+}
+
+/**
+ * Cria uma nova tarefa na fila do trabalhador, durante a execução de outra
+ * tarefa. A tarefa pode ser roubada por outro trabalhador
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param worker Trabalhador que executa a tarefa atual
+ * \param task Nova tarefa
+ */
+void THREADPOOL_push(ThreadPool** threadPool, int worker, int task){
+    Deque* deque = &(*threadPool)->deques[worker];
+
+    // conta a tarefa antes que ela possa ser retirada e terminada
+    __atomic_add_fetch(&(*threadPool)->outstanding, 1, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&deque->lock);
+    deque->tasks[deque->bottom++] = task;
+    pthread_mutex_unlock(&deque->lock);
+
+    // acorda um trabalhador parado, se houver
+    __atomic_add_fetch(&(*threadPool)->queued, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&(*threadPool)->idle, __ATOMIC_SEQ_CST) > 0){
+        pthread_mutex_lock(&(*threadPool)->idleLock);
+        pthread_cond_signal(&(*threadPool)->idleCondition);
+        pthread_mutex_unlock(&(*threadPool)->idleLock);
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * \file thread_pool.h
+ * Grupo de trabalhadores que executa tarefas (identificadas por inteiros) em
+ * várias threads. Cada trabalhador tem a sua própria fila dupla de tarefas:
+ * empilha e retira tarefas no final dela, e quando fica sem tarefas rouba do
+ * início da fila de outro trabalhador. As threads são criadas uma única vez e
+ * esperam paradas entre uma execução e outra, e também durante uma execução,
+ * enquanto não houver tarefa para roubar
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/**
+ * Estrutura do grupo de trabalhadores
+ */
+typedef struct threadPool ThreadPool;
+
+/**
+ * Função que executa uma tarefa. Pode criar novas tarefas com THREADPOOL_push,
+ * informando o trabalhador recebido
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param worker Trabalhador que executa a tarefa (de 0 até a quantidade de
+ * threads - 1)
+ * \param task Tarefa
+ * \param context Contexto informado em THREADPOOL_run
+ */
+typedef void (*ThreadPoolTask)(ThreadPool** threadPool, int worker, int task,
+        void* context);
+
+/**
+ * Cria o grupo de trabalhadores. A thread que chama THREADPOOL_run também
+ * trabalha, então são criadas threads - 1 threads
+ * \return Ponteiro para ThreadPool, ou NULL em caso de falha de alocação
+ * \param threads Quantidade de trabalhadores (ao menos 1). Se alguma thread não
+ * puder ser criada, o grupo fica com menos trabalhadores
+ */
+ThreadPool* THREADPOOL_create(int threads);
+
+/**
+ * Encerra as threads e libera memória do grupo
+ * \return NULL
+ * \param threadPool Ponteiro para ThreadPool
+ */
+ThreadPool* THREADPOOL_free(ThreadPool* threadPool);
+
+/**
+ * Obtém a quantidade de trabalhadores do grupo
+ * \return Quantidade de trabalhadores, ou 0 em caso de erro
+ * \param threadPool Ponteiro duplo para ThreadPool
+ */
+int THREADPOOL_getThreads(ThreadPool** threadPool);
+
+/**
+ * Executa as tarefas iniciais e todas as tarefas criadas a partir delas,
+ * retornando apenas quando todas terminarem. Não pode ser chamada de dentro
+ * de uma tarefa
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação (nenhuma tarefa
+ * é executada)
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param tasks Tarefas iniciais, distribuídas entre os trabalhadores
+ * \param size Quantidade de tarefas iniciais
+ * \param capacity Quantidade máxima de tarefas da execução (iniciais e criadas)
+ * \param function Função que executa cada tarefa
+ * \param context Contexto repassado para function
+ */
+int THREADPOOL_run(ThreadPool** threadPool, const int* tasks, int size, int capacity,
+        ThreadPoolTask function, void* context);
+
+/**
+ * Cria uma nova tarefa na fila do trabalhador, durante a execução de outra
+ * tarefa. A tarefa pode ser roubada por outro trabalhador
+ * \param threadPool Ponteiro duplo para ThreadPool
+ * \param worker Trabalhador que executa a tarefa atual
+ * \param task Nova tarefa
+ */
+void THREADPOOL_push(ThreadPool** threadPool, int worker, int task);
+
+#endif /* THREAD_POOL_H_ */
@@ -5,29 +5,65 @@
 
 #include "undo_redo_cells.h"
 
+// capacidade inicial do vetor circular
+#define INITIAL_CAPACITY 16
+
 /*********************************************************************
  * Estruturas
  *********************************************************************/
 
 /**
- * Estrutura de cada elemento da fila
+ * Estrutura dos valores guardados de um grupo: as células cujo valor mudou,
+ * com o valor antes e depois da alteração. Os vetores ficam no mesmo bloco de
+ * memória da estrutura
+ */
+typedef struct snapshot Snapshot;
+struct snapshot{
+    int size; ///< quantidade de células (uma célula pode aparecer mais de uma vez)
+    double* before; ///< valor de cada célula antes da alteração
+    double* after; ///< valor de cada célula depois da alteração
+    int* cells; ///< índice de cada célula
+};
+
+/**
+ * Estrutura de cada item da fila: apenas a posição da célula, os handles das
+ * expressões no conjunto de textos, se o item pertence ao mesmo grupo do
+ * item anterior e, opcionalmente, os valores guardados do grupo
  */
-typedef struct element Element;
-struct element{
+typedef struct entry Entry;
+struct entry{
     int cellValue;
-    char oldExpression[60];
-    char newExpression[60];
-    Element* next;
-    Element* previous;
+    int oldExpression; ///< handle da expressão anterior no conjunto de textos
+    int newExpression; ///< handle da nova expressão no conjunto de textos
+    int linked; ///< se é desfeito e refeito junto com o item anterior
+    Snapshot* snapshot; ///< valores do grupo, no item mais recente dele (ou NULL)
 };
 
 /**
- * Estrutura da fila de desfazer/refazer das células
+ * Estrutura da fila de desfazer/refazer das células. Os itens ficam em um
+ * vetor circular, do mais antigo ao mais recente: os position primeiros podem
+ * ser desfeitos e os demais refeitos. Quando algum limite é ultrapassado, o
+ * item mais antigo é descartado apenas avançando o início do vetor
  */
 struct undoRedoCells{
-    Element* first;
-    Element* last;
-    Element* sentinel;
+    Entry* entries; ///< vetor circular de itens
+    int capacity; ///< capacidade do vetor (cresce até maxEntries)
+    int start; ///< posição do item mais antigo no vetor
+    int size; ///< quantidade de itens (que podem ser desfeitos ou refeitos)
+    int position; ///< quantidade de itens que podem ser desfeitos
+
+    int maxEntries; ///< quantidade máxima de itens
+    size_t bytes; ///< memória contabilizada para os itens guardados
+    size_t maxBytes; ///< memória máxima contabilizada para os itens
+
+    int groups; ///< grupos abertos (UNDOREDOCELLS_beginGroup sem o fim)
+    int grouped; ///< se o grupo aberto já tem algum item
+
+    int maxSnapshot; ///< quantidade máxima de células dos valores guardados
+    int snapshots; ///< quantidade de itens com valores guardados
+    int undone; ///< se a última operação foi desfazer (e não refazer)
+
+    StringPool* strings; ///< conjunto de textos das expressões guardadas
 };
 
 /****************************************************************************
@@ -35,65 +71,196 @@ struct undoRedoCells{
  ****************************************************************************/
 
 /**
- * Libera memória de todos os elementos da fila à direita da sentinela
- * \param element Primeiro elemento da fila
+ * Obtém um item da fila
+ * \return Ponteiro para o item
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param index Posição do item a partir do mais antigo
  */
-Element* UNDOREDOCELLS_freeRightSentinel(Element* element){
-    if(!element) return NULL;
-
-    if(element->next){
-        element = element->next;
-        free(element->previous);
-        element->previous = NULL;
-        return UNDOREDOCELLS_freeRightSentinel(element);
-    }
-    else{
-        free(element);
-        return NULL;
-    }
+Entry* UNDOREDOCELLS_getEntry(UndoRedoCells** undoRedoCells, int index){
+    return &(*undoRedoCells)->entries[((*undoRedoCells)->start + index)
+            % (*undoRedoCells)->capacity];
+}
+
+/**
+ * Calcula a memória contabilizada para um item: o próprio item e os textos
+ * das suas expressões (cada texto é contado por item que o referencia, embora
+ * seja guardado uma única vez no conjunto)
+ * \return Memória do item, em bytes
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param entry Item
+ */
+size_t UNDOREDOCELLS_entryBytes(UndoRedoCells** undoRedoCells, Entry* entry){
+    return sizeof(Entry)
+            + strlen(STRINGPOOL_get(&(*undoRedoCells)->strings, entry->oldExpression))
+            + strlen(STRINGPOOL_get(&(*undoRedoCells)->strings, entry->newExpression));
 }
 
 /**
- * Libera memória de todos os elementos da fila à esquerda da sentinela
- * \param element Primeiro elemento da fila
+ * Calcula a memória ocupada por valores guardados
+ * \return Memória dos valores, em bytes
+ * \param size Quantidade de células
  */
-Element* UNDOREDOCELLS_freeLeftSentinel(Element* element){
-    if(!element) return NULL;
-
-    if(element->previous){
-        element = element->previous;
-        free(element->next);
-        element->next = NULL;
-        return UNDOREDOCELLS_freeLeftSentinel(element);
+size_t UNDOREDOCELLS_snapshotBytes(int size){
+    return sizeof(Snapshot) + (sizeof(double)*2 + sizeof(int))*size;
+}
+
+/**
+ * Descarta os valores guardados em um item (os itens do grupo passam a ser
+ * desfeitos e refeitos calculando as células de novo)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param entry Item
+ */
+void UNDOREDOCELLS_dropSnapshot(UndoRedoCells** undoRedoCells, Entry* entry){
+    if(!entry->snapshot) return;
+
+    (*undoRedoCells)->bytes -= UNDOREDOCELLS_snapshotBytes(entry->snapshot->size);
+    (*undoRedoCells)->snapshots--;
+    free(entry->snapshot);
+    entry->snapshot = NULL;
+}
+
+/**
+ * Retira as referências da fila às expressões de um item
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param entry Item
+ */
+void UNDOREDOCELLS_releaseEntry(UndoRedoCells** undoRedoCells, Entry* entry){
+    UNDOREDOCELLS_dropSnapshot(&(*undoRedoCells), entry);
+    (*undoRedoCells)->bytes -= UNDOREDOCELLS_entryBytes(&(*undoRedoCells), entry);
+    STRINGPOOL_release(&(*undoRedoCells)->strings, entry->oldExpression);
+    STRINGPOOL_release(&(*undoRedoCells)->strings, entry->newExpression);
+}
+
+/**
+ * Descarta o grupo mais antigo da fila (que pode ser desfeito). O item mais
+ * recente é mantido: de um grupo maior que a fila, restam os últimos itens
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_evict(UndoRedoCells** undoRedoCells){
+    do{
+        UNDOREDOCELLS_releaseEntry(&(*undoRedoCells),
+                UNDOREDOCELLS_getEntry(&(*undoRedoCells), 0));
+
+        (*undoRedoCells)->start = ((*undoRedoCells)->start + 1) % (*undoRedoCells)->capacity;
+        (*undoRedoCells)->size--;
+        (*undoRedoCells)->position--;
+    } while((*undoRedoCells)->size > 1 && (*undoRedoCells)->position > 0
+            && UNDOREDOCELLS_getEntry(&(*undoRedoCells), 0)->linked);
+
+    if(!(*undoRedoCells)->size || !UNDOREDOCELLS_getEntry(&(*undoRedoCells), 0)->linked)
+        return;
+
+    // o restante de um grupo descartado pela metade passa a ser desfeito
+    // sozinho, e os valores guardados do grupo inteiro deixam de valer
+    UNDOREDOCELLS_getEntry(&(*undoRedoCells), 0)->linked = 0;
+
+    int count;
+    for(count=0; count < (*undoRedoCells)->size; count++){
+        Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), count);
+        if(count && !entry->linked) break;
+        UNDOREDOCELLS_dropSnapshot(&(*undoRedoCells), entry);
     }
-    else{
-        free(element);
-        return NULL;
+}
+
+/**
+ * Descarta o item mais recente da fila
+ * \return Se o item descartado pertencia ao mesmo grupo do item anterior
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_dropNewest(UndoRedoCells** undoRedoCells){
+    Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), --(*undoRedoCells)->size);
+
+    UNDOREDOCELLS_releaseEntry(&(*undoRedoCells), entry);
+    if((*undoRedoCells)->position > (*undoRedoCells)->size)
+        (*undoRedoCells)->position = (*undoRedoCells)->size;
+
+    return entry->linked;
+}
+
+/**
+ * Descarta itens até que a fila respeite os limites. Acima do limite de memória,
+ * os valores guardados são descartados antes, dos mais antigos aos mais
+ * recentes. Depois, os grupos mais antigos que podem ser desfeitos e, se não
+ * houver, os últimos grupos que podem ser refeitos (a sequência de itens
+ * continua sem buracos). O item mais recente é mantido mesmo que sozinho
+ * ultrapasse o limite de memória
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_enforceLimits(UndoRedoCells** undoRedoCells){
+    int count;
+    for(count=0; count < (*undoRedoCells)->size && (*undoRedoCells)->snapshots
+            && (*undoRedoCells)->bytes > (*undoRedoCells)->maxBytes; count++)
+        UNDOREDOCELLS_dropSnapshot(&(*undoRedoCells),
+                UNDOREDOCELLS_getEntry(&(*undoRedoCells), count));
+
+    while((*undoRedoCells)->size > (*undoRedoCells)->maxEntries
+            || ((*undoRedoCells)->size > 1
+                && (*undoRedoCells)->bytes > (*undoRedoCells)->maxBytes)){
+        if((*undoRedoCells)->position > 0)
+            UNDOREDOCELLS_evict(&(*undoRedoCells));
+        else
+            while(UNDOREDOCELLS_dropNewest(&(*undoRedoCells)) && (*undoRedoCells)->size);
     }
 }
 
+/**
+ * Muda a capacidade do vetor circular, colocando os itens a partir do início
+ * \return 1 em caso de sucesso, 0 em caso de falha de alocação
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param capacity Nova capacidade (ao menos a quantidade de itens)
+ */
+int UNDOREDOCELLS_resize(UndoRedoCells** undoRedoCells, int capacity){
+    Entry* entries = malloc(sizeof(Entry)*capacity);
+    if(!entries) return 0;
+
+    int count;
+    for(count=0; count < (*undoRedoCells)->size; count++)
+        entries[count] = (*UNDOREDOCELLS_getEntry(&(*undoRedoCells), count));
+
+    free((*undoRedoCells)->entries);
+    (*undoRedoCells)->entries = entries;
+    (*undoRedoCells)->capacity = capacity;
+    (*undoRedoCells)->start = 0;
+
+    return 1;
+}
+
 /****************************************************************************
  * Funções públicas
  ****************************************************************************/
 
 /**
- * Aloca memória para a fila de desfazer/refazer
+ * Aloca memória para a fila de desfazer/refazer, com os limites
+ * UNDOREDOCELLS_MAX_ENTRIES e UNDOREDOCELLS_MAX_BYTES
  * \return Retorna ponteiro para a memória alocada ou NULL em caso de falha de alocação
+ * \param strings Ponteiro para o conjunto de textos das expressões (deve ser
+ * liberado depois da fila)
  */
-UndoRedoCells* UNDOREDOCELLS_create(){
+UndoRedoCells* UNDOREDOCELLS_create(StringPool* strings){
+    if(!strings) return NULL;
+
     UndoRedoCells* undoRedoCells = malloc(sizeof(UndoRedoCells));
     if(!undoRedoCells) return NULL;
 
-    undoRedoCells->sentinel = malloc(sizeof(Element));
-    if(!undoRedoCells->sentinel){
+    undoRedoCells->capacity = INITIAL_CAPACITY;
+    undoRedoCells->entries = malloc(sizeof(Entry)*undoRedoCells->capacity);
+    if(!undoRedoCells->entries){
         free(undoRedoCells);
         return NULL;
     }
 
-    undoRedoCells->sentinel->next = NULL;
-    undoRedoCells->sentinel->previous = NULL;
-    undoRedoCells->first = NULL;
-    undoRedoCells->last = NULL;
+    undoRedoCells->start = 0;
+    undoRedoCells->size = 0;
+    undoRedoCells->position = 0;
+    undoRedoCells->maxEntries = UNDOREDOCELLS_MAX_ENTRIES;
+    undoRedoCells->bytes = 0;
+    undoRedoCells->maxBytes = UNDOREDOCELLS_MAX_BYTES;
+    undoRedoCells->groups = 0;
+    undoRedoCells->grouped = 0;
+    undoRedoCells->maxSnapshot = UNDOREDOCELLS_MAX_SNAPSHOT;
+    undoRedoCells->snapshots = 0;
+    undoRedoCells->undone = 0;
+    undoRedoCells->strings = strings;
 
     return undoRedoCells;
 }
@@ -106,67 +273,198 @@ UndoRedoCells* UNDOREDOCELLS_create(){
 UndoRedoCells* UNDOREDOCELLS_free(UndoRedoCells* undoRedoCells){
     if(!undoRedoCells) return NULL;
 
-    undoRedoCells->sentinel->previous =
-            UNDOREDOCELLS_freeLeftSentinel(undoRedoCells->sentinel->previous);
-    undoRedoCells->sentinel->next =
-            UNDOREDOCELLS_freeRightSentinel(undoRedoCells->sentinel->next);
-
-    free(undoRedoCells->sentinel);
-
-    undoRedoCells->first = NULL;
-    undoRedoCells->last = NULL;
-    undoRedoCells->sentinel = NULL;
+    while(undoRedoCells->size)
+        UNDOREDOCELLS_dropNewest(&undoRedoCells);
 
+    free(undoRedoCells->entries);
     free(undoRedoCells);
 
     return NULL;
 }
 
 /**
- * Adiciona um novo item na lista undo (lista redo é apagada)
+ * Define os limites da fila. Os itens mais antigos que não couberem nos novos
+ * limites são descartados
+ * \return Retorna 1 em caso de sucesso, ou 0 em caso de erro (limites inválidos
+ * ou falha de alocação)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param maxEntries Quantidade máxima de itens (ao menos 1)
+ * \param maxBytes Memória máxima contabilizada para os itens, em bytes (o item
+ * mais recente é sempre mantido)
+ */
+int UNDOREDOCELLS_setLimits(UndoRedoCells** undoRedoCells, int maxEntries, size_t maxBytes){
+    if(!undoRedoCells || !(*undoRedoCells) || maxEntries < 1) return 0;
+
+    (*undoRedoCells)->maxEntries = maxEntries;
+    (*undoRedoCells)->maxBytes = maxBytes;
+    UNDOREDOCELLS_enforceLimits(&(*undoRedoCells));
+
+    // o vetor não precisa ser maior que o limite
+    if((*undoRedoCells)->capacity > maxEntries)
+        return UNDOREDOCELLS_resize(&(*undoRedoCells), maxEntries);
+
+    return 1;
+}
+
+/**
+ * Obtém a memória contabilizada para os itens guardados: os itens e os textos
+ * das suas expressões
+ * \return Memória em bytes, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+size_t UNDOREDOCELLS_getBytes(UndoRedoCells** undoRedoCells){
+    if(!undoRedoCells || !(*undoRedoCells)) return 0;
+
+    return (*undoRedoCells)->bytes;
+}
+
+/**
+ * Define a quantidade máxima de células cujos valores são guardados junto a
+ * um grupo (UNDOREDOCELLS_setSnapshot)
+ * \return Retorna 1 em caso de sucesso, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param maxCells Quantidade máxima de células (0 para nunca guardar valores)
+ */
+int UNDOREDOCELLS_setSnapshotLimit(UndoRedoCells** undoRedoCells, int maxCells){
+    if(!undoRedoCells || !(*undoRedoCells) || maxCells < 0) return 0;
+
+    (*undoRedoCells)->maxSnapshot = maxCells;
+
+    return 1;
+}
+
+/**
+ * Obtém a quantidade máxima de células cujos valores são guardados junto a
+ * um grupo
+ * \return Quantidade máxima de células, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_getSnapshotLimit(UndoRedoCells** undoRedoCells){
+    if(!undoRedoCells || !(*undoRedoCells)) return 0;
+
+    return (*undoRedoCells)->maxSnapshot;
+}
+
+/**
+ * Adiciona um novo item na lista undo (lista redo é apagada). A fila passa a
+ * ter uma referência a cada uma das expressões, sem copiar o texto. Se algum
+ * limite for ultrapassado, os itens mais antigos são descartados
  * \return Retorna 1 em caso de sucesso, ou 0 em caso de falha de alocação
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param oldExpression Expression anterior da célula
- * \param newExpression Nova expressão da célula
+ * \param oldExpression Handle da expressão anterior da célula no conjunto de textos
+ * \param newExpression Handle da nova expressão da célula no conjunto de textos
  * \param cellValue Valor (posição) da célula
  */
-int UNDOREDOCELLS_newItem(UndoRedoCells** undoRedoCells, const char* oldExpression,
-        const char* newExpression, int cellValue){
+int UNDOREDOCELLS_newItem(UndoRedoCells** undoRedoCells, int oldExpression,
+        int newExpression, int cellValue){
     if(!(*undoRedoCells)) return 0;
 
-    Element* newElement = malloc(sizeof(Element));
-    if(!newElement) return 0;
+    // apaga os itens que poderiam ser refeitos
+    while((*undoRedoCells)->size > (*undoRedoCells)->position)
+        UNDOREDOCELLS_dropNewest(&(*undoRedoCells));
+
+    // abre espaço: cresce o vetor até o limite, e depois descarta o mais antigo
+    if((*undoRedoCells)->size == (*undoRedoCells)->capacity){
+        if((*undoRedoCells)->capacity < (*undoRedoCells)->maxEntries){
+            int capacity = (*undoRedoCells)->capacity*2;
+            if(capacity > (*undoRedoCells)->maxEntries)
+                capacity = (*undoRedoCells)->maxEntries;
+            if(!UNDOREDOCELLS_resize(&(*undoRedoCells), capacity)) return 0;
+        }
+        else
+            UNDOREDOCELLS_evict(&(*undoRedoCells));
+    }
 
-    strcpy(newElement->oldExpression, oldExpression);
-    strcpy(newElement->newExpression, newExpression);
-    newElement->cellValue = cellValue;
-    newElement->next = NULL;
+    STRINGPOOL_retain(&(*undoRedoCells)->strings, oldExpression);
+    STRINGPOOL_retain(&(*undoRedoCells)->strings, newExpression);
 
-    // coloca novo elemento na posição correta
-    if(!(*undoRedoCells)->last){
-        (*undoRedoCells)->last = newElement;
-        (*undoRedoCells)->sentinel->next = newElement;
-        newElement->previous = (*undoRedoCells)->sentinel;
-    }
-    else{
-        (*undoRedoCells)->last->next = newElement;
-        newElement->previous = (*undoRedoCells)->last;
-        (*undoRedoCells)->last = (*undoRedoCells)->last->next;
-    }
+    Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), (*undoRedoCells)->size);
+    entry->oldExpression = oldExpression;
+    entry->newExpression = newExpression;
+    entry->cellValue = cellValue;
+    entry->linked = (*undoRedoCells)->groups > 0 && (*undoRedoCells)->grouped
+            && (*undoRedoCells)->size > 0;
+    entry->snapshot = NULL;
+    if((*undoRedoCells)->groups > 0)
+        (*undoRedoCells)->grouped = 1;
 
-    // apaga elementos do começo da fila até a sentinela
-    while((*undoRedoCells)->first){
-        (*undoRedoCells)->first = (*undoRedoCells)->first->next;
-        free((*undoRedoCells)->first->previous);
-        (*undoRedoCells)->first->previous = NULL;
+    (*undoRedoCells)->bytes += UNDOREDOCELLS_entryBytes(&(*undoRedoCells), entry);
+    (*undoRedoCells)->size++;
+    (*undoRedoCells)->position = (*undoRedoCells)->size;
 
-        if((*undoRedoCells)->first == (*undoRedoCells)->sentinel)
-            (*undoRedoCells)->first = NULL;
-    }
+    UNDOREDOCELLS_enforceLimits(&(*undoRedoCells));
 
     return 1;
 }
 
+/**
+ * Abre um grupo de itens: os itens adicionados até o fim do grupo são
+ * desfeitos e refeitos juntos, como uma única operação. Grupos podem ser
+ * aninhados (valem apenas os limites do grupo mais externo)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_beginGroup(UndoRedoCells** undoRedoCells){
+    if(!undoRedoCells || !(*undoRedoCells)) return;
+
+    if((*undoRedoCells)->groups++ == 0)
+        (*undoRedoCells)->grouped = 0;
+}
+
+/**
+ * Guarda, junto ao grupo aberto mais externo, os valores das células que ele
+ * alterou, para que seja desfeito e refeito sem calcular as células. Os
+ * vetores são copiados
+ * \return Retorna 1 em caso de sucesso, ou 0 se os valores não forem guardados
+ * (nenhum grupo aberto, grupo vazio ou dentro de outro grupo, células acima do
+ * limite ou falha de alocação)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param size Quantidade de células
+ * \param cells Índice de cada célula (uma célula pode aparecer mais de uma vez)
+ * \param before Valor de cada célula antes das alterações do grupo
+ * \param after Valor de cada célula depois das alterações do grupo
+ */
+int UNDOREDOCELLS_setSnapshot(UndoRedoCells** undoRedoCells, int size, const int* cells,
+        const double* before, const double* after){
+    if(!undoRedoCells || !(*undoRedoCells) || (*undoRedoCells)->groups != 1
+            || !(*undoRedoCells)->grouped || size < 0 || size > (*undoRedoCells)->maxSnapshot)
+        return 0;
+
+    // os itens do grupo são os mais recentes; os valores ficam no último
+    Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), (*undoRedoCells)->size-1);
+    UNDOREDOCELLS_dropSnapshot(&(*undoRedoCells), entry);
+
+    Snapshot* snapshot = malloc(UNDOREDOCELLS_snapshotBytes(size));
+    if(!snapshot) return 0;
+
+    snapshot->size = size;
+    snapshot->before = (double*) (snapshot + 1);
+    snapshot->after = snapshot->before + size;
+    snapshot->cells = (int*) (snapshot->after + size);
+    // grupo que não alterou nenhum valor: nada a copiar
+    if(size){
+        memcpy(snapshot->before, before, sizeof(double)*size);
+        memcpy(snapshot->after, after, sizeof(double)*size);
+        memcpy(snapshot->cells, cells, sizeof(int)*size);
+    }
+
+    entry->snapshot = snapshot;
+    (*undoRedoCells)->snapshots++;
+    (*undoRedoCells)->bytes += UNDOREDOCELLS_snapshotBytes(size);
+    UNDOREDOCELLS_enforceLimits(&(*undoRedoCells));
+
+    return entry->snapshot != NULL;
+}
+
+/**
+ * Fecha o grupo aberto por UNDOREDOCELLS_beginGroup
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_endGroup(UndoRedoCells** undoRedoCells){
+    if(!undoRedoCells || !(*undoRedoCells) || !(*undoRedoCells)->groups) return;
+
+    (*undoRedoCells)->groups--;
+}
+
 /**
  * Verifica se é possível executar operação undo
  * \return Um valor diferente de 0 se puder executar undo, e 0 em caso contrário
@@ -175,7 +473,7 @@ int UNDOREDOCELLS_newItem(UndoRedoCells** undoRedoCells, const char* oldExpressi
 int UNDOREDOCELLS_canUndo(UndoRedoCells** undoRedoCells){
     if(!(*undoRedoCells)) return 0;
 
-    return ((*undoRedoCells)->last != NULL);
+    return ((*undoRedoCells)->position > 0);
 }
 
 /**
@@ -186,83 +484,98 @@ int UNDOREDOCELLS_canUndo(UndoRedoCells** undoRedoCells){
 int UNDOREDOCELLS_canRedo(UndoRedoCells** undoRedoCells){
     if(!(*undoRedoCells)) return 0;
 
-    return ((*undoRedoCells)->first != NULL);
+    return ((*undoRedoCells)->position < (*undoRedoCells)->size);
 }
 
 /**
  * Desfaz última operação feita pelo usuário, retornando dados necessários
  * \return Retorna 1 em caso de sucesso, e 0 em caso de falha
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param expression Ponteiro para variável string a ser preenchida
+ * \param expression Variável a ser preenchida com o handle da expressão no
+ * conjunto de textos (a fila continua com a sua referência)
  * \param cellValue Variável a ser preenchida com a localização da célula
  */
-int UNDOREDOCELLS_undo(UndoRedoCells** undoRedoCells, char *expression, int *cellValue){
-    if(!(*undoRedoCells) || !(*undoRedoCells)->last) return 0;
-
-    strcpy(expression, (*undoRedoCells)->last->oldExpression);
-    *cellValue = (*undoRedoCells)->last->cellValue;
+int UNDOREDOCELLS_undo(UndoRedoCells** undoRedoCells, int *expression, int *cellValue){
+    if(!(*undoRedoCells) || !(*undoRedoCells)->position) return 0;
 
-    (*undoRedoCells)->last = (*undoRedoCells)->last->previous;
+    Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), --(*undoRedoCells)->position);
+    *expression = entry->oldExpression;
+    *cellValue = entry->cellValue;
+    (*undoRedoCells)->undone = 1;
 
-    if(!(*undoRedoCells)->first){
-
-        (*undoRedoCells)->first = (*undoRedoCells)->last->next;
-        (*undoRedoCells)->first->next = (*undoRedoCells)->sentinel;
-        (*undoRedoCells)->first->previous = NULL;
-
-        (*undoRedoCells)->sentinel->previous = (*undoRedoCells)->first;
-
-    }
-    else{
-
-        (*undoRedoCells)->first->previous = (*undoRedoCells)->last->next;
-        (*undoRedoCells)->first->previous->next = (*undoRedoCells)->first;
-        (*undoRedoCells)->first = (*undoRedoCells)->first->previous;
-        (*undoRedoCells)->first->previous = NULL;
-    }
-
-    (*undoRedoCells)->last->next = NULL;
+    return 1;
+}
 
-    if((*undoRedoCells)->last == (*undoRedoCells)->sentinel)
-        (*undoRedoCells)->last = NULL;
+/**
+ * Verifica se o próximo item a ser desfeito pertence ao mesmo grupo do último
+ * item desfeito
+ * \return Um valor diferente de 0 em caso positivo, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_undoContinues(UndoRedoCells** undoRedoCells){
+    if(!(*undoRedoCells) || !(*undoRedoCells)->position
+            || (*undoRedoCells)->position == (*undoRedoCells)->size)
+        return 0;
 
-    return 1;
+    return UNDOREDOCELLS_getEntry(&(*undoRedoCells), (*undoRedoCells)->position)->linked;
 }
 
 /**
  * Refaz última operação desfeita, retornando dados necessários
  * \return Retorna 1 em caso de sucesso, e 0 em caso de falha
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param expression Ponteiro para variável string a ser preenchida
+ * \param expression Variável a ser preenchida com o handle da expressão no
+ * conjunto de textos (a fila continua com a sua referência)
  * \param cellValue Variável a ser preenchida com a localização da célula
  */
-int UNDOREDOCELLS_redo(UndoRedoCells** undoRedoCells, char *expression, int *cellValue){
-    if(!(*undoRedoCells) || !(*undoRedoCells)->first) return 0;
+int UNDOREDOCELLS_redo(UndoRedoCells** undoRedoCells, int *expression, int *cellValue){
+    if(!(*undoRedoCells) || (*undoRedoCells)->position == (*undoRedoCells)->size) return 0;
 
-    strcpy(expression, (*undoRedoCells)->first->newExpression);
-    *cellValue = (*undoRedoCells)->first->cellValue;
+    Entry* entry = UNDOREDOCELLS_getEntry(&(*undoRedoCells), (*undoRedoCells)->position++);
+    *expression = entry->newExpression;
+    *cellValue = entry->cellValue;
+    (*undoRedoCells)->undone = 0;
 
-    (*undoRedoCells)->first = (*undoRedoCells)->first->next;
+    return 1;
+}
 
-    if(!(*undoRedoCells)->last){
+/**
+ * Verifica se o próximo item a ser refeito pertence ao mesmo grupo do último
+ * item refeito
+ * \return Um valor diferente de 0 em caso positivo, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_redoContinues(UndoRedoCells** undoRedoCells){
+    if(!(*undoRedoCells) || (*undoRedoCells)->position == (*undoRedoCells)->size)
+        return 0;
 
-        (*undoRedoCells)->last = (*undoRedoCells)->first->previous;
-        (*undoRedoCells)->last->previous = (*undoRedoCells)->sentinel;
-        (*undoRedoCells)->last->next = NULL;
+    return UNDOREDOCELLS_getEntry(&(*undoRedoCells), (*undoRedoCells)->position)->linked;
+}
 
-        (*undoRedoCells)->sentinel->next = (*undoRedoCells)->last;
-    }
-    else{
-        (*undoRedoCells)->last->next = (*undoRedoCells)->first->previous;
-        (*undoRedoCells)->last->next->previous = (*undoRedoCells)->last;
-        (*undoRedoCells)->last = (*undoRedoCells)->last->next;
-        (*undoRedoCells)->last->next = NULL;
-    }
+/**
+ * Obtém os valores guardados no último item desfeito ou refeito: os valores
+ * antes das alterações do grupo, se ele foi desfeito, ou depois, se foi
+ * refeito. Os valores ficam no item mais recente do grupo, que é o primeiro a
+ * ser desfeito e o último a ser refeito
+ * \return 1 se o item guarda valores, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param size Variável a ser preenchida com a quantidade de células
+ * \param cells Variável a ser preenchida com o vetor de índices das células
+ * \param values Variável a ser preenchida com o vetor de valores das células
+ */
+int UNDOREDOCELLS_getSnapshot(UndoRedoCells** undoRedoCells, int* size, const int** cells,
+        const double** values){
+    if(!undoRedoCells || !(*undoRedoCells)) return 0;
+
+    int index = (*undoRedoCells)->position - ((*undoRedoCells)->undone ? 0 : 1);
+    if(index < 0 || index >= (*undoRedoCells)->size) return 0;
 
-    (*undoRedoCells)->first->previous = NULL;
+    Snapshot* snapshot = UNDOREDOCELLS_getEntry(&(*undoRedoCells), index)->snapshot;
+    if(!snapshot) return 0;
 
-    if((*undoRedoCells)->first == (*undoRedoCells)->sentinel)
-        (*undoRedoCells)->first = NULL;
+    *size = snapshot->size;
+    *cells = snapshot->cells;
+    *values = (*undoRedoCells)->undone ? snapshot->before : snapshot->after;
 
     return 1;
 }
@@ -1,6 +1,10 @@
 /**
  * \file undo_redo_cells.h
- * Arquivo que trata de uma fila de desfazer/refazer dados de uma célula
+ * Arquivo que trata de uma fila de desfazer/refazer dados de uma célula. A fila
+ * tem limites de quantidade de itens e de memória; ao ultrapassá-los, os itens
+ * mais antigos são descartados. Itens podem ser agrupados para que uma operação
+ * em várias células seja desfeita e refeita de uma vez, e cada grupo pode
+ * guardar os valores das células que alterou
  */
 
 #ifndef UNDO_REDO_CELLS_H_
@@ -10,16 +14,36 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "string_pool.h"
+
+/**
+ * Quantidade máxima padrão de itens da fila
+ */
+#define UNDOREDOCELLS_MAX_ENTRIES 4096
+
+/**
+ * Memória máxima padrão contabilizada para os itens da fila, em bytes
+ */
+#define UNDOREDOCELLS_MAX_BYTES (1 << 20)
+
+/**
+ * Quantidade máxima padrão de células cujos valores são guardados junto a um grupo
+ */
+#define UNDOREDOCELLS_MAX_SNAPSHOT 4096
+
 /**
  * Estrutura da fila de desfazer/refazer das células
  */
 typedef struct undoRedoCells UndoRedoCells;
 
 /**
- * Aloca memória para a fila de desfazer/refazer
+ * Aloca memória para a fila de desfazer/refazer, com os limites
+ * UNDOREDOCELLS_MAX_ENTRIES e UNDOREDOCELLS_MAX_BYTES
  * \return Retorna ponteiro para a memória alocada, ou NULL em caso de falha de alocação
+ * \param strings Ponteiro para o conjunto de textos das expressões (deve ser
+ * liberado depois da fila)
  */
-UndoRedoCells* UNDOREDOCELLS_create();
+UndoRedoCells* UNDOREDOCELLS_create(StringPool* strings);
 
 /**
  * Libera memória da fila
@@ -29,15 +53,84 @@ UndoRedoCells* UNDOREDOCELLS_create();
 UndoRedoCells* UNDOREDOCELLS_free(UndoRedoCells* undoRedoCells);
 
 /**
- * Adiciona um novo item na lista undo (lista redo é apagada)
+ * Define os limites da fila. Os itens mais antigos que não couberem nos novos
+ * limites são descartados
+ * \return Retorna 1 em caso de sucesso, ou 0 em caso de erro (limites inválidos
+ * ou falha de alocação)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param maxEntries Quantidade máxima de itens (ao menos 1)
+ * \param maxBytes Memória máxima contabilizada para os itens, em bytes (o item
+ * mais recente é sempre mantido)
+ */
+int UNDOREDOCELLS_setLimits(UndoRedoCells** undoRedoCells, int maxEntries, size_t maxBytes);
+
+/**
+ * Obtém a memória contabilizada para os itens guardados: os itens e os textos
+ * das suas expressões
+ * \return Memória em bytes, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+size_t UNDOREDOCELLS_getBytes(UndoRedoCells** undoRedoCells);
+
+/**
+ * Define a quantidade máxima de células cujos valores são guardados junto a
+ * um grupo (UNDOREDOCELLS_setSnapshot)
+ * \return Retorna 1 em caso de sucesso, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param maxCells Quantidade máxima de células (0 para nunca guardar valores)
+ */
+int UNDOREDOCELLS_setSnapshotLimit(UndoRedoCells** undoRedoCells, int maxCells);
+
+/**
+ * Obtém a quantidade máxima de células cujos valores são guardados junto a
+ * um grupo
+ * \return Quantidade máxima de células, ou 0 em caso de erro
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_getSnapshotLimit(UndoRedoCells** undoRedoCells);
+
+/**
+ * Adiciona um novo item na lista undo (lista redo é apagada). A fila passa a
+ * ter uma referência a cada uma das expressões, sem copiar o texto. Se algum
+ * limite for ultrapassado, os itens mais antigos são descartados
  * \return Retorna 1 em caso de sucesso, ou 0 em caso de falha de alocação
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param oldExpression Expression anterior da célula
- * \param newExpression Nova expressão da célula
+ * \param oldExpression Handle da expressão anterior da célula no conjunto de textos
+ * \param newExpression Handle da nova expressão da célula no conjunto de textos
  * \param cellValue Valor (posição) da célula
  */
-int UNDOREDOCELLS_newItem(UndoRedoCells** undoRedoCells, const char* oldExpression,
-        const char* newExpression, int cellValue);
+int UNDOREDOCELLS_newItem(UndoRedoCells** undoRedoCells, int oldExpression,
+        int newExpression, int cellValue);
+
+/**
+ * Abre um grupo de itens: os itens adicionados até o fim do grupo são
+ * desfeitos e refeitos juntos, como uma única operação. Grupos podem ser
+ * aninhados (valem apenas os limites do grupo mais externo)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_beginGroup(UndoRedoCells** undoRedoCells);
+
+/**
+ * Guarda, junto ao grupo aberto mais externo, os valores das células que ele
+ * alterou, para que seja desfeito e refeito sem calcular as células. Os
+ * vetores são copiados
+ * \return Retorna 1 em caso de sucesso, ou 0 se os valores não forem guardados
+ * (nenhum grupo aberto, grupo vazio ou dentro de outro grupo, células acima do
+ * limite ou falha de alocação)
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param size Quantidade de células
+ * \param cells Índice de cada célula (uma célula pode aparecer mais de uma vez)
+ * \param before Valor de cada célula antes das alterações do grupo
+ * \param after Valor de cada célula depois das alterações do grupo
+ */
+int UNDOREDOCELLS_setSnapshot(UndoRedoCells** undoRedoCells, int size, const int* cells,
+        const double* before, const double* after);
+
+/**
+ * Fecha o grupo aberto por UNDOREDOCELLS_beginGroup
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+void UNDOREDOCELLS_endGroup(UndoRedoCells** undoRedoCells);
 
 /**
  * Verifica se é possível executar operação undo
@@ -57,18 +150,50 @@ int UNDOREDOCELLS_canRedo(UndoRedoCells** undoRedoCells);
  * Desfaz última operação feita pelo usuário, retornando dados necessários
  * \return Retorna 1 em caso de sucesso, e 0 em caso de falha
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param expression Ponteiro para variável string a ser preenchida
+ * \param expression Variável a ser preenchida com o handle da expressão no
+ * conjunto de textos (a fila continua com a sua referência)
  * \param cellValue Variável a ser preenchida com a localização da célula
  */
-int UNDOREDOCELLS_undo(UndoRedoCells** undoRedoCells, char *expression, int *cellValue);
+int UNDOREDOCELLS_undo(UndoRedoCells** undoRedoCells, int *expression, int *cellValue);
+
+/**
+ * Verifica se o próximo item a ser desfeito pertence ao mesmo grupo do último
+ * item desfeito
+ * \return Um valor diferente de 0 em caso positivo, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_undoContinues(UndoRedoCells** undoRedoCells);
 
 /**
  * Refaz última operação desfeita, retornando dados necessários
  * \return Retorna 1 em caso de sucesso, e 0 em caso de falha
  * \param undoRedoCells Ponteiro duplo para UndoRedoCells
- * \param expression Ponteiro para variável string a ser preenchida
+ * \param expression Variável a ser preenchida com o handle da expressão no
+ * conjunto de textos (a fila continua com a sua referência)
  * \param cellValue Variável a ser preenchida com a localização da célula
  */
-int UNDOREDOCELLS_redo(UndoRedoCells** undoRedoCells, char *expression, int *cellValue);
+int UNDOREDOCELLS_redo(UndoRedoCells** undoRedoCells, int *expression, int *cellValue);
+
+/**
+ * Verifica se o próximo item a ser refeito pertence ao mesmo grupo do último
+ * item refeito
+ * \return Um valor diferente de 0 em caso positivo, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ */
+int UNDOREDOCELLS_redoContinues(UndoRedoCells** undoRedoCells);
+
+/**
+ * Obtém os valores guardados no último item desfeito ou refeito: os valores
+ * antes das alterações do grupo, se ele foi desfeito, ou depois, se foi
+ * refeito. Os valores ficam no item mais recente do grupo, que é o primeiro a
+ * ser desfeito e o último a ser refeito
+ * \return 1 se o item guarda valores, e 0 em caso contrário
+ * \param undoRedoCells Ponteiro duplo para UndoRedoCells
+ * \param size Variável a ser preenchida com a quantidade de células
+ * \param cells Variável a ser preenchida com o vetor de índices das células
+ * \param values Variável a ser preenchida com o vetor de valores das células
+ */
+int UNDOREDOCELLS_getSnapshot(UndoRedoCells** undoRedoCells, int* size, const int** cells,
+        const double** values);
 
 #endif /* UNDO_REDO_CELLS_H_ */